@@ -1,6 +1,15 @@
 #ifndef AVX2_COMPONENTWISE_H_
 #define AVX2_COMPONENTWISE_H_
 
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Workspace for storing the intermediate products of the componentwise multiplication. Each
+ * thread running the multiplication concurrently needs its own.
+ */
+typedef std::uint16_t ComponentwiseWorkspace[64*8*27] __attribute__((aligned(32)));
+
 /**
  * Prepare for componentwise multiplication of 64 polynomials with 32 coefficients.
  * @param[in,out] data   The data representing the polynomials, starting with the 64 first coefficients, etc.
@@ -8,11 +17,29 @@
 extern "C" void componentwise32_64_prepare(std::uint16_t* data);
 
 /**
- * Actually perform the multiplication of the two prepared polynomials.
+ * Actually perform the multiplication of the two prepared polynomials. The workspace is taken
+ * from the stack, so this function is reentrant.
  * @param[out] dest      Stores the result.
  * @param[in]  prep1     The first polynomials, prepared.
  * @param[in]  prep2     The second polynomials, prepared.
  */
 extern "C" void componentwise32_64_run(std::uint16_t* dest, std::uint16_t* prep1, std::uint16_t* prep2);
 
+/**
+ * Perform the multiplication of the two prepared polynomials, using a caller-owned workspace.
+ * Calls with different workspaces may run concurrently.
+ * @param[out] dest      Stores the result; may be the same as prep1.
+ * @param[in]  prep1     The first polynomials, prepared.
+ * @param[in]  prep2     The second polynomials, prepared.
+ * @param[in]  workspace 32-byte aligned memory of at least componentwise32_64_workspace_size() bytes.
+ */
+extern "C" void componentwise32_64_run_r(std::uint16_t* dest, std::uint16_t* prep1, std::uint16_t* prep2,
+                                         void* workspace);
+
+/**
+ * Get the size of the workspace needed by componentwise32_64_run_r.
+ * @return    The size in bytes (equal to sizeof(ComponentwiseWorkspace)).
+ */
+extern "C" std::size_t componentwise32_64_workspace_size();
+
 #endif
@@ -0,0 +1,549 @@
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include <immintrin.h>
+
+#include "avx2/GenericModulus.h"
+#include "avx2/Kernels.h"
+
+// This file is built for AVX only, like the rest of avx2/; the kernels enable AVX2 themselves.
+#define AVX2 __attribute__((target("avx2")))
+
+namespace {
+
+using namespace kernels;
+
+/**
+ * Arithmetic modulo 2^16, which works for any power-of-two q dividing it.
+ */
+struct PowerOfTwoArith : WrapArith {
+  AVX2 explicit PowerOfTwoArith(const NussbaumerModulus&) {
+  }
+};
+
+/**
+ * Arithmetic modulo an odd q, on coefficients in [0, q].
+ */
+struct OddArith {
+  __m256i q;
+
+  AVX2 explicit OddArith(const NussbaumerModulus& modulus) : q(_mm256_set1_epi16(modulus.q)) {
+  }
+
+  /// Takes a value in [0, 2q] to [0, q].
+  AVX2 __m256i reduce(__m256i x) const {
+    return _mm256_min_epu16(x, _mm256_sub_epi16(x, q));
+  }
+
+  AVX2 __m256i add(__m256i a, __m256i b) const {
+    return reduce(_mm256_add_epi16(a, b));
+  }
+
+  AVX2 __m256i sub(__m256i a, __m256i b) const {
+    return reduce(_mm256_sub_epi16(_mm256_add_epi16(a, q), b));
+  }
+
+  AVX2 __m256i neg(__m256i a) const {
+    return _mm256_sub_epi16(q, a);
+  }
+};
+
+template<typename S, typename Arith>
+AVX2 void forwardTransform(std::uint16_t* dest, std::uint16_t* src, const Arith& arith) {
+  constexpr std::size_t M = S::M, R = S::R;
+
+  // The 2m polynomials of r coefficients, one after the other.
+  __m256i pols[2*M*S::W];
+  std::uint16_t* polWords = reinterpret_cast<std::uint16_t*>(pols);
+  const __m256i* rows = reinterpret_cast<const __m256i*>(src);
+
+  if(M >= 32) {
+    // Coefficient j of polynomial i < m is src[m*j + i], so each register holds the same
+    // coefficient of 16 polynomials. The first level combines i and i + m/2 with u^0 in the
+    // first half and u^(r/2) in the second, which only reorders the registers; do it before
+    // transposing.
+    constexpr std::size_t RowRegisters = M/16;
+    for(std::size_t half = 0; half < 2; ++half) {
+      for(std::size_t col = 0; col < RowRegisters/2; ++col) {
+        for(std::size_t jBase = 0; jBase < R; jBase += 16) {
+          __m256i sums[16], diffs[16];
+          for(std::size_t j = jBase; j < jBase + 16; ++j) {
+            __m256i a = rows[RowRegisters*j + col];
+            __m256i b = rows[RowRegisters*(j ^ (half*R/2)) + col + RowRegisters/2];
+            if(half == 1 && j < R/2)
+              b = arith.neg(b);
+            sums[j - jBase] = arith.add(a, b);
+            diffs[j - jBase] = arith.sub(a, b);
+          }
+
+          transpose16x16(sums);
+          transpose16x16(diffs);
+          for(std::size_t i = 0; i < 16; ++i) {
+            std::size_t pol = half*M + 16*col + i;
+            _mm256_store_si256(reinterpret_cast<__m256i*>(polWords + R*pol + jBase), sums[i]);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(polWords + R*(pol + M/2) + jBase), diffs[i]);
+          }
+        }
+      }
+    }
+
+    ForwardLevels<S, static_cast<int>(S::LgM) - 2, Arith, NoReduction>::run(pols, arith, NoReduction());
+  }
+  else {
+    // With m = 16 the polynomials paired in the first level share registers, so transpose first
+    // and copy the result to the second half.
+    for(std::size_t j = 0; j < R; j += 16)
+      transposeBlock(polWords + j, R, src + M*j, M);
+    for(std::size_t i = 0; i < M*S::W; ++i)
+      pols[M*S::W + i] = pols[i];
+
+    ForwardLevels<S, static_cast<int>(S::LgM) - 1, Arith, NoReduction>::run(pols, arith, NoReduction());
+  }
+
+  // Store coefficient j of polynomial i at dest[i + 2m*j].
+  for(std::size_t i = 0; i < 2*M; i += 16) {
+    for(std::size_t j = 0; j < R; j += 16)
+      transposeBlock(dest + i + 2*M*j, 2*M, polWords + R*i + j, R);
+  }
+}
+
+/**
+ * Calculates the inverse of a modulo an odd m, with the extended Euclidean algorithm.
+ */
+long inverseModulo(long a, long m) {
+  long r0 = m, r1 = a % m, s0 = 0, s1 = 1;
+  while(r1 != 0) {
+    long quotient = r0 / r1;
+    long r2 = r0 - quotient*r1, s2 = s0 - quotient*s1;
+    r0 = r1;
+    r1 = r2;
+    s0 = s1;
+    s1 = s2;
+  }
+  return ((s0 % m) + m) % m;
+}
+
+/**
+ * Multiplies by the inverse of 2m modulo an odd q, using Montgomery multiplication.
+ */
+struct OddScale {
+  __m256i q, factor, factorQinv;
+
+  AVX2 OddScale(const NussbaumerModulus& modulus, std::size_t twoM) : q(_mm256_set1_epi16(modulus.q)) {
+    // The factor is in Montgomery form, (2m)^-1 * 2^16.
+    std::uint32_t value = static_cast<std::uint32_t>(inverseModulo(static_cast<long>(twoM), modulus.q)*(1l << 16) % modulus.q);
+    factor = _mm256_set1_epi16(static_cast<std::int16_t>(value));
+    factorQinv = _mm256_set1_epi16(static_cast<std::int16_t>(value*modulus.qinv));
+  }
+
+  /// Takes values in [0, q] to the products, in [0, q).
+  AVX2 __m256i run(__m256i x) const {
+    __m256i t = _mm256_mullo_epi16(x, factorQinv);
+    __m256i r = _mm256_sub_epi16(_mm256_mulhi_epi16(x, factor), _mm256_mulhi_epi16(t, q));
+    return _mm256_add_epi16(r, _mm256_and_si256(q, _mm256_srai_epi16(r, 15)));
+  }
+};
+
+/**
+ * Divides by 2m modulo a power-of-two q, which is exact on values modulo 2^16.
+ */
+struct PowerOfTwoScale {
+  __m128i shift;
+  __m256i mask;
+
+  AVX2 PowerOfTwoScale(const NussbaumerModulus& modulus, std::size_t twoM)
+    : shift(_mm_cvtsi32_si128(__builtin_ctzl(twoM))), mask(_mm256_set1_epi16(modulus.q - 1)) {
+  }
+
+  AVX2 __m256i run(__m256i x) const {
+    return _mm256_and_si256(_mm256_srl_epi16(x, shift), mask);
+  }
+};
+
+template<typename S, typename Arith, typename Scale>
+AVX2 void inverseTransform(std::uint16_t* dest, std::uint16_t* src, const Arith& arith, const Scale& scale) {
+  constexpr std::size_t M = S::M, R = S::R, W = S::W;
+  __m256i pols[2*M*W];
+  std::uint16_t* polWords = reinterpret_cast<std::uint16_t*>(pols);
+
+  for(std::size_t i = 0; i < 2*M; i += 16) {
+    for(std::size_t j = 0; j < R; j += 16)
+      transposeBlock(polWords + R*i + j, R, src + i + 2*M*j, 2*M);
+  }
+
+  InverseLevels<S, 0, Arith, NoReduction>::run(pols, arith, NoReduction());
+
+  // Unpack polynomial i as z[i] + u*z[m + i], and divide by 2m.
+  for(std::size_t i = 0; i < M; ++i) {
+    __m256i rotated[W];
+    rotate<1, W>(rotated, pols + W*(M + i), arith);
+    for(std::size_t k = 0; k < W; ++k)
+      pols[W*i + k] = scale.run(arith.add(pols[W*i + k], rotated[k]));
+  }
+
+  // Coefficient j of polynomial i is dest[m*j + i].
+  for(std::size_t i = 0; i < M; i += 16) {
+    for(std::size_t j = 0; j < R; j += 16)
+      transposeBlock(dest + i + M*j, M, polWords + R*i + j, R);
+  }
+}
+
+/**
+ * Reduces the 32-bit sums of products to 16 bits, by two Montgomery reductions: the first
+ * divides by 2^16, the second multiplies by 2^32 and divides by 2^16 again. A Barrett reduction
+ * then brings the values to [0, q).
+ */
+struct OddFinish {
+  __m256i q, qLow, qinvLow, r2, barrettMultiplier, barrettRound;
+
+  AVX2 explicit OddFinish(const NussbaumerModulus& modulus)
+    : q(_mm256_set1_epi16(modulus.q)), qLow(_mm256_set1_epi32(modulus.q)), qinvLow(_mm256_set1_epi32(modulus.qinv)),
+      r2(_mm256_set1_epi32(modulus.montgomeryR2)), barrettMultiplier(_mm256_set1_epi16(modulus.barrettMultiplier)),
+      barrettRound(_mm256_set1_epi16(modulus.barrettRound)) {
+  }
+
+  /// Calculates c * 2^-16 modulo q, for |c| < 2^31; the result is below 2^15 + q/2 in absolute value.
+  AVX2 __m256i montgomeryReduce(__m256i c) const {
+    // The low word of t is c*q^-1 modulo 2^16 and its high word is 0, so madd gives the signed
+    // low word times q. c - t*q is divisible by 2^16, so the high words can be subtracted.
+    __m256i t = _mm256_mullo_epi16(c, qinvLow);
+    __m256i tq = _mm256_madd_epi16(t, qLow);
+    return _mm256_sub_epi32(_mm256_srai_epi32(c, 16), _mm256_srai_epi32(tq, 16));
+  }
+
+  /// Reduces a sum of at most 32 products; up to two of these may be added before run().
+  AVX2 __m256i reduceSum(__m256i sums) const {
+    return montgomeryReduce(sums);
+  }
+
+  AVX2 __m256i run(__m256i reduced0, __m256i reduced1) const {
+    reduced0 = montgomeryReduce(_mm256_mullo_epi32(reduced0, r2));
+    reduced1 = montgomeryReduce(_mm256_mullo_epi32(reduced1, r2));
+    __m256i x = _mm256_packs_epi32(reduced0, reduced1);
+
+    // Barrett reduction with a rounded quotient, giving values in (-q, q).
+    __m256i quotient = _mm256_mulhrs_epi16(_mm256_mulhi_epi16(x, barrettMultiplier), barrettRound);
+    x = _mm256_sub_epi16(x, _mm256_mullo_epi16(quotient, q));
+    return _mm256_add_epi16(x, _mm256_and_si256(q, _mm256_srai_epi16(x, 15)));
+  }
+};
+
+/**
+ * Keeps the low words of the 32-bit sums of products, which are correct modulo 2^16.
+ */
+struct PowerOfTwoFinish {
+  AVX2 explicit PowerOfTwoFinish(const NussbaumerModulus&) {
+  }
+
+  AVX2 __m256i reduceSum(__m256i sums) const {
+    return sums;
+  }
+
+  AVX2 __m256i run(__m256i reduced0, __m256i reduced1) const {
+    __m256i low = _mm256_set1_epi32(0xFFFF);
+    return _mm256_packus_epi32(_mm256_and_si256(reduced0, low), _mm256_and_si256(reduced1, low));
+  }
+};
+
+template<typename S, typename Finish>
+AVX2 void componentwise(std::uint16_t* dest, std::uint16_t* prep1, std::uint16_t* prep2, const Finish& finish) {
+  constexpr std::size_t R = S::R, Stride = 2*S::M;
+
+  // Each register holds the same coefficient of 16 polynomials. Interleaving the words of two
+  // coefficients lets madd calculate a[i]*b[j] + a[i + 1]*b[j - 1], both terms of coefficient
+  // i + j, for 8 polynomials at once. b is extended with b[j - r] = -b[j] for the negacyclic
+  // wrap-around, so coefficient k is the sum over i of a[i]*b[k - i].
+  for(std::size_t col = 0; col < Stride; col += 16) {
+    __m256i pairs1[2][R/2], pairs2[2][2*R - 2];
+
+    for(std::size_t m = 0; m < R/2; ++m) {
+      __m256i a0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(prep1 + Stride*(2*m) + col));
+      __m256i a1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(prep1 + Stride*(2*m + 1) + col));
+      pairs1[0][m] = _mm256_unpacklo_epi16(a0, a1);
+      pairs1[1][m] = _mm256_unpackhi_epi16(a0, a1);
+    }
+
+    __m256i extended[2*R - 1];
+    for(std::size_t j = 0; j < R; ++j) {
+      __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(prep2 + Stride*j + col));
+      extended[R - 1 + j] = b;
+      if(j > 0)
+        extended[j - 1] = _mm256_sub_epi16(_mm256_setzero_si256(), b);
+    }
+    for(std::size_t j = 0; j < 2*R - 2; ++j) {
+      pairs2[0][j] = _mm256_unpacklo_epi16(extended[j + 1], extended[j]);
+      pairs2[1][j] = _mm256_unpackhi_epi16(extended[j + 1], extended[j]);
+    }
+
+    // pairs2[.][j] holds b[j - (r - 2)] and b[j - (r - 1)]. The 32-bit sums are reduced after
+    // each 32 products, so they cannot overflow.
+    for(std::size_t k = 0; k < R; ++k) {
+      __m256i reduced0 = _mm256_setzero_si256(), reduced1 = _mm256_setzero_si256();
+      for(std::size_t mBase = 0; mBase < R/2; mBase += 16) {
+        __m256i sums0 = _mm256_setzero_si256(), sums1 = _mm256_setzero_si256();
+        for(std::size_t m = mBase; m < mBase + 16 && m < R/2; ++m) {
+          sums0 = _mm256_add_epi32(sums0, _mm256_madd_epi16(pairs1[0][m], pairs2[0][k + R - 2 - 2*m]));
+          sums1 = _mm256_add_epi32(sums1, _mm256_madd_epi16(pairs1[1][m], pairs2[1][k + R - 2 - 2*m]));
+        }
+        reduced0 = _mm256_add_epi32(reduced0, finish.reduceSum(sums0));
+        reduced1 = _mm256_add_epi32(reduced1, finish.reduceSum(sums1));
+      }
+      _mm256_store_si256(reinterpret_cast<__m256i*>(dest + Stride*k + col), finish.run(reduced0, reduced1));
+    }
+  }
+}
+
+/**
+ * The kernels for one ring dimension, choosing the arithmetic for the modulus.
+ */
+template<unsigned LgN>
+struct Kernels {
+  typedef Shape<LgN> S;
+
+  AVX2 static void forward(std::uint16_t* dest, std::uint16_t* src, const NussbaumerModulus& modulus) {
+    if(modulus.powerOfTwo)
+      forwardTransform<S>(dest, src, PowerOfTwoArith(modulus));
+    else
+      forwardTransform<S>(dest, src, OddArith(modulus));
+  }
+
+  AVX2 static void prepare(std::uint16_t* data, const NussbaumerModulus& modulus) {
+    // Modulo 2^16 the values are already fine as signed words.
+    if(modulus.powerOfTwo)
+      return;
+
+    __m256i q = _mm256_set1_epi16(modulus.q);
+    __m256i half = _mm256_set1_epi16((modulus.q - 1) / 2);
+    for(std::size_t i = 0; i < 2*S::M*S::R; i += 16) {
+      __m256i* p = reinterpret_cast<__m256i*>(data + i);
+      __m256i x = _mm256_load_si256(p);
+      _mm256_store_si256(p, _mm256_sub_epi16(x, _mm256_and_si256(q, _mm256_cmpgt_epi16(x, half))));
+    }
+  }
+
+  AVX2 static void run(std::uint16_t* dest, std::uint16_t* prep1, std::uint16_t* prep2,
+                       const NussbaumerModulus& modulus) {
+    if(modulus.powerOfTwo)
+      componentwise<S>(dest, prep1, prep2, PowerOfTwoFinish(modulus));
+    else
+      componentwise<S>(dest, prep1, prep2, OddFinish(modulus));
+  }
+
+  AVX2 static void inverse(std::uint16_t* dest, std::uint16_t* src, const NussbaumerModulus& modulus) {
+    if(modulus.powerOfTwo)
+      inverseTransform<S>(dest, src, PowerOfTwoArith(modulus), PowerOfTwoScale(modulus, 2*S::M));
+    else
+      inverseTransform<S>(dest, src, OddArith(modulus), OddScale(modulus, 2*S::M));
+  }
+};
+
+}
+
+
+/**
+ * Set up the constants for a modulus.
+ * @param[out] modulus   The modulus to initialize.
+ * @param[in]  q         The modulus.
+ * @return    true on success, false if q is not supported.
+ */
+bool nussbaumer_modulus_init(NussbaumerModulus& modulus, std::uint16_t q) {
+  modulus = NussbaumerModulus();
+  modulus.q = q;
+  modulus.powerOfTwo = q != 0 && (q & (q - 1)) == 0;
+  if(modulus.powerOfTwo)
+    return q >= 2 && q <= (1 << 11);
+
+  // The sums of 32 products of centered values, below 32*(q/2)^2, must fit in 31 bits.
+  if(q % 2 == 0 || q < (1 << 4) || q >= (1 << 14))
+    return false;
+
+  // Newton iteration doubles the number of correct low bits of q^-1 each step.
+  std::uint32_t qinv = q;
+  for(std::size_t i = 0; i < 4; ++i)
+    qinv *= 2 - q*qinv;
+  modulus.qinv = static_cast<std::uint16_t>(qinv);
+
+  std::uint32_t r = (1u << 16) % q;
+  modulus.montgomeryR2 = static_cast<std::uint16_t>(r*r % q);
+
+  // With s = floor(log2(q)) - 1 the multiplier is below 2^15, and the rounded quotient differs
+  // from x/q by less than 1/2 + 5/q, so the result is within (-q, q).
+  unsigned s = 0;
+  while((2u << (s + 1)) <= q)
+    ++s;
+  modulus.barrettMultiplier = static_cast<std::uint16_t>(((1ul << (16 + s)) + q/2) / q);
+  modulus.barrettRound = static_cast<std::uint16_t>(1u << (15 - s));
+  return true;
+}
+
+
+/**
+ * Checks whether the kernels support a ring dimension with a modulus.
+ * @param[in] n          The ring dimension.
+ * @param[in] modulus    The modulus.
+ * @return    Whether the functions taking n can be used.
+ */
+bool nussbaumer_size_supported(std::size_t n, const NussbaumerModulus& modulus) {
+  if(nussbaumer_transformed_words(n) == 0)
+    return false;
+
+  // Modulo 2^16, the division by 2m at the end leaves 16 - log2(2m) correct bits.
+  unsigned lgN = 0;
+  while((std::size_t(1) << lgN) < n)
+    ++lgN;
+  std::size_t twoM = std::size_t(2) << (lgN / 2);
+  return !modulus.powerOfTwo || modulus.q*twoM <= (1u << 16);
+}
+
+
+/**
+ * Performs the forward Nussbaumer transform modulo q.
+ * @param[in]  n         The ring dimension.
+ * @param[out] dest      The memory to store the transformed input.
+ * @param[in]  src       The coefficients of the polynomial.
+ * @param[in]  modulus   The modulus.
+ */
+void nussbaumer_forward_mod(std::size_t n, std::uint16_t* dest, std::uint16_t* src, const NussbaumerModulus& modulus) {
+  switch(n) {
+  case 256:  Kernels<8>::forward(dest, src, modulus); break;
+  case 512:  Kernels<9>::forward(dest, src, modulus); break;
+  case 1024: Kernels<10>::forward(dest, src, modulus); break;
+  case 2048: Kernels<11>::forward(dest, src, modulus); break;
+  case 4096: Kernels<12>::forward(dest, src, modulus); break;
+  }
+}
+
+
+/**
+ * Prepare for componentwise_run_mod.
+ * @param[in]     n         The ring dimension.
+ * @param[in,out] data      The transformed polynomials.
+ * @param[in]     modulus   The modulus.
+ */
+void componentwise_prepare_mod(std::size_t n, std::uint16_t* data, const NussbaumerModulus& modulus) {
+  switch(n) {
+  case 256:  Kernels<8>::prepare(data, modulus); break;
+  case 512:  Kernels<9>::prepare(data, modulus); break;
+  case 1024: Kernels<10>::prepare(data, modulus); break;
+  case 2048: Kernels<11>::prepare(data, modulus); break;
+  case 4096: Kernels<12>::prepare(data, modulus); break;
+  }
+}
+
+
+/**
+ * Multiplies the 2m polynomials of r coefficients modulo u^r + 1 and q.
+ * @param[in]  n         The ring dimension.
+ * @param[out] dest      Stores the result.
+ * @param[in]  prep1     The first polynomials, prepared.
+ * @param[in]  prep2     The second polynomials, prepared.
+ * @param[in]  modulus   The modulus.
+ */
+void componentwise_run_mod(std::size_t n, std::uint16_t* dest, std::uint16_t* prep1, std::uint16_t* prep2,
+                           const NussbaumerModulus& modulus) {
+  switch(n) {
+  case 256:  Kernels<8>::run(dest, prep1, prep2, modulus); break;
+  case 512:  Kernels<9>::run(dest, prep1, prep2, modulus); break;
+  case 1024: Kernels<10>::run(dest, prep1, prep2, modulus); break;
+  case 2048: Kernels<11>::run(dest, prep1, prep2, modulus); break;
+  case 4096: Kernels<12>::run(dest, prep1, prep2, modulus); break;
+  }
+}
+
+
+/**
+ * Calculate the inverse Nussbaumer transform modulo q.
+ * @param[in]  n         The ring dimension.
+ * @param[out] dest      The memory region to store the result.
+ * @param[in]  src       The transformed value.
+ * @param[in]  modulus   The modulus.
+ */
+void nussbaumer_inverse_mod(std::size_t n, std::uint16_t* dest, std::uint16_t* src, const NussbaumerModulus& modulus) {
+  switch(n) {
+  case 256:  Kernels<8>::inverse(dest, src, modulus); break;
+  case 512:  Kernels<9>::inverse(dest, src, modulus); break;
+  case 1024: Kernels<10>::inverse(dest, src, modulus); break;
+  case 2048: Kernels<11>::inverse(dest, src, modulus); break;
+  case 4096: Kernels<12>::inverse(dest, src, modulus); break;
+  }
+}
+
+
+/**
+ * Multiply two polynomials modulo X^n + 1 and q.
+ * @param[in]  n         The ring dimension.
+ * @param[out] dest      The n coefficients of the product.
+ * @param[in]  src1      The first polynomial.
+ * @param[in]  src2      The second polynomial.
+ * @param[in]  modulus   The modulus.
+ */
+void nussbaumer_multiply_mod(std::size_t n, std::uint16_t* dest, std::uint16_t* src1, std::uint16_t* src2,
+                             const NussbaumerModulus& modulus) {
+  std::uint16_t transformed1[NussbaumerTransformedWords4096] __attribute__((aligned(32)));
+  std::uint16_t transformed2[NussbaumerTransformedWords4096] __attribute__((aligned(32)));
+  nussbaumer_forward_mod(n, transformed1, src1, modulus);
+  nussbaumer_forward_mod(n, transformed2, src2, modulus);
+  componentwise_prepare_mod(n, transformed1, modulus);
+  componentwise_prepare_mod(n, transformed2, modulus);
+  componentwise_run_mod(n, transformed1, transformed1, transformed2, modulus);
+  nussbaumer_inverse_mod(n, dest, transformed1, modulus);
+}
+
+
+/**
+ * Performs the forward Nussbaumer transform modulo q, for n = 1024.
+ * @param[out] dest      The memory to store the transformed input.
+ * @param[in]  src       The coefficients of the polynomial.
+ * @param[in]  modulus   The modulus.
+ */
+void nussbaumer1024_forward_mod(Transformed dest, std::uint16_t* src, const NussbaumerModulus& modulus) {
+  nussbaumer_forward_mod(1024, dest, src, modulus);
+}
+
+
+/**
+ * Prepare for componentwise32_64_run_mod.
+ * @param[in,out] data      The transformed polynomials.
+ * @param[in]     modulus   The modulus.
+ */
+void componentwise32_64_prepare_mod(std::uint16_t* data, const NussbaumerModulus& modulus) {
+  componentwise_prepare_mod(1024, data, modulus);
+}
+
+
+/**
+ * Multiplies the 64 polynomials of 32 coefficients modulo u^32 + 1 and q.
+ * @param[out] dest      Stores the result.
+ * @param[in]  prep1     The first polynomials, prepared.
+ * @param[in]  prep2     The second polynomials, prepared.
+ * @param[in]  modulus   The modulus.
+ */
+void componentwise32_64_run_mod(std::uint16_t* dest, std::uint16_t* prep1, std::uint16_t* prep2,
+                                const NussbaumerModulus& modulus) {
+  componentwise_run_mod(1024, dest, prep1, prep2, modulus);
+}
+
+
+/**
+ * Calculate the inverse Nussbaumer transform modulo q, for n = 1024.
+ * @param[out] dest      The memory region to store the result.
+ * @param[in]  src       The transformed value.
+ * @param[in]  modulus   The modulus.
+ */
+void nussbaumer1024_inverse_mod(TransformedResult dest, Transformed src, const NussbaumerModulus& modulus) {
+  nussbaumer_inverse_mod(1024, dest, src, modulus);
+}
+
+
+/**
+ * Multiply two polynomials modulo X^1024 + 1 and q.
+ * @param[out] dest      The 1024 coefficients of the product.
+ * @param[in]  src1      The first polynomial.
+ * @param[in]  src2      The second polynomial.
+ * @param[in]  modulus   The modulus.
+ */
+void nussbaumer1024_multiply_mod(std::uint16_t* dest, std::uint16_t* src1, std::uint16_t* src2,
+                                 const NussbaumerModulus& modulus) {
+  nussbaumer_multiply_mod(1024, dest, src1, src2, modulus);
+}
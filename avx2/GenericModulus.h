@@ -0,0 +1,166 @@
+#ifndef AVX2_GENERICMODULUS_H_
+#define AVX2_GENERICMODULUS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "avx2/Nussbaumer.h"
+
+/**
+ * The modulus for the AVX2 Nussbaumer multiplication modulo a q other than 2047, with the
+ * constants its reductions need. Odd moduli below 2^14 use Montgomery and Barrett reduction;
+ * power-of-two moduli compute modulo 2^16, and the division by 2m at the end leaves
+ * 16 - log2(2m) correct bits (see nussbaumer_size_supported).
+ */
+struct NussbaumerModulus {
+  /** The modulus q. */
+  std::uint16_t q;
+
+  /** Whether q is a power of two. */
+  bool powerOfTwo;
+
+  /** q^-1 modulo 2^16, for Montgomery reduction. */
+  std::uint16_t qinv;
+
+  /** 2^32 modulo q, to undo the factor 2^-16 of Montgomery reduction. */
+  std::uint16_t montgomeryR2;
+
+  /** round(2^(16 + s) / q), for Barrett reduction. */
+  std::uint16_t barrettMultiplier;
+
+  /** 2^(15 - s), rounding off the last s bits of the Barrett quotient. */
+  std::uint16_t barrettRound;
+};
+
+/**
+ * Set up the constants for a modulus.
+ * @param[out] modulus   The modulus to initialize.
+ * @param[in]  q         An odd modulus with 2^4 < q < 2^14, or a power of two up to 2^11.
+ * @return    true on success, false if q is not supported.
+ */
+bool nussbaumer_modulus_init(NussbaumerModulus& modulus, std::uint16_t q);
+
+/**
+ * The number of words of a transformed polynomial with n coefficients: 2m polynomials of r
+ * coefficients, with m = 2^floor(log2(n)/2) and r = n/m. This is also the size of the buffers for
+ * the componentwise multiplication.
+ * @param[in] n    The ring dimension: 256, 512, 1024, 2048 or 4096.
+ * @return    The number of words, or 0 if n is not supported.
+ */
+constexpr std::size_t nussbaumer_transformed_words(std::size_t n) {
+  return n == 256 ? 32*16 : n == 512 ? 32*32 : n == 1024 ? 64*32 : n == 2048 ? 64*64 : n == 4096 ? 128*64 : 0;
+}
+
+constexpr std::size_t NussbaumerTransformedWords256 = nussbaumer_transformed_words(256);
+constexpr std::size_t NussbaumerTransformedWords512 = nussbaumer_transformed_words(512);
+constexpr std::size_t NussbaumerTransformedWords1024 = nussbaumer_transformed_words(1024);
+constexpr std::size_t NussbaumerTransformedWords2048 = nussbaumer_transformed_words(2048);
+constexpr std::size_t NussbaumerTransformedWords4096 = nussbaumer_transformed_words(4096);
+
+/**
+ * Checks whether the functions below support a ring dimension with a modulus. For a power-of-two
+ * q this needs q*2m <= 2^16, so q = 2^11 only works for n = 256 and 512, and n = 4096 needs
+ * q <= 2^9.
+ * @param[in] n          The ring dimension.
+ * @param[in] modulus    The modulus.
+ * @return    Whether the functions can be used.
+ */
+bool nussbaumer_size_supported(std::size_t n, const NussbaumerModulus& modulus);
+
+/**
+ * Performs the forward Nussbaumer transform modulo X^n + 1 and q. Coefficient j of transformed
+ * polynomial i is stored at dest[i + 2m*j], with coefficients in [0, q] (or modulo 2^16 for a
+ * power-of-two q).
+ * @param[in]  n         The ring dimension, supported according to nussbaumer_size_supported.
+ * @param[out] dest      32-byte aligned memory of nussbaumer_transformed_words(n) words.
+ * @param[in]  src       The n coefficients of the polynomial, in [0, q); 32-byte aligned.
+ * @param[in]  modulus   The modulus.
+ */
+void nussbaumer_forward_mod(std::size_t n, std::uint16_t* dest, std::uint16_t* src, const NussbaumerModulus& modulus);
+
+/**
+ * Prepare for componentwise_run_mod, centering the coefficients around 0.
+ * @param[in]     n         The ring dimension.
+ * @param[in,out] data      The transformed polynomials.
+ * @param[in]     modulus   The modulus.
+ */
+void componentwise_prepare_mod(std::size_t n, std::uint16_t* data, const NussbaumerModulus& modulus);
+
+/**
+ * Multiplies the 2m polynomials of r coefficients modulo u^r + 1 and q.
+ * @param[in]  n         The ring dimension.
+ * @param[out] dest      Stores the result; may be the same as prep1 or prep2.
+ * @param[in]  prep1     The first polynomials, prepared.
+ * @param[in]  prep2     The second polynomials, prepared.
+ * @param[in]  modulus   The modulus.
+ */
+void componentwise_run_mod(std::size_t n, std::uint16_t* dest, std::uint16_t* prep1, std::uint16_t* prep2,
+                           const NussbaumerModulus& modulus);
+
+/**
+ * Calculate the inverse Nussbaumer transform modulo X^n + 1 and q.
+ * @param[in]  n         The ring dimension.
+ * @param[out] dest      The n coefficients of the result, in [0, q); may be the same as src.
+ * @param[in]  src       The transformed value, with coefficients in [0, q].
+ * @param[in]  modulus   The modulus.
+ */
+void nussbaumer_inverse_mod(std::size_t n, std::uint16_t* dest, std::uint16_t* src, const NussbaumerModulus& modulus);
+
+/**
+ * Multiply two polynomials modulo X^n + 1 and q.
+ * @param[in]  n         The ring dimension.
+ * @param[out] dest      The n coefficients of the product, in [0, q).
+ * @param[in]  src1      The first polynomial, with coefficients in [0, q).
+ * @param[in]  src2      The second polynomial, with coefficients in [0, q).
+ * @param[in]  modulus   The modulus.
+ */
+void nussbaumer_multiply_mod(std::size_t n, std::uint16_t* dest, std::uint16_t* src1, std::uint16_t* src2,
+                             const NussbaumerModulus& modulus);
+
+/**
+ * Performs the forward Nussbaumer transform modulo X^1024 + 1 and q. The output has the same layout as that of
+ * nussbaumer1024_forward, with coefficients in [0, q] (or modulo 2^16 for a power-of-two q). Like the
+ * other functions for n = 1024, this needs nussbaumer_size_supported(1024, modulus).
+ * @param[out] dest      The memory to store the transformed input; only 2048 words are used.
+ * @param[in]  src       The coefficients of the polynomial, in [0, q).
+ * @param[in]  modulus   The modulus.
+ */
+void nussbaumer1024_forward_mod(Transformed dest, std::uint16_t* src, const NussbaumerModulus& modulus);
+
+/**
+ * Prepare for componentwise32_64_run_mod, centering the coefficients around 0.
+ * @param[in,out] data      The transformed polynomials.
+ * @param[in]     modulus   The modulus.
+ */
+void componentwise32_64_prepare_mod(std::uint16_t* data, const NussbaumerModulus& modulus);
+
+/**
+ * Multiplies the 64 polynomials of 32 coefficients modulo u^32 + 1 and q. The results are fully
+ * reduced for an odd q.
+ * @param[out] dest      Stores the result; may be the same as prep1 or prep2.
+ * @param[in]  prep1     The first polynomials, prepared.
+ * @param[in]  prep2     The second polynomials, prepared.
+ * @param[in]  modulus   The modulus.
+ */
+void componentwise32_64_run_mod(std::uint16_t* dest, std::uint16_t* prep1, std::uint16_t* prep2,
+                                const NussbaumerModulus& modulus);
+
+/**
+ * Calculate the inverse Nussbaumer transform modulo q.
+ * @param[out] dest      The 1024 coefficients of the result, in [0, q); may be the same as src.
+ * @param[in]  src       The transformed value, with coefficients in [0, q].
+ * @param[in]  modulus   The modulus.
+ */
+void nussbaumer1024_inverse_mod(TransformedResult dest, Transformed src, const NussbaumerModulus& modulus);
+
+/**
+ * Multiply two polynomials modulo X^1024 + 1 and q.
+ * @param[out] dest      The 1024 coefficients of the product, in [0, q).
+ * @param[in]  src1      The first polynomial, with coefficients in [0, q).
+ * @param[in]  src2      The second polynomial, with coefficients in [0, q).
+ * @param[in]  modulus   The modulus.
+ */
+void nussbaumer1024_multiply_mod(std::uint16_t* dest, std::uint16_t* src1, std::uint16_t* src2,
+                                 const NussbaumerModulus& modulus);
+
+#endif
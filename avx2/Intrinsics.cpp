@@ -0,0 +1,332 @@
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include <immintrin.h>
+
+#include "avx2/Intrinsics.h"
+#include "avx2/Kernels.h"
+
+// This file is built for AVX only, like the rest of avx2/; the kernels enable AVX2 themselves.
+#define AVX2 __attribute__((target("avx2")))
+
+namespace {
+
+using namespace kernels;
+
+// The split of N = 1024 into 64 polynomials of 32 coefficients, so each takes two registers.
+typedef Shape<10> S;
+constexpr std::size_t W = S::W;
+
+// The number of words in a row of the transformed data: one coefficient of the 64 polynomials.
+constexpr std::size_t Row = 64;
+
+// The number of words in a group of the prepared data: four rows.
+constexpr std::size_t Group = 4*Row;
+
+// The workspace of the componentwise multiplication: 27 products of 7 rows, each padded to 8 rows.
+constexpr std::size_t WorkspaceWords = 27*8*Row;
+
+/**
+ * The reductions of nussbaumer.s, for arithmetic modulo 2^16 on values modulo 2047. The forward
+ * levels need none while the inputs, of at most 11 bits, fit in 16 signed bits, which holds for
+ * the first four. The last level reduces its inputs to 12 bits first, and adds 4*2047 to the
+ * outputs so they are non-negative, with at most 14 bits. The inverse transform starts from
+ * values of at most 12 bits, and reduces its outputs after every other level.
+ */
+struct Reduction2047 {
+  template<unsigned J, std::size_t W>
+  AVX2_INLINE void beforeForward(__m256i* a, __m256i* b) const {
+    if(J == 0) {
+      for(std::size_t i = 0; i < W; ++i) {
+        a[i] = reduce2047Signed(a[i]);
+        b[i] = reduce2047Signed(b[i]);
+      }
+    }
+  }
+
+  template<unsigned J, std::size_t W>
+  AVX2_INLINE void afterForward(__m256i* a, __m256i* b) const {
+    if(J == 0) {
+      for(std::size_t i = 0; i < W; ++i) {
+        a[i] = _mm256_add_epi16(a[i], _mm256_set1_epi16(4*2047));
+        b[i] = _mm256_add_epi16(b[i], _mm256_set1_epi16(4*2047));
+      }
+    }
+  }
+
+  template<unsigned J, std::size_t W>
+  AVX2_INLINE void afterInverse(__m256i* a, __m256i* b) const {
+    if(J == 2 || J == 4) {
+      for(std::size_t i = 0; i < W; ++i) {
+        a[i] = reduce2047Signed(a[i]);
+        b[i] = reduce2047Signed(b[i]);
+      }
+    }
+  }
+};
+
+/**
+ * Fully reduces values of at most 12 bits modulo 2047 and multiplies them by 64^-1 = 32, which is
+ * a rotation of the 11 bits.
+ */
+AVX2_INLINE __m256i finishInverse(__m256i x) {
+  const __m256i mask = _mm256_set1_epi16(0x7FF);
+  x = _mm256_add_epi16(x, _mm256_srli_epi16(x, 11));
+
+  // Replace 2047 by 0
+  x = _mm256_sub_epi16(x, _mm256_cmpeq_epi16(x, mask));
+  x = _mm256_and_si256(x, mask);
+  x = _mm256_add_epi16(x, _mm256_srli_epi16(x, 11));
+
+  return _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi16(x, 5), _mm256_srli_epi16(x, 6)), mask);
+}
+
+AVX2_INLINE __m256i load(const std::uint16_t* src) {
+  return _mm256_load_si256(reinterpret_cast<const __m256i*>(src));
+}
+
+AVX2_INLINE void store(std::uint16_t* dest, __m256i value) {
+  _mm256_store_si256(reinterpret_cast<__m256i*>(dest), value);
+}
+
+AVX2_INLINE void forward(std::uint16_t* dest, const std::uint16_t* src) {
+  // The 64 polynomials of 32 coefficients, one after the other; the last 32 start as a copy of
+  // the first.
+  __m256i pols[64*W];
+  std::uint16_t* polWords = reinterpret_cast<std::uint16_t*>(pols);
+  for(std::size_t i = 0; i < 32; i += 16) {
+    for(std::size_t j = 0; j < 32; j += 16)
+      transposeBlock(polWords + 32*i + j, 32, src + 32*j + i, 32);
+  }
+  for(std::size_t i = 0; i < 32*W; ++i)
+    pols[32*W + i] = pols[i];
+
+  ForwardLevels<S, 4, WrapArith, Reduction2047>::run(pols, WrapArith(), Reduction2047());
+
+  // Store coefficient j of polynomial i at dest[i + 64*j].
+  for(std::size_t i = 0; i < 64; i += 16) {
+    for(std::size_t j = 0; j < 32; j += 16)
+      transposeBlock(dest + i + Row*j, Row, polWords + 32*i + j, 32);
+  }
+}
+
+AVX2_INLINE void prepare(std::uint16_t* data) {
+  // Group g holds coefficients 4g to 4g + 3 of the 64 polynomials. The first 8 groups are the
+  // input; the other 19 are the sums needed by the three levels of Karatsuba in run(), in the
+  // same layout as componentwise32_64_prepare.
+  for(std::size_t offset = 0; offset < Group; offset += 16) {
+    __m256i a[8];
+    for(std::size_t g = 0; g < 8; ++g)
+      a[g] = load(data + Group*g + offset);
+
+    __m256i s[4];
+    for(std::size_t g = 0; g < 4; ++g) {
+      s[g] = _mm256_add_epi16(a[g], a[g + 4]);
+      store(data + Group*(8 + g) + offset, s[g]);
+    }
+
+    __m256i g16 = reduce2047(_mm256_add_epi16(s[0], s[2]));
+    __m256i g17 = reduce2047(_mm256_add_epi16(s[1], s[3]));
+    store(data + Group*16 + offset, g16);
+    store(data + Group*17 + offset, g17);
+    store(data + Group*26 + offset, _mm256_add_epi16(g16, g17));
+    store(data + Group*22 + offset, reduce2047(_mm256_add_epi16(s[0], s[1])));
+    store(data + Group*23 + offset, reduce2047(_mm256_add_epi16(s[2], s[3])));
+
+    __m256i g12 = reduce2047(_mm256_add_epi16(a[0], a[2]));
+    __m256i g13 = reduce2047(_mm256_add_epi16(a[1], a[3]));
+    store(data + Group*12 + offset, g12);
+    store(data + Group*13 + offset, g13);
+    store(data + Group*24 + offset, _mm256_add_epi16(g12, g13));
+
+    __m256i g14 = reduce2047(_mm256_add_epi16(a[4], a[6]));
+    __m256i g15 = reduce2047(_mm256_add_epi16(a[5], a[7]));
+    store(data + Group*14 + offset, g14);
+    store(data + Group*15 + offset, g15);
+    store(data + Group*25 + offset, _mm256_add_epi16(g14, g15));
+
+    for(std::size_t g = 0; g < 4; ++g)
+      store(data + Group*(18 + g) + offset, _mm256_add_epi16(a[2*g], a[2*g + 1]));
+  }
+}
+
+/**
+ * One Karatsuba step: given the products L and H of the low and high halves (at rows 0 and Half
+ * of low) and the product M of their sums, calculates the middle rows of the full product in
+ * place. Rows Half - 1 and 2*Half - 1 of L and H are not used.
+ */
+template<std::size_t Half, bool Reduce>
+AVX2_INLINE void karatsubaStep(std::uint16_t* low, const std::uint16_t* mid) {
+  std::uint16_t* high = low + Half*Row;
+  for(std::size_t offset = 0; offset < (Half/2 - 1)*Row; offset += 16) {
+    __m256i l0 = load(low + offset), l1 = load(low + (Half/2)*Row + offset);
+    __m256i h0 = load(high + offset), h1 = load(high + (Half/2)*Row + offset);
+    __m256i m0 = load(mid + offset), m1 = load(mid + (Half/2)*Row + offset);
+
+    __m256i x = _mm256_sub_epi16(l1, h0);
+    __m256i y = _mm256_sub_epi16(_mm256_sub_epi16(m1, x), h1);
+    x = _mm256_sub_epi16(_mm256_add_epi16(x, m0), l0);
+    store(low + (Half/2)*Row + offset, Reduce ? reduce2047Signed(x) : x);
+    store(high + offset, Reduce ? reduce2047Signed(y) : y);
+  }
+
+  // The last middle coefficient has no terms from L and H shifted in.
+  constexpr std::size_t Last = (Half/2 - 1)*Row;
+  for(std::size_t offset = 0; offset < Row; offset += 16) {
+    __m256i x = _mm256_sub_epi16(_mm256_sub_epi16(load(mid + Last + offset), load(low + Last + offset)),
+                                 load(high + Last + offset));
+    store(low + (Half - 1)*Row + offset, Reduce ? reduce2047Signed(x) : x);
+  }
+}
+
+AVX2_INLINE void run(std::uint16_t* dest, const std::uint16_t* prep1, const std::uint16_t* prep2,
+                     std::uint16_t* workspace) {
+  // Multiply the 27 groups of polynomials with 4 coefficients.
+  for(std::size_t g = 0; g < 27; ++g) {
+    for(std::size_t offset = 0; offset < Row; offset += 16) {
+      __m256i a[4], b[4], c[7];
+      for(std::size_t i = 0; i < 4; ++i) {
+        a[i] = load(prep2 + Group*g + Row*i + offset);
+        b[i] = load(prep1 + Group*g + Row*i + offset);
+      }
+      schoolbook4(c, a, b);
+      for(std::size_t k = 0; k < 7; ++k)
+        store(workspace + 2*Group*g + Row*k + offset, c[k]);
+    }
+  }
+
+  // Combine pairs of them into 9 products of polynomials with 8 coefficients, reduced to 12 bits.
+  for(std::size_t i = 0; i < 9; ++i) {
+    std::uint16_t* low = workspace + 4*Group*i;
+    karatsubaStep<8, true>(low, workspace + 2*Group*(18 + i));
+    for(std::size_t offset = 0; offset < 4*Row; offset += 16)
+      store(low + offset, reduce2047(load(low + offset)));
+    for(std::size_t offset = 12*Row; offset < 15*Row; offset += 16)
+      store(low + offset, reduce2047(load(low + offset)));
+  }
+
+  // Then into 3 products of polynomials with 16 coefficients.
+  for(std::size_t i = 0; i < 3; ++i)
+    karatsubaStep<16, false>(workspace + 8*Group*i, workspace + 4*Group*(6 + i));
+
+  // The last step calculates the product modulo u^32 + 1 directly, reducing to 12 bits.
+  const std::uint16_t* low = workspace;
+  const std::uint16_t* high = workspace + 32*Row;
+  const std::uint16_t* mid = workspace + 64*Row;
+  for(std::size_t offset = 0; offset < 15*Row; offset += 16) {
+    __m256i l0 = load(low + offset), l1 = load(low + 16*Row + offset);
+    __m256i h0 = load(high + offset), h1 = load(high + 16*Row + offset);
+    __m256i m0 = load(mid + offset), m1 = load(mid + 16*Row + offset);
+
+    __m256i d = _mm256_sub_epi16(l1, h0), s = _mm256_add_epi16(l0, h1);
+    __m256i x = reduce2047Signed(_mm256_add_epi16(d, s));
+    __m256i y = reduce2047Signed(_mm256_sub_epi16(d, s));
+    store(dest + offset, reduce2047Signed(_mm256_sub_epi16(x, m1)));
+    store(dest + 16*Row + offset, reduce2047Signed(_mm256_add_epi16(y, m0)));
+  }
+  for(std::size_t offset = 15*Row; offset < 16*Row; offset += 16) {
+    __m256i l0 = load(low + offset), h0 = load(high + offset), m0 = load(mid + offset);
+    store(dest + offset, reduce2047Signed(_mm256_sub_epi16(l0, h0)));
+    store(dest + 16*Row + offset, reduce2047Signed(_mm256_sub_epi16(_mm256_sub_epi16(m0, l0), h0)));
+  }
+}
+
+AVX2_INLINE void inverse(std::uint16_t* dest, const std::uint16_t* src) {
+  __m256i pols[64*W];
+  std::uint16_t* polWords = reinterpret_cast<std::uint16_t*>(pols);
+  for(std::size_t i = 0; i < 64; i += 16) {
+    for(std::size_t j = 0; j < 32; j += 16)
+      transposeBlock(polWords + 32*i + j, 32, src + i + Row*j, Row);
+  }
+
+  InverseLevels<S, 0, WrapArith, Reduction2047>::run(pols, WrapArith(), Reduction2047());
+
+  // Unpack polynomial i as z[i] + u*z[32 + i], and divide by 2m = 64.
+  for(std::size_t i = 0; i < 32; ++i) {
+    __m256i rotated[W];
+    rotate<1, W>(rotated, pols + W*(32 + i), WrapArith());
+    for(std::size_t k = 0; k < W; ++k)
+      pols[W*i + k] = finishInverse(reduce2047Signed(_mm256_add_epi16(pols[W*i + k], rotated[k])));
+  }
+
+  // Coefficient j of polynomial i is dest[32*j + i].
+  for(std::size_t i = 0; i < 32; i += 16) {
+    for(std::size_t j = 0; j < 32; j += 16)
+      transposeBlock(dest + i + 32*j, 32, polWords + 32*i + j, 32);
+  }
+}
+
+}
+
+
+/**
+ * Performs the forward Nussbaumer transform with intrinsics.
+ * @param[out] dest    The memory to store the transformed input.
+ * @param[in]  src     The coefficients of the polynomial.
+ */
+AVX2 void nussbaumer1024_forward_intrinsics(Transformed dest, std::uint16_t* src) {
+  forward(dest, src);
+}
+
+/**
+ * Prepare for componentwise32_64_run_intrinsics.
+ * @param[in,out] data   The transformed polynomials.
+ */
+AVX2 void componentwise32_64_prepare_intrinsics(std::uint16_t* data) {
+  prepare(data);
+}
+
+/**
+ * Multiplies the 64 polynomials of 32 coefficients with intrinsics.
+ * @param[out] dest      Stores the result; may be the same as prep1 or prep2.
+ * @param[in]  prep1     The first polynomials, prepared.
+ * @param[in]  prep2     The second polynomials, prepared.
+ */
+AVX2 void componentwise32_64_run_intrinsics(std::uint16_t* dest, std::uint16_t* prep1, std::uint16_t* prep2) {
+  alignas(32) std::uint16_t workspace[WorkspaceWords];
+  run(dest, prep1, prep2, workspace);
+}
+
+/**
+ * Calculate the inverse Nussbaumer transform with intrinsics.
+ * @param[out] dest    The memory region to store the result; may be the same as src.
+ * @param[in]  src     The transformed value.
+ */
+AVX2 void nussbaumer1024_inverse_intrinsics(TransformedResult dest, Transformed src) {
+  inverse(dest, src);
+}
+
+/**
+ * Multiply two polynomials modulo X^1024 + 1 with intrinsics.
+ * @param[out] dest    The 1024 coefficients of the product, reduced modulo 2047.
+ * @param[in]  src1    The first polynomial.
+ * @param[in]  src2    The second polynomial.
+ */
+AVX2 void nussbaumer1024_multiply_intrinsics(std::uint16_t* dest, std::uint16_t* src1, std::uint16_t* src2) {
+  // The workspace doubles as the buffer of the result of the componentwise multiplication.
+  Transformed transformed1, transformed2;
+  alignas(32) std::uint16_t workspace[WorkspaceWords];
+
+  forward(transformed1, src1);
+  prepare(transformed1);
+  forward(transformed2, src2);
+  prepare(transformed2);
+  run(transformed1, transformed1, transformed2, workspace);
+  inverse(dest, transformed1);
+}
+
+/**
+ * Test the schoolbook4 kernel.
+ * @param[in,out] data    The input/output data.
+ */
+AVX2 void schoolbook4_test_intrinsics(std::uint16_t* data) {
+  __m256i a[4], b[4], c[7];
+  for(std::size_t i = 0; i < 4; ++i) {
+    a[i] = load(data + 16*i);
+    b[i] = load(data + 16*(4 + i));
+  }
+  schoolbook4(c, a, b);
+  for(std::size_t k = 0; k < 7; ++k)
+    store(data + 16*k, c[k]);
+}
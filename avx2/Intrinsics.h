@@ -0,0 +1,54 @@
+#ifndef AVX2_INTRINSICS_H_
+#define AVX2_INTRINSICS_H_
+
+#include <cstdint>
+
+#include "avx2/Nussbaumer.h"
+
+/**
+ * Performs the forward Nussbaumer transform with intrinsics. The output is the same, word for word,
+ * as that of nussbaumer1024_forward.
+ * @param[out] dest    The memory to store the transformed input.
+ * @param[in]  src     The coefficients of the polynomial; they must have at most 11 bits.
+ */
+void nussbaumer1024_forward_intrinsics(Transformed dest, std::uint16_t* src);
+
+/**
+ * Prepare for componentwise32_64_run_intrinsics; the same as componentwise32_64_prepare.
+ * @param[in,out] data   The transformed polynomials, in memory of 6912 words.
+ */
+void componentwise32_64_prepare_intrinsics(std::uint16_t* data);
+
+/**
+ * Multiplies the 64 polynomials of 32 coefficients with intrinsics, giving the same output as
+ * componentwise32_64_run. The workspace is taken from the stack, so this function is reentrant.
+ * @param[out] dest      Stores the result; may be the same as prep1 or prep2.
+ * @param[in]  prep1     The first polynomials, prepared.
+ * @param[in]  prep2     The second polynomials, prepared.
+ */
+void componentwise32_64_run_intrinsics(std::uint16_t* dest, std::uint16_t* prep1, std::uint16_t* prep2);
+
+/**
+ * Calculate the inverse Nussbaumer transform with intrinsics, giving the same output as
+ * nussbaumer1024_inverse.
+ * @param[out] dest    The memory region to store the result; may be the same as src.
+ * @param[in]  src     The transformed value; the coefficients must have at most 12 bits.
+ */
+void nussbaumer1024_inverse_intrinsics(TransformedResult dest, Transformed src);
+
+/**
+ * Multiply two polynomials modulo X^1024 + 1 in a single call, with the stages above inlined into
+ * each other.
+ * @param[out] dest    The 1024 coefficients of the product, reduced modulo 2047.
+ * @param[in]  src1    The first polynomial; coefficients must have at most 11 bits.
+ * @param[in]  src2    The second polynomial; coefficients must have at most 11 bits.
+ */
+void nussbaumer1024_multiply_intrinsics(std::uint16_t* dest, std::uint16_t* src1, std::uint16_t* src2);
+
+/**
+ * Test the schoolbook4 kernel, with the same data layout as schoolbook4_test.
+ * @param[in,out] data    The 8 input blocks of 16 words, replaced by the 7 output blocks.
+ */
+void schoolbook4_test_intrinsics(std::uint16_t* data);
+
+#endif
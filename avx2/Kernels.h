@@ -0,0 +1,325 @@
+#ifndef AVX2_KERNELS_H_
+#define AVX2_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include <immintrin.h>
+
+// The files in avx2/ are built for AVX only; these kernels enable AVX2 themselves, and are always
+// inlined so the callers keep the polynomials in registers across kernels.
+#define AVX2_INLINE __attribute__((target("avx2"), always_inline)) inline
+
+/**
+ * The building blocks of the AVX2 transforms, as intrinsics: rotations and butterflies of
+ * polynomials held in registers, transposes, and the multiplication of 4-coefficient polynomials
+ * modulo 2047. The assembly in this directory implements the same operations as macros and
+ * functions with their own register conventions; these can be inlined into any caller.
+ */
+namespace kernels {
+
+/**
+ * Reverse the lowest n bits of a value, at compile time.
+ */
+constexpr unsigned reverseBits(unsigned n, unsigned value) {
+  return n == 0 ? 0 : ((value & 1) << (n - 1)) | reverseBits(n - 1, value >> 1);
+}
+
+/**
+ * Arithmetic modulo 2^16, without any reduction. This works for any power-of-two q, and for
+ * q = 2047 as long as the callers reduce before the values overflow.
+ */
+struct WrapArith {
+  AVX2_INLINE __m256i add(__m256i a, __m256i b) const {
+    return _mm256_add_epi16(a, b);
+  }
+
+  AVX2_INLINE __m256i sub(__m256i a, __m256i b) const {
+    return _mm256_sub_epi16(a, b);
+  }
+
+  AVX2_INLINE __m256i neg(__m256i a) const {
+    return _mm256_sub_epi16(_mm256_setzero_si256(), a);
+  }
+};
+
+/**
+ * Shifts words in from a preceding register: word i of the result is prev[16 - P + i] for i < P,
+ * and cur[i - P] otherwise.
+ */
+template<unsigned P, bool High = (P > 8)>
+struct ShiftIn {
+  AVX2_INLINE static __m256i run(__m256i prev, __m256i cur) {
+    __m256i mid = _mm256_permute2x128_si256(prev, cur, 0x21);
+    return _mm256_alignr_epi8(cur, mid, 16 - 2*P);
+  }
+};
+
+template<unsigned P>
+struct ShiftIn<P, true> {
+  AVX2_INLINE static __m256i run(__m256i prev, __m256i cur) {
+    __m256i mid = _mm256_permute2x128_si256(prev, cur, 0x21);
+    return _mm256_alignr_epi8(mid, prev, 32 - 2*P);
+  }
+};
+
+template<>
+struct ShiftIn<0, false> {
+  AVX2_INLINE static __m256i run(__m256i, __m256i cur) {
+    return cur;
+  }
+};
+
+/**
+ * Multiplies the polynomial in the W registers x by u^K modulo u^(16W) + 1.
+ */
+template<unsigned K, std::size_t W, typename Arith>
+AVX2_INLINE void rotate(__m256i* r, const __m256i* x, const Arith& arith) {
+  constexpr unsigned P = K % 16;
+  constexpr std::size_t Shift = (K / 16) % W;
+  constexpr bool Negate = (K / (16*W)) % 2 == 1;
+
+  // y = x*u^(K - P) moves whole registers, negating the ones that wrap around; ny is -y[W - 1],
+  // which is shifted into the first register.
+  __m256i y[W];
+#pragma GCC unroll 4
+  for(std::size_t i = 0; i < W; ++i) {
+    bool negative = (i < Shift) != Negate;
+    __m256i value = x[(i + W - Shift) % W];
+    y[i] = negative ? arith.neg(value) : value;
+  }
+  constexpr bool LastNegative = (W - 1 < Shift) != Negate;
+  __m256i ny = LastNegative ? x[(2*W - 1 - Shift) % W] : arith.neg(x[(2*W - 1 - Shift) % W]);
+
+  r[0] = ShiftIn<P>::run(ny, y[0]);
+#pragma GCC unroll 4
+  for(std::size_t i = 1; i < W; ++i)
+    r[i] = ShiftIn<P>::run(y[i - 1], y[i]);
+}
+
+/**
+ * Sets (a, b) to (a + u^K*b, a - u^K*b); each polynomial takes W registers.
+ */
+template<unsigned K, std::size_t W, typename Arith>
+AVX2_INLINE void butterfly(__m256i* a, __m256i* b, const Arith& arith) {
+  __m256i rotated[W];
+  rotate<K, W>(rotated, b, arith);
+#pragma GCC unroll 4
+  for(std::size_t i = 0; i < W; ++i) {
+    __m256i ai = a[i];
+    a[i] = arith.add(ai, rotated[i]);
+    b[i] = arith.sub(ai, rotated[i]);
+  }
+}
+
+/**
+ * The split of a multiplication modulo X^N + 1, with N = 2^LgN, into 2m polynomials of r
+ * coefficients, as in NegaNussbaumer: m = 2^floor(LgN/2) and r = N/m.
+ */
+template<unsigned LgN>
+struct Shape {
+  static constexpr unsigned LgM = LgN / 2;
+  static constexpr std::size_t M = std::size_t(1) << LgM;
+  static constexpr std::size_t R = (std::size_t(1) << LgN) / M;
+
+  /// The number of registers holding one polynomial.
+  static constexpr std::size_t W = R / 16;
+};
+
+/**
+ * The reduction policy of the transform levels below, for arithmetic that keeps its values in
+ * range by itself. A policy is called around every butterfly of level J, on the W registers of
+ * both polynomials, to reduce where the bounds of the arithmetic require it.
+ */
+struct NoReduction {
+  template<unsigned J, std::size_t W>
+  AVX2_INLINE void beforeForward(__m256i*, __m256i*) const {
+  }
+
+  template<unsigned J, std::size_t W>
+  AVX2_INLINE void afterForward(__m256i*, __m256i*) const {
+  }
+
+  template<unsigned J, std::size_t W>
+  AVX2_INLINE void afterInverse(__m256i*, __m256i*) const {
+  }
+};
+
+/**
+ * The butterflies of forward level J for one value of the higher bits, starting at polynomial s.
+ */
+template<typename S, unsigned J, unsigned K, typename Arith, typename Reduction>
+AVX2_INLINE void forwardBlock(__m256i* pols, std::size_t s, const Arith& arith, const Reduction& reduction) {
+  for(std::size_t t = 0; t < (1u << J); ++t) {
+    __m256i* a = pols + S::W*(s + t);
+    __m256i* b = pols + S::W*(s + t + (1u << J));
+    reduction.template beforeForward<J, S::W>(a, b);
+    butterfly<K, S::W>(a, b, arith);
+    reduction.template afterForward<J, S::W>(a, b);
+  }
+}
+
+/**
+ * Forward level J on the 2m polynomials, where the power of u depends on the higher bits.
+ */
+template<typename S, unsigned J, typename Arith, typename Reduction, std::size_t... SPart>
+AVX2_INLINE void forwardLevel(__m256i* pols, const Arith& arith, const Reduction& reduction,
+                              std::index_sequence<SPart...>) {
+  int expand[] = {
+    (forwardBlock<S, J, (S::R/S::M)*(reverseBits(S::LgM - J, SPart) << J)>(pols, SPart << (J + 1), arith,
+                                                                          reduction), 0)...
+  };
+  (void)expand;
+}
+
+/**
+ * Forward levels J down to 0.
+ */
+template<typename S, int J, typename Arith, typename Reduction>
+struct ForwardLevels {
+  AVX2_INLINE static void run(__m256i* pols, const Arith& arith, const Reduction& reduction) {
+    forwardLevel<S, J>(pols, arith, reduction, std::make_index_sequence<(S::M >> J)>());
+    ForwardLevels<S, J - 1, Arith, Reduction>::run(pols, arith, reduction);
+  }
+};
+
+template<typename S, typename Arith, typename Reduction>
+struct ForwardLevels<S, -1, Arith, Reduction> {
+  AVX2_INLINE static void run(__m256i*, const Arith&, const Reduction&) {
+  }
+};
+
+/**
+ * The butterflies of inverse level J for polynomials with lower bits T.
+ */
+template<typename S, unsigned J, unsigned T, typename Arith, typename Reduction>
+AVX2_INLINE void inverseColumn(__m256i* pols, const Arith& arith, const Reduction& reduction) {
+  constexpr unsigned K = (2*S::R - (S::R/S::M)*(T << (S::LgM - J))) % (2*S::R);
+  for(std::size_t s = 0; s < 2*S::M; s += (2u << J)) {
+    __m256i* a = pols + S::W*(s + T);
+    __m256i* b = pols + S::W*(s + T + (1u << J));
+    butterfly<K, S::W>(a, b, arith);
+    reduction.template afterInverse<J, S::W>(a, b);
+  }
+}
+
+/**
+ * Inverse level J on the 2m polynomials, where the power of u depends on the lower bits.
+ */
+template<typename S, unsigned J, typename Arith, typename Reduction, std::size_t... T>
+AVX2_INLINE void inverseLevel(__m256i* pols, const Arith& arith, const Reduction& reduction,
+                              std::index_sequence<T...>) {
+  int expand[] = { (inverseColumn<S, J, T>(pols, arith, reduction), 0)... };
+  (void)expand;
+}
+
+/**
+ * Inverse levels J up to log2(m).
+ */
+template<typename S, unsigned J, typename Arith, typename Reduction, bool Done = (J > S::LgM)>
+struct InverseLevels {
+  AVX2_INLINE static void run(__m256i* pols, const Arith& arith, const Reduction& reduction) {
+    inverseLevel<S, J>(pols, arith, reduction, std::make_index_sequence<(1u << J)>());
+    InverseLevels<S, J + 1, Arith, Reduction>::run(pols, arith, reduction);
+  }
+};
+
+template<typename S, unsigned J, typename Arith, typename Reduction>
+struct InverseLevels<S, J, Arith, Reduction, true> {
+  AVX2_INLINE static void run(__m256i*, const Arith&, const Reduction&) {
+  }
+};
+
+/**
+ * Transposes a 16x16 matrix of words in registers.
+ */
+AVX2_INLINE void transpose16x16(__m256i* rows) {
+  // Transpose the 8x8 blocks within each 128-bit lane.
+  __m256i s[16], u[16], v[16];
+  for(std::size_t h = 0; h < 16; h += 8) {
+    for(std::size_t i = 0; i < 8; i += 2) {
+      s[h + i] = _mm256_unpacklo_epi16(rows[h + i], rows[h + i + 1]);
+      s[h + i + 1] = _mm256_unpackhi_epi16(rows[h + i], rows[h + i + 1]);
+    }
+    for(std::size_t i = 0; i < 2; ++i) {
+      u[h + 2*i] = _mm256_unpacklo_epi32(s[h + i], s[h + i + 2]);
+      u[h + 2*i + 1] = _mm256_unpackhi_epi32(s[h + i], s[h + i + 2]);
+      u[h + 2*i + 4] = _mm256_unpacklo_epi32(s[h + i + 4], s[h + i + 6]);
+      u[h + 2*i + 5] = _mm256_unpackhi_epi32(s[h + i + 4], s[h + i + 6]);
+    }
+    for(std::size_t i = 0; i < 4; ++i) {
+      v[h + 2*i] = _mm256_unpacklo_epi64(u[h + i], u[h + i + 4]);
+      v[h + 2*i + 1] = _mm256_unpackhi_epi64(u[h + i], u[h + i + 4]);
+    }
+  }
+
+  // Combine the lanes of the blocks of the first and last 8 rows.
+  for(std::size_t i = 0; i < 8; ++i) {
+    rows[i] = _mm256_permute2x128_si256(v[i], v[8 + i], 0x20);
+    rows[8 + i] = _mm256_permute2x128_si256(v[i], v[8 + i], 0x31);
+  }
+}
+
+/**
+ * Transposes 16x16 blocks of words between memory regions.
+ * @param[out] dest        The first row of the destination block.
+ * @param[in]  destStride  The distance between destination rows, in words.
+ * @param[in]  src         The first row of the source block.
+ * @param[in]  srcStride   The distance between source rows, in words.
+ */
+AVX2_INLINE void transposeBlock(std::uint16_t* dest, std::size_t destStride, const std::uint16_t* src,
+                           std::size_t srcStride) {
+  __m256i rows[16];
+  for(std::size_t i = 0; i < 16; ++i)
+    rows[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(src + i*srcStride));
+  transpose16x16(rows);
+  for(std::size_t i = 0; i < 16; ++i)
+    _mm256_store_si256(reinterpret_cast<__m256i*>(dest + i*destStride), rows[i]);
+}
+
+/**
+ * Partially reduces non-negative values modulo 2047, using 2^11 = 1: the result is at most
+ * 2047 + (x >> 11).
+ */
+AVX2_INLINE __m256i reduce2047(__m256i x) {
+  return _mm256_add_epi16(_mm256_and_si256(x, _mm256_set1_epi16(0x7FF)), _mm256_srli_epi16(x, 11));
+}
+
+/**
+ * Partially reduces signed values modulo 2047, by first adding 16*2047 to make them positive. The
+ * result has at most 12 bits.
+ */
+AVX2_INLINE __m256i reduce2047Signed(__m256i x) {
+  return reduce2047(_mm256_add_epi16(x, _mm256_set1_epi16(16*2047)));
+}
+
+/**
+ * Multiplies sixteen pairs of polynomials with four coefficients modulo 2047, by the schoolbook
+ * method. The inputs must be non-negative and have at most 15 bits. The results are partially
+ * reduced: c[0] and c[6] have at most 13 bits, the others at most 14.
+ * @param[out] c    The seven coefficients of the products.
+ * @param[in]  a    The four coefficients of the first polynomials.
+ * @param[in]  b    The four coefficients of the second polynomials.
+ */
+AVX2_INLINE void schoolbook4(__m256i* c, const __m256i* a, const __m256i* b) {
+  const __m256i mask = _mm256_set1_epi16(0x7FF);
+
+#pragma GCC unroll 7
+  for(std::size_t k = 0; k < 7; ++k) {
+    // Sum the reduced low words and the high words of the products separately; 2^16 is 32 modulo
+    // 2047, so the high words are multiplied by 32 before reducing.
+    __m256i low = _mm256_setzero_si256(), high = _mm256_setzero_si256();
+#pragma GCC unroll 4
+    for(std::size_t i = (k < 4 ? 0 : k - 3); i <= (k < 4 ? k : 3); ++i) {
+      low = _mm256_add_epi16(low, reduce2047(_mm256_mullo_epi16(a[i], b[k - i])));
+      high = _mm256_add_epi16(high, _mm256_mulhi_epu16(a[i], b[k - i]));
+    }
+    __m256i highReduced = _mm256_and_si256(_mm256_slli_epi16(high, 5), mask);
+    c[k] = _mm256_add_epi16(low, _mm256_add_epi16(highReduced, _mm256_srli_epi16(high, 6)));
+  }
+}
+
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef AVX2_MULTIPLY_H_
+#define AVX2_MULTIPLY_H_
+
+#include <cstdint>
+
+/**
+ * Multiply two polynomials modulo X^1024 + 1 in a single call, keeping all intermediate values
+ * in about 54 KB of stack. Each operand is transformed and prepared in one pass (see
+ * nussbaumer1024_forward_prepare_r); the componentwise multiplication and the inverse transform
+ * run as in the six-call sequence.
+ * @param[out] dest    The 1024 coefficients of the product, reduced modulo 2047.
+ * @param[in]  src1    The first polynomial; coefficients must have at most 11 bits.
+ * @param[in]  src2    The second polynomial; coefficients must have at most 11 bits.
+ */
+extern "C" void nussbaumer1024_multiply(std::uint16_t* dest, std::uint16_t* src1, std::uint16_t* src2);
+
+#endif
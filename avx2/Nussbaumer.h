@@ -16,17 +16,54 @@ typedef std::uint16_t Transformed[6912] __attribute__((aligned(32)));
 typedef std::uint16_t TransformedResult[6912] __attribute__((aligned(32)));
 
 /**
- * Performs the forward Nussbaumer transform.
+ * Scratch memory used by the forward and inverse transforms. Each thread running a transform
+ * concurrently needs its own.
+ */
+typedef std::uint16_t NussbaumerScratch[2048] __attribute__((aligned(32)));
+
+/**
+ * Performs the forward Nussbaumer transform. The scratch memory is taken from the stack, so
+ * this function is reentrant.
  * @param[out] dest    The memory to store the transformed input.
  * @param[in]  src     The coefficients of the polynomial.
  */
 extern "C" void nussbaumer1024_forward(Transformed dest, std::uint16_t* src);
 
 /**
- * Calculate the inverse Nussbaumer transform.
+ * Calculate the inverse Nussbaumer transform. The scratch memory is taken from the stack, so
+ * this function is reentrant.
  * @param[out] dest    The memory region to store the result.
  * @param[in] src      The transformed value.
  */
 extern "C" void nussbaumer1024_inverse(TransformedResult dest, Transformed src);
 
+/**
+ * Performs the forward Nussbaumer transform, using caller-supplied scratch memory. Calls with
+ * different scratch areas may run concurrently.
+ * @param[out] dest    The memory to store the transformed input.
+ * @param[in]  src     The coefficients of the polynomial.
+ * @param[in]  scratch Scratch memory, overwritten.
+ */
+extern "C" void nussbaumer1024_forward_r(Transformed dest, std::uint16_t* src, NussbaumerScratch scratch);
+
+/**
+ * Performs the forward Nussbaumer transform and componentwise32_64_prepare in one pass, using
+ * caller-supplied scratch memory: each block of 16 columns is prepared as soon as it is
+ * transposed into dest, while it is in the L1 cache. The output is the same as that of the two
+ * calls.
+ * @param[out] dest    The memory to store the transformed and prepared input.
+ * @param[in]  src     The coefficients of the polynomial.
+ * @param[in]  scratch Scratch memory, overwritten.
+ */
+extern "C" void nussbaumer1024_forward_prepare_r(Transformed dest, std::uint16_t* src, NussbaumerScratch scratch);
+
+/**
+ * Calculate the inverse Nussbaumer transform, using caller-supplied scratch memory. Calls with
+ * different scratch areas may run concurrently.
+ * @param[out] dest    The memory region to store the result.
+ * @param[in]  src     The transformed value.
+ * @param[in]  scratch Scratch memory, overwritten.
+ */
+extern "C" void nussbaumer1024_inverse_r(TransformedResult dest, Transformed src, NussbaumerScratch scratch);
+
 #endif
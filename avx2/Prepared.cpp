@@ -0,0 +1,73 @@
+#include "avx2/Prepared.h"
+#include "avx2/Componentwise.h"
+
+namespace {
+/// Header of a serialized prepared operand: the magic "NB", the ring dimension 1024 and version 2.
+const std::uint8_t PreparedHeader[8] = {'N', 'B', 0x00, 0x04, 0x02, 0x00, 0x00, 0x00};
+
+/// The transformed polynomial, 32 coefficients of 64 polynomials, which the rest is derived from;
+/// only this is serialized
+const std::size_t PreparedTransformedSize = 32*64;
+
+/// The forward transform outputs coefficients of at most 14 bits (see nussbaumer1024_forward_r).
+const std::uint16_t PreparedMaxTransformed = (1 << 14) - 1;
+}
+
+
+/**
+ * Transform and prepare a polynomial for repeated multiplication.
+ * @param[out] dest    The prepared operand.
+ * @param[in]  src     The coefficients of the polynomial.
+ */
+void nussbaumer1024_prepare_operand(NussbaumerPreparedOperand* dest, std::uint16_t* src) {
+  NussbaumerScratch scratch;
+  nussbaumer1024_forward_prepare_r(dest->data, src, scratch);
+}
+
+
+/**
+ * Serialize the transformed polynomial of a prepared operand.
+ * @param[out] dest      The bytes to write to.
+ * @param[in]  prepared  The operand to serialize.
+ */
+void nussbaumer1024_serialize_prepared(std::uint8_t* dest, const NussbaumerPreparedOperand& prepared) {
+  for(std::size_t i = 0; i < sizeof(PreparedHeader); ++i)
+    *dest++ = PreparedHeader[i];
+
+  for(std::size_t i = 0; i < PreparedTransformedSize; ++i) {
+    *dest++ = prepared.data[i] & 0xFF;
+    *dest++ = prepared.data[i] >> 8;
+  }
+}
+
+
+/**
+ * Deserialize a prepared operand. The transformed polynomial must be within the bounds of the
+ * forward transform, so that the multiplication can rely on them; the regions derived from it
+ * are then computed with componentwise32_64_prepare.
+ * @param[out] prepared  The operand to restore.
+ * @param[in]  src       The bytes to read from.
+ * @param[in]  len       The number of bytes at src.
+ * @return    true on success, false if the data is not a valid prepared operand.
+ */
+bool nussbaumer1024_deserialize_prepared(NussbaumerPreparedOperand& prepared, const std::uint8_t* src,
+                                         std::size_t len) {
+  if(len != NussbaumerPreparedSerializedSize)
+    return false;
+
+  for(std::size_t i = 0; i < sizeof(PreparedHeader); ++i)
+    if(*src++ != PreparedHeader[i])
+      return false;
+
+  for(std::size_t i = 0; i < PreparedTransformedSize; ++i) {
+    std::uint16_t value = src[0] | (src[1] << 8);
+    if(value > PreparedMaxTransformed)
+      return false;
+
+    prepared.data[i] = value;
+    src += 2;
+  }
+
+  componentwise32_64_prepare(prepared.data);
+  return true;
+}
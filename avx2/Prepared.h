@@ -0,0 +1,62 @@
+#ifndef AVX2_PREPARED_H_
+#define AVX2_PREPARED_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "avx2/Nussbaumer.h"
+
+/**
+ * An operand that has been transformed and prepared for the componentwise multiplication, so
+ * that it can be multiplied with many other polynomials without repeating that work. The
+ * contents are internal to the AVX2 implementation; use the serialization functions to store
+ * or transmit it.
+ */
+struct NussbaumerPreparedOperand {
+  Transformed data;
+};
+
+/**
+ * The number of bytes of a serialized prepared operand: an 8-byte header, followed by the 2048
+ * coefficients of the transformed polynomial as little-endian 16-bit integers. The rest of the
+ * operand is derived from these when it is deserialized.
+ */
+constexpr std::size_t NussbaumerPreparedSerializedSize = 8 + 2*2048;
+
+/**
+ * Transform and prepare a polynomial for repeated multiplication.
+ * @param[out] dest    The prepared operand.
+ * @param[in]  src     The coefficients of the polynomial; must have at most 11 bits.
+ */
+void nussbaumer1024_prepare_operand(NussbaumerPreparedOperand* dest, std::uint16_t* src);
+
+/**
+ * Multiply a polynomial modulo X^1024 + 1 with a prepared operand. This skips the forward transform
+ * and preparation of one of the operands, which is about half the transform cost.
+ * @param[out] dest      The 1024 coefficients of the product, reduced modulo 2047.
+ * @param[in]  prepared  The prepared operand; it is not modified.
+ * @param[in]  src       The other polynomial; coefficients must have at most 11 bits.
+ */
+extern "C" void nussbaumer1024_multiply_prepared(std::uint16_t* dest, const NussbaumerPreparedOperand* prepared,
+                                                 std::uint16_t* src);
+
+/**
+ * Serialize a prepared operand.
+ * @param[out] dest      NussbaumerPreparedSerializedSize bytes to write to.
+ * @param[in]  prepared  The operand to serialize.
+ */
+void nussbaumer1024_serialize_prepared(std::uint8_t* dest, const NussbaumerPreparedOperand& prepared);
+
+/**
+ * Deserialize a prepared operand, verifying the length, the header and the bound the
+ * multiplication relies on: the transformed polynomial must have at most 14 bits. The sums
+ * derived from it are recomputed. The operand may be partly overwritten when this fails.
+ * @param[out] prepared  The operand to restore.
+ * @param[in]  src       The bytes to read from.
+ * @param[in]  len       The number of bytes at src; must be NussbaumerPreparedSerializedSize.
+ * @return    true on success, false if the data is not a valid prepared operand.
+ */
+bool nussbaumer1024_deserialize_prepared(NussbaumerPreparedOperand& prepared, const std::uint8_t* src,
+                                         std::size_t len);
+
+#endif
@@ -1,6 +1,11 @@
 .code64
+# All code here needs AVX2; it is kept apart from the portable code (see dispatch/Dispatch.h).
+.section nussbaumer_backend, "ax", @progbits
 .global componentwise32_64_prepare
+.global componentwise32_64_prepare_columns
 .global componentwise32_64_run
+.global componentwise32_64_run_r
+.global componentwise32_64_workspace_size
 .extern reduce_mask
 .extern schoolbook4
 
@@ -10,17 +15,9 @@
     vpaddw        \reg, \reg, \temp_reg
 .endm
 
-# Prepare for componentwise multiplication through the Karatusba method, of 64 polynomials
-# with 32 coefficients each. The input consists of 32*64 16-bit integers, where the first
-# 64 integers represent the first coefficients, the next the second coefficients, etc. The
-# output, which is also the input, requires room for 6912 16-bit integers.
-# The inputs must have at most 14 bits, and be non-negative.
-# The outputs have at most 15 bits.
-componentwise32_64_prepare:
-    vmovdqa       ymm15, [reduce_mask]
-    mov           rcx, 16
-
-.loop:
+# One step of the preparation below: the sums of the 16 columns at rdi, of the rows 0, 4, ..., 28 relative to rdi.
+# ymm15 must hold the reduce_mask.
+.macro prepare_step
     vmovdqa       ymm0, [rdi]
     vmovdqa       ymm1, [rdi + 64*2*4]
     vmovdqa       ymm2, [rdi + 64*2*8]
@@ -91,6 +88,20 @@ componentwise32_64_prepare:
     vpaddw        ymm6, ymm6, ymm7
     vmovdqa       [rdi + (8 + 4 + 6 + 3)*64*2*4], ymm6
 
+.endm
+
+# Prepare for componentwise multiplication through the Karatusba method, of 64 polynomials
+# with 32 coefficients each. The input consists of 32*64 16-bit integers, where the first
+# 64 integers represent the first coefficients, the next the second coefficients, etc. The
+# output, which is also the input, requires room for 6912 16-bit integers.
+# The inputs must have at most 14 bits, and be non-negative.
+# The outputs have at most 15 bits.
+componentwise32_64_prepare:
+    vmovdqa       ymm15, [reduce_mask]
+    mov           rcx, 16
+
+.loop:
+    prepare_step
     add           rdi, 32
     dec           rcx
     jnz           .loop
@@ -98,14 +109,50 @@ componentwise32_64_prepare:
     ret
 
 
+# Prepare 16 columns of the input of componentwise32_64_prepare (the same 16 of each of the 32 rows), given at rdi, as
+# componentwise32_64_prepare does for all of them. This lets the forward transform prepare each block of columns it
+# has transposed while it is still in the L1 cache (see nussbaumer1024_forward_prepare_r).
+componentwise32_64_prepare_columns:
+    vmovdqa       ymm15, [reduce_mask]
+    mov           rcx, 4
+
+.loop_columns:
+    prepare_step
+    add           rdi, 64*2
+    dec           rcx
+    jnz           .loop_columns
+
+    ret
+
+
+
+# Execute the componentwise multiplication prepared above, using a workspace on the stack. This is a wrapper around
+# componentwise32_64_run_r.
+componentwise32_64_run:
+    push          rbp
+    mov           rbp, rsp
+    sub           rsp, 2*64*8*27
+    and           rsp, -32
+    mov           rcx, rsp
+    call          componentwise32_64_run_r
+    mov           rsp, rbp
+    pop           rbp
+    ret
+
 
 # Actually execute the componentwise multiplication prepared above.
 # The output will have at most 12 bits.
-componentwise32_64_run:
+# The workspace of 2*64*8*27 bytes is given in rcx, and must be 32-byte aligned. It is the only memory written
+# besides the destination, so calls with different workspaces may run concurrently.
+# The destination may be the same as the first prepared input.
+componentwise32_64_run_r:
+    push          r12
+    mov           r12, rcx
+
     # First, multiply all the 4-degree polynomials by the schoolbook method
     # We multiply 27 groups of 4-polynomials with 64 coefficients
     mov           rcx, 27
-    lea           r9, [buffer]
+    lea           r9, [r12]
 .run_line:
     # Loop through 4 blocks of 16 coefficients
     xor           rax, rax
@@ -145,8 +192,8 @@ componentwise32_64_run:
     # Perform the Karatsuba steps for 8-bit polynomials                #
     ####################################################################
     mov           rax, 9
-    lea           r8, [buffer]
-    lea           r10, [buffer]
+    lea           r8, [r12]
+    lea           r10, [r12]
 
     # Perform a reduction, so the result will be at most 12 bits.
     vmovdqa       ymm15, [reduce_mask]
@@ -221,8 +268,8 @@ componentwise32_64_run:
     # Perform the Karatsuba steps for 16-bit polynomials               #
     ####################################################################
     mov           rax, 3
-    lea           r8, [buffer]
-    lea           r10, [buffer]
+    lea           r8, [r12]
+    lea           r10, [r12]
 .karatsuba16_loop:
     mov           rcx, 128*6 + 32*3
 .next_coef16:
@@ -271,12 +318,12 @@ componentwise32_64_run:
     ####################################################################
     mov           rcx, 128*14 + 32*3
 .karatsuba32_next_coef:
-    vmovdqa       ymm0, [buffer + 0*128 + rcx]
-    vmovdqa       ymm1, [buffer + 16*128 + rcx]
-    vmovdqa       ymm2, [buffer + 32*128 + rcx]
-    vmovdqa       ymm3, [buffer + 48*128 + rcx]
-    vmovdqa       ymm4, [buffer + 64*128 + rcx]
-    vmovdqa       ymm5, [buffer + 80*128 + rcx]
+    vmovdqa       ymm0, [r12 + 0*128 + rcx]
+    vmovdqa       ymm1, [r12 + 16*128 + rcx]
+    vmovdqa       ymm2, [r12 + 32*128 + rcx]
+    vmovdqa       ymm3, [r12 + 48*128 + rcx]
+    vmovdqa       ymm4, [r12 + 64*128 + rcx]
+    vmovdqa       ymm5, [r12 + 80*128 + rcx]
 
     vpsubw        ymm6, ymm1, ymm2
     vpaddw        ymm7, ymm0, ymm3
@@ -307,9 +354,9 @@ componentwise32_64_run:
     mov           rcx, 32*3
 .next_coef32_final:
     # Calculate the final coefficient
-    vmovdqa       ymm0, [buffer + 15*128 + rcx]
-    vmovdqa       ymm2, [buffer + (32 + 15)*128 + rcx]
-    vmovdqa       ymm4, [buffer + (2*32 + 15)*128 + rcx]
+    vmovdqa       ymm0, [r12 + 15*128 + rcx]
+    vmovdqa       ymm2, [r12 + (32 + 15)*128 + rcx]
+    vmovdqa       ymm4, [r12 + (2*32 + 15)*128 + rcx]
 
     vpsubw        ymm5, ymm0, ymm2
     vpsubw        ymm6, ymm4, ymm0
@@ -325,12 +372,14 @@ componentwise32_64_run:
     sub           rcx, 32
     jns           .next_coef32_final
 
+    pop           r12
     ret
 
 
-.section .bss
-.align 32
-buffer: .space 2*64*8*27
+# Return the number of bytes of workspace needed by componentwise32_64_run_r.
+componentwise32_64_workspace_size:
+    mov           rax, 2*64*8*27
+    ret
 
 .section .rodata
 .align 32
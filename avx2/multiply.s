@@ -0,0 +1,106 @@
+.code64
+# All code here needs AVX2; it is kept apart from the portable code (see dispatch/Dispatch.h).
+.section nussbaumer_backend, "ax", @progbits
+.global nussbaumer1024_multiply
+.global nussbaumer1024_multiply_prepared
+.extern nussbaumer1024_forward_prepare_r
+.extern nussbaumer1024_inverse_r
+.extern componentwise32_64_run_r
+
+# Layout of the stack frame of nussbaumer1024_multiply: two transformed polynomials, followed by the workspace of the
+# componentwise multiplication. The workspace doubles as the scratch area of the transforms, as they never run at the
+# same time.
+.set FRAME_TRANS1, 0
+.set FRAME_TRANS2, 2*6912
+.set FRAME_WORKSPACE, 2*2*6912
+.set FRAME_SIZE, 2*2*6912 + 2*64*8*27
+
+
+# Multiply two polynomials modulo X^1024 + 1 in one call. The input coefficients must have at most 11 bits; the output
+# will be properly reduced. All intermediate values are kept on the stack (about 54 KB), so the function is reentrant.
+# Parameters:
+#   rdi: The destination, 1024 coefficients.
+#   rsi: The first polynomial.
+#   rdx: The second polynomial.
+nussbaumer1024_multiply:
+    push          rbp
+    mov           rbp, rsp
+    push          rbx
+    push          r12
+    sub           rsp, FRAME_SIZE
+    and           rsp, -32
+    mov           rbx, rdi
+    mov           r12, rdx
+
+    # Transform both inputs, each prepared right after its transform
+    lea           rdi, [rsp + FRAME_TRANS1]
+    lea           rdx, [rsp + FRAME_WORKSPACE]
+    call          nussbaumer1024_forward_prepare_r
+
+    lea           rdi, [rsp + FRAME_TRANS2]
+    mov           rsi, r12
+    lea           rdx, [rsp + FRAME_WORKSPACE]
+    call          nussbaumer1024_forward_prepare_r
+
+    # Multiply, overwriting the first transformed polynomial
+    lea           rdi, [rsp + FRAME_TRANS1]
+    lea           rsi, [rsp + FRAME_TRANS1]
+    lea           rdx, [rsp + FRAME_TRANS2]
+    lea           rcx, [rsp + FRAME_WORKSPACE]
+    call          componentwise32_64_run_r
+
+    # Transform back into the destination
+    mov           rdi, rbx
+    lea           rsi, [rsp + FRAME_TRANS1]
+    lea           rdx, [rsp + FRAME_WORKSPACE]
+    call          nussbaumer1024_inverse_r
+
+    lea           rsp, [rbp - 16]
+    pop           r12
+    pop           rbx
+    pop           rbp
+    ret
+
+
+# Multiply a polynomial modulo X^1024 + 1 with a prepared operand (see nussbaumer1024_prepare_operand). This uses the
+# same stack frame as nussbaumer1024_multiply, leaving the second transformed polynomial unused.
+# Parameters:
+#   rdi: The destination, 1024 coefficients.
+#   rsi: The prepared operand.
+#   rdx: The other polynomial.
+nussbaumer1024_multiply_prepared:
+    push          rbp
+    mov           rbp, rsp
+    push          rbx
+    push          r12
+    sub           rsp, FRAME_SIZE
+    and           rsp, -32
+    mov           rbx, rdi
+    mov           r12, rsi
+
+    # Transform and prepare the other polynomial
+    lea           rdi, [rsp + FRAME_TRANS1]
+    mov           rsi, rdx
+    lea           rdx, [rsp + FRAME_WORKSPACE]
+    call          nussbaumer1024_forward_prepare_r
+
+    # Multiply, overwriting the transformed polynomial (but never the prepared operand)
+    lea           rdi, [rsp + FRAME_TRANS1]
+    lea           rsi, [rsp + FRAME_TRANS1]
+    mov           rdx, r12
+    lea           rcx, [rsp + FRAME_WORKSPACE]
+    call          componentwise32_64_run_r
+
+    # Transform back into the destination
+    mov           rdi, rbx
+    lea           rsi, [rsp + FRAME_TRANS1]
+    lea           rdx, [rsp + FRAME_WORKSPACE]
+    call          nussbaumer1024_inverse_r
+
+    lea           rsp, [rbp - 16]
+    pop           r12
+    pop           rbx
+    pop           rbp
+    ret
+
+.section .note.GNU-stack,"",@progbits
@@ -1,9 +1,15 @@
 .code64
+# All code here needs AVX2; it is kept apart from the portable code (see dispatch/Dispatch.h).
+.section nussbaumer_backend, "ax", @progbits
 .global nussbaumer1024_forward
 .global nussbaumer1024_inverse
+.global nussbaumer1024_forward_r
+.global nussbaumer1024_inverse_r
+.global nussbaumer1024_forward_prepare_r
 .extern transposew16x16
 .extern transposew16x16_64
 .extern reduce_mask
+.extern componentwise32_64_prepare_columns
 
 # Rotate the polynomial a certain number of places. The number of places must be at most 15.
 # ymm15 will be subtracted from (so this must be equal to 0, modulo the choosen q).
@@ -107,22 +113,116 @@
 .endm
 
 
+# Perform the Nussbaumer forward transform, using a scratch area of 4096 bytes on the stack. This is a wrapper around
+# nussbaumer1024_forward_r, kept for callers that do not manage their own scratch memory.
+nussbaumer1024_forward:
+    push          rbp
+    mov           rbp, rsp
+    sub           rsp, 4096
+    and           rsp, -32
+    mov           rdx, rsp
+    call          nussbaumer1024_forward_r
+    mov           rsp, rbp
+    pop           rbp
+    ret
+
+
 # Perform the Nussbaumer forward transform. The coefficients in the output will have at most 14 bits and will be
 # non-negative.
-nussbaumer1024_forward:
+# The scratch area of 4096 bytes is given in rdx, and must be 32-byte aligned. It is the only memory written
+# besides the destination, so calls with different scratch areas may run concurrently.
+nussbaumer1024_forward_r:
+    push          rbx
+    push          r12
+    mov           r12, rdx
+    call          forward_levels
+
+    # Transpose the data
+    lea           rsi, [r12]
+    mov           rdi, rdx
+    call          transpose_block
+
+    lea           rsi, [r12 + 1*2*32*16]
+    add           rdi, 2*16
+    call          transpose_block
+
+    lea           rsi, [r12 + 2*2*32*16]
+    add           rdi, 2*16
+    call          transpose_block
+
+    lea           rsi, [r12 + 3*2*32*16]
+    add           rdi, 2*16
+    call          transpose_block
+
+    lea           rsi, [r12 + 32]
+    add           rdi, 64*2*16 - 3*2*16
+    call          transpose_block
+
+    lea           rsi, [r12 + 32 + 1*2*32*16]
+    add           rdi, 2*16
+    call          transpose_block
+
+    lea           rsi, [r12 + 32 + 2*2*32*16]
+    add           rdi, 2*16
+    call          transpose_block
+
+    lea           rsi, [r12 + 32 + 3*2*32*16]
+    add           rdi, 2*16
+    call          transpose_block
+
+    pop           r12
+    pop           rbx
+    ret
+
+
+# Transpose one block of 16 columns of the transformed polynomial into the destination, rows 0-15 and then rows 16-31,
+# and prepare these columns for the componentwise multiplication right away, while they are in the L1 cache.
+.macro transpose_prepare_columns col
+    lea           rsi, [r12 + \col*2*32*16]
+    lea           rdi, [rdx + \col*2*16]
+    call          transpose_block
+
+    lea           rsi, [r12 + 32 + \col*2*32*16]
+    lea           rdi, [rdx + \col*2*16 + 64*2*16]
+    call          transpose_block
+
+    lea           rdi, [rdx + \col*2*16]
+    call          componentwise32_64_prepare_columns
+.endm
+
+# Perform the forward transform and the preparation for the componentwise multiplication (componentwise32_64_prepare)
+# in one pass over the output: each block of 16 columns is prepared as soon as it is transposed, rather than in a
+# second pass over all 6912 words. The arguments are the same as for nussbaumer1024_forward_r.
+nussbaumer1024_forward_prepare_r:
     push          rbx
+    push          r12
+    mov           r12, rdx
+    call          forward_levels
+
+    transpose_prepare_columns 0
+    transpose_prepare_columns 1
+    transpose_prepare_columns 2
+    transpose_prepare_columns 3
 
+    pop           r12
+    pop           rbx
+    ret
+
+
+# The levels of the forward transform, from the source in rsi into the scratch area in r12, still to be transposed
+# into the destination. The destination in rdi is moved to rdx; rbx is overwritten.
+forward_levels:
     # Perform the transform of the matrix, duplicated twice.
     mov           rdx, rdi
-    lea           rdi, [buffer]
+    lea           rdi, [r12]
     call          transpose_block_double
 
     add           rsi, 32
-    lea           rdi, [buffer + 2*512]
+    lea           rdi, [r12 + 2*512]
     call          transpose_block_double
 
     add           rsi, 2*512 - 32
-    lea           rdi, [buffer + 32]
+    lea           rdi, [r12 + 32]
     call          transpose_block_double
 
     add           rsi, 32
@@ -139,7 +239,7 @@ nussbaumer1024_forward:
     # j = 4, 3                                                                              #
     #########################################################################################
     # Repeat 8 blocks of 4, 2 levels of depth
-    lea           rbx, [buffer]
+    lea           rbx, [r12]
     mov           rcx, 8
 .lower_j4_3:
     load_pols     rbx, 8
@@ -181,7 +281,7 @@ nussbaumer1024_forward:
     # j = 2, 1                                                                              #
     # Distances 4 and 2                                                                     #
     #########################################################################################
-    lea           rbx, [buffer]
+    lea           rbx, [r12]
     mov           rcx, 8                              # 8 blocks
     xor           r11, r11
     lea           rsi, forward_2_1_bf
@@ -257,7 +357,7 @@ nussbaumer1024_forward:
     # Distance 1; first element is not calculated, as it is not used in the algorithm.      #
     # Each input will first be reduced once, as it won't fit otherwise.                     #
     #########################################################################################
-    lea           rbx, [buffer]
+    lea           rbx, [r12]
 
     # This part won't use ymm4/ymm5 anymore. Use ymm4 to store the addition required to make all
     # numbers positive, and in ymm5 store the mask used for the reduction.
@@ -294,81 +394,63 @@ nussbaumer1024_forward:
     add           rbx, 2*32*2
     dec           rcx
     jnz           .j3
+    ret
 
-    # Transpose the data
-    lea           rsi, [buffer]
-    mov           rdi, rdx
-    call          transpose_block
-
-    lea           rsi, [buffer + 1*2*32*16]
-    add           rdi, 2*16
-    call          transpose_block
-
-    lea           rsi, [buffer + 2*2*32*16]
-    add           rdi, 2*16
-    call          transpose_block
-
-    lea           rsi, [buffer + 3*2*32*16]
-    add           rdi, 2*16
-    call          transpose_block
-
-    lea           rsi, [buffer + 32]
-    add           rdi, 64*2*16 - 3*2*16
-    call          transpose_block
-
-    lea           rsi, [buffer + 32 + 1*2*32*16]
-    add           rdi, 2*16
-    call          transpose_block
-
-    lea           rsi, [buffer + 32 + 2*2*32*16]
-    add           rdi, 2*16
-    call          transpose_block
-
-    lea           rsi, [buffer + 32 + 3*2*32*16]
-    add           rdi, 2*16
-    call          transpose_block
 
-    pop           rbx
+# Inverse Nussbaumer transform, using a scratch area of 4096 bytes on the stack. This is a wrapper around
+# nussbaumer1024_inverse_r.
+nussbaumer1024_inverse:
+    push          rbp
+    mov           rbp, rsp
+    sub           rsp, 4096
+    and           rsp, -32
+    mov           rdx, rsp
+    call          nussbaumer1024_inverse_r
+    mov           rsp, rbp
+    pop           rbp
     ret
 
 
 # Inverse Nussbaumer transform. The source and destination may be the same.
 # The input coefficients must have at most 12 bits; the output will be properly reduced.
-nussbaumer1024_inverse:
+# The scratch area of 4096 bytes is given in rdx, and must be 32-byte aligned.
+nussbaumer1024_inverse_r:
     push          rbx
+    push          r12
+    mov           r12, rdx
     mov           r11, rdi
     mov           r9, rsi
 
     # Transpose the data
-    lea           rdi, [buffer]
+    lea           rdi, [r12]
     call          transpose_block_inverse
 
     lea           rsi, [r9 + 2*16]
-    lea           rdi, [buffer + 32*2*16]
+    lea           rdi, [r12 + 32*2*16]
     call          transpose_block_inverse
 
     lea           rsi, [r9 + 2*16*2]
-    lea           rdi, [buffer + 32*2*16*2]
+    lea           rdi, [r12 + 32*2*16*2]
     call          transpose_block_inverse
 
     lea           rsi, [r9 + 2*16*3]
-    lea           rdi, [buffer + 32*2*16*3]
+    lea           rdi, [r12 + 32*2*16*3]
     call          transpose_block_inverse
 
     lea           rsi, [r9 + 64*2*16]
-    lea           rdi, [buffer + 16*2]
+    lea           rdi, [r12 + 16*2]
     call          transpose_block_inverse
 
     lea           rsi, [r9 + 64*2*16 + 2*16]
-    lea           rdi, [buffer + 32*2*16 + 16*2]
+    lea           rdi, [r12 + 32*2*16 + 16*2]
     call          transpose_block_inverse
 
     lea           rsi, [r9 + 64*2*16 + 2*16*2]
-    lea           rdi, [buffer + 32*2*16*2 + 16*2]
+    lea           rdi, [r12 + 32*2*16*2 + 16*2]
     call          transpose_block_inverse
 
     lea           rsi, [r9 + 64*2*16 + 2*16*3]
-    lea           rdi, [buffer + 32*2*16*3 + 16*2]
+    lea           rdi, [r12 + 32*2*16*3 + 16*2]
     call          transpose_block_inverse
 
     #########################################################################################
@@ -376,7 +458,7 @@ nussbaumer1024_inverse:
     # j = 0, 1                                                                              #
     #########################################################################################
     # Repeat 8 blocks of 4, 2 levels of depth
-    lea           rbx, [buffer]
+    lea           rbx, [r12]
     vpxor         ymm15, ymm15, ymm15
     mov           rcx, 16
 .invblock_j0_1:
@@ -400,7 +482,7 @@ nussbaumer1024_inverse:
     # j = 2, 3                                                                              #
     # Distances 4 and 8                                                                     #
     #########################################################################################
-    lea           rbx, [buffer]
+    lea           rbx, [r12]
     lea           rsi, inverse_2_3_bf
     mov           rdx, 4                              # 4 sets of polynomials
     vmovdqa       ymm4, [positive_add]
@@ -482,7 +564,7 @@ nussbaumer1024_inverse:
     # j = 4, 5                                                                              #
     # Distances 16 and 32                                                                   #
     #########################################################################################
-    lea           rbx, [buffer]
+    lea           rbx, [r12]
     lea           rsi, inverse_4_5_bf
     mov           rcx, 16                              # 16 sets of polynomials
 .j4_5:
@@ -547,8 +629,8 @@ nussbaumer1024_inverse:
     vpsubw        ymm8, ymm8, ymm14
     vpcmpeqw      ymm14, ymm9, ymm5
     vpsubw        ymm9, ymm9, ymm14
-    vpandw        ymm8, ymm8, ymm5
-    vpandw        ymm9, ymm9, ymm5
+    vpand         ymm8, ymm8, ymm5
+    vpand         ymm9, ymm9, ymm5
 
     vpsrlw        ymm14, ymm8, 11
     vpaddw        ymm8, ymm8, ymm14
@@ -557,12 +639,12 @@ nussbaumer1024_inverse:
 
     vpsllw        ymm14, ymm8, 5
     vpsrlw        ymm8, ymm8, 6
-    vporw         ymm8, ymm8, ymm14
+    vpor          ymm8, ymm8, ymm14
     vpsllw        ymm14, ymm9, 5
     vpsrlw        ymm9, ymm9, 6
-    vporw         ymm9, ymm9, ymm14
-    vpandw        ymm8, ymm8, ymm5
-    vpandw        ymm9, ymm9, ymm5
+    vpor          ymm9, ymm9, ymm14
+    vpand         ymm8, ymm8, ymm5
+    vpand         ymm9, ymm9, ymm5
 
     vmovdqa       [rbx + 2*32*1*16], ymm8
     vmovdqa       [rbx + 2*32*1*16 + 2*16], ymm9
@@ -594,8 +676,8 @@ nussbaumer1024_inverse:
     vpsubw        ymm8, ymm8, ymm14
     vpcmpeqw      ymm14, ymm9, ymm5
     vpsubw        ymm9, ymm9, ymm14
-    vpandw        ymm8, ymm8, ymm5
-    vpandw        ymm9, ymm9, ymm5
+    vpand         ymm8, ymm8, ymm5
+    vpand         ymm9, ymm9, ymm5
 
     vpsrlw        ymm14, ymm8, 11
     vpaddw        ymm8, ymm8, ymm14
@@ -604,12 +686,12 @@ nussbaumer1024_inverse:
 
     vpsllw        ymm14, ymm8, 5
     vpsrlw        ymm8, ymm8, 6
-    vporw         ymm8, ymm8, ymm14
+    vpor          ymm8, ymm8, ymm14
     vpsllw        ymm14, ymm9, 5
     vpsrlw        ymm9, ymm9, 6
-    vporw         ymm9, ymm9, ymm14
-    vpandw        ymm8, ymm8, ymm5
-    vpandw        ymm9, ymm9, ymm5
+    vpor          ymm9, ymm9, ymm14
+    vpand         ymm8, ymm8, ymm5
+    vpand         ymm9, ymm9, ymm5
 
     vmovdqa       [rbx + 2*32*0*16], ymm8
     vmovdqa       [rbx + 2*32*0*16 + 2*16], ymm9
@@ -621,22 +703,23 @@ nussbaumer1024_inverse:
 
     # Finally, transpose the buffer into the destination
     # Perform the transform of the matrix, duplicated twice.
-    lea           rsi, [buffer]
+    lea           rsi, [r12]
     lea           rdi, [r11]
     call          transpose_block_inverse_final
 
-    lea           rsi, [buffer + 2*16]
+    lea           rsi, [r12 + 2*16]
     lea           rdi, [r11 + 2*32*16]
     call          transpose_block_inverse_final
 
-    lea           rsi, [buffer + 2*32*16]
+    lea           rsi, [r12 + 2*32*16]
     lea           rdi, [r11 + 2*16]
     call          transpose_block_inverse_final
 
-    lea           rsi, [buffer + 2*32*16 + 2*16]
+    lea           rsi, [r12 + 2*32*16 + 2*16]
     lea           rdi, [r11 + 2*32*16 + 2*16]
     call          transpose_block_inverse_final
 
+    pop           r12
     pop           rbx
     ret
 
@@ -889,6 +972,3 @@ bfly_table:
   .quad butterfly60, butterfly61, butterfly62, butterfly63
 
 
-.section .bss
-.align 32
-buffer: .space 4096
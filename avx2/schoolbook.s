@@ -1,4 +1,6 @@
 .code64
+# All code here needs AVX2; it is kept apart from the portable code (see dispatch/Dispatch.h).
+.section nussbaumer_backend, "ax", @progbits
 .global schoolbook4
 .global schoolbook4_test
 .global reduce_mask
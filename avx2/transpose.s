@@ -1,4 +1,6 @@
 .code64
+# All code here needs AVX2; it is kept apart from the portable code (see dispatch/Dispatch.h).
+.section nussbaumer_backend, "ax", @progbits
 .global transposew16x16
 .global transposew16x16_64
 
@@ -6,7 +8,13 @@
 # given in the rsi register. The output is given in the ymm0-15
 # registers, where each register indicates a row.
 # The input has 32 byte gaps between each row.
+# Five registers are spilled to the stack, so the function is reentrant.
 transposew16x16:
+    push          rbp
+    mov           rbp, rsp
+    and           rsp, -32
+    sub           rsp, 5*32
+
     # Transpose the two square matrices of the upper half of the input
     vmovdqa       ymm0, [rsi + 32*0]
     vmovdqa       ymm1, [rsi + 32*2]
@@ -44,10 +52,10 @@ transposew16x16:
     vpunpcklqdq   ymm14, ymm3, ymm7
     vpunpckhqdq   ymm15, ymm3, ymm7
 
-    vmovdqa       buffer1, ymm8
-    vmovdqa       buffer2, ymm10
-    vmovdqa       buffer3, ymm12
-    vmovdqa       buffer4, ymm14
+    vmovdqa       [rsp + 0*32], ymm8
+    vmovdqa       [rsp + 1*32], ymm10
+    vmovdqa       [rsp + 2*32], ymm12
+    vmovdqa       [rsp + 3*32], ymm14
 
     # Note that ymm8-15 contain the transposed part.
     # Do the same with the lower half, but be a bit more careful about
@@ -94,7 +102,7 @@ transposew16x16:
     # Now perform the final step, where we fix the fact we have two blocks
     # transposed separately.
     vperm2i128    ymm1, ymm8, ymm9, 0x02
-    vmovdqa       buffer5, ymm1
+    vmovdqa       [rsp + 4*32], ymm1
     vperm2i128    ymm9, ymm8, ymm9, 0x13
     vperm2i128    ymm3, ymm10, ymm11, 0x02
     vperm2i128    ymm11, ymm10, ymm11, 0x13
@@ -103,19 +111,22 @@ transposew16x16:
     vperm2i128    ymm7, ymm14, ymm15, 0x02
     vperm2i128    ymm15, ymm14, ymm15, 0x13
 
-    vmovdqa       ymm10, buffer1
+    vmovdqa       ymm10, [rsp + 0*32]
     vperm2i128    ymm8, ymm0, ymm10, 0x13
     vperm2i128    ymm0, ymm0, ymm10, 0x02
-    vmovdqa       ymm12, buffer2
+    vmovdqa       ymm12, [rsp + 1*32]
     vperm2i128    ymm10, ymm2, ymm12, 0x13
     vperm2i128    ymm2, ymm2, ymm12, 0x02
-    vmovdqa       ymm14, buffer3
+    vmovdqa       ymm14, [rsp + 2*32]
     vperm2i128    ymm12, ymm4, ymm14, 0x13
     vperm2i128    ymm4, ymm4, ymm14, 0x02
-    vmovdqa       ymm1, buffer4
+    vmovdqa       ymm1, [rsp + 3*32]
     vperm2i128    ymm14, ymm6, ymm1, 0x13
     vperm2i128    ymm6, ymm6, ymm1, 0x02
-    vmovdqa       ymm1, buffer5
+    vmovdqa       ymm1, [rsp + 4*32]
+
+    mov           rsp, rbp
+    pop           rbp
     ret
 
 
@@ -125,6 +136,11 @@ transposew16x16:
 # registers, where each register indicates a row.
 # The input has 32*3 byte gaps between each row (used for inverse transform)
 transposew16x16_64:
+    push          rbp
+    mov           rbp, rsp
+    and           rsp, -32
+    sub           rsp, 5*32
+
     # Transpose the two square matrices of the upper half of the input
     vmovdqa       ymm0, [rsi + 64*0]
     vmovdqa       ymm1, [rsi + 64*2]
@@ -162,10 +178,10 @@ transposew16x16_64:
     vpunpcklqdq   ymm14, ymm3, ymm7
     vpunpckhqdq   ymm15, ymm3, ymm7
 
-    vmovdqa       buffer1, ymm8
-    vmovdqa       buffer2, ymm10
-    vmovdqa       buffer3, ymm12
-    vmovdqa       buffer4, ymm14
+    vmovdqa       [rsp + 0*32], ymm8
+    vmovdqa       [rsp + 1*32], ymm10
+    vmovdqa       [rsp + 2*32], ymm12
+    vmovdqa       [rsp + 3*32], ymm14
 
     # Note that ymm8-15 contain the transposed part.
     # Do the same with the lower half, but be a bit more careful about
@@ -212,7 +228,7 @@ transposew16x16_64:
     # Now perform the final step, where we fix the fact we have two blocks
     # transposed separately.
     vperm2i128    ymm1, ymm8, ymm9, 0x02
-    vmovdqa       buffer5, ymm1
+    vmovdqa       [rsp + 4*32], ymm1
     vperm2i128    ymm9, ymm8, ymm9, 0x13
     vperm2i128    ymm3, ymm10, ymm11, 0x02
     vperm2i128    ymm11, ymm10, ymm11, 0x13
@@ -221,26 +237,21 @@ transposew16x16_64:
     vperm2i128    ymm7, ymm14, ymm15, 0x02
     vperm2i128    ymm15, ymm14, ymm15, 0x13
 
-    vmovdqa       ymm10, buffer1
+    vmovdqa       ymm10, [rsp + 0*32]
     vperm2i128    ymm8, ymm0, ymm10, 0x13
     vperm2i128    ymm0, ymm0, ymm10, 0x02
-    vmovdqa       ymm12, buffer2
+    vmovdqa       ymm12, [rsp + 1*32]
     vperm2i128    ymm10, ymm2, ymm12, 0x13
     vperm2i128    ymm2, ymm2, ymm12, 0x02
-    vmovdqa       ymm14, buffer3
+    vmovdqa       ymm14, [rsp + 2*32]
     vperm2i128    ymm12, ymm4, ymm14, 0x13
     vperm2i128    ymm4, ymm4, ymm14, 0x02
-    vmovdqa       ymm1, buffer4
+    vmovdqa       ymm1, [rsp + 3*32]
     vperm2i128    ymm14, ymm6, ymm1, 0x13
     vperm2i128    ymm6, ymm6, ymm1, 0x02
-    vmovdqa       ymm1, buffer5
-    ret
+    vmovdqa       ymm1, [rsp + 4*32]
 
+    mov           rsp, rbp
+    pop           rbp
+    ret
 
-.section .bss
-.align 32
-buffer1: .space 32
-buffer2: .space 32
-buffer3: .space 32
-buffer4: .space 32
-buffer5: .space 32
@@ -9,6 +9,12 @@
 #include "Karatsuba.h"
 #include "avx2/Nussbaumer.h"
 #include "avx2/Componentwise.h"
+#include "avx2/Multiply.h"
+#include "avx2/Prepared.h"
+#include "avx2/GenericModulus.h"
+#include "avx2/Intrinsics.h"
+#include "avx512/Nussbaumer.h"
+#include "dispatch/Dispatch.h"
 
 extern "C" {
 #include "newhope/avx2/poly.h"
@@ -21,6 +27,12 @@ std::uint16_t input1[1024] __attribute__((aligned(32)));
 std::uint16_t input2[1024] __attribute__((aligned(32)));
 Transformed transformed1, transformed2, result;
 
+std::uint16_t sizedInput1[4096] __attribute__((aligned(32)));
+std::uint16_t sizedInput2[4096] __attribute__((aligned(32)));
+std::uint16_t sizedResult[4096] __attribute__((aligned(32)));
+NussbaumerPreparedOperand prepared;
+NussbaumerScratch scratch;
+
 unsigned long long getMedian(std::vector<unsigned long long> timeDiff) {
   std::sort(timeDiff.begin(), timeDiff.end());
   std::size_t numEntries = timeDiff.size();
@@ -64,6 +76,13 @@ int main() {
   nussbaumer1024_forward(transformed2, input2);
   printResults("Nussbaumer forward transform", timing, NumTests);
 
+  // The same, with the preparation done while transposing
+  for(i = 0; i < NumTests + 1; ++i) {
+    timing[i] = cpucycles();
+    nussbaumer1024_forward_prepare_r(transformed1, input1, scratch);
+  }
+  printResults("Nussbaumer forward transform, prepared in one pass", timing, NumTests);
+
   // Run the Nussbaumer inverse transform timing tests
   for(i = 0; i < NumTests + 1; ++i) {
     timing[i] = cpucycles();
@@ -71,6 +90,22 @@ int main() {
   }
   printResults("Nussbaumer inverse transform", timing, NumTests);
 
+  // Run the same transform timing tests for the AVX-512 variants, if supported
+  if(nussbaumer1024_avx512_supported()) {
+    for(i = 0; i < NumTests + 1; ++i) {
+      timing[i] = cpucycles();
+      nussbaumer1024_forward_avx512(transformed1, input1);
+      componentwise32_64_prepare(transformed1);
+    }
+    printResults("Nussbaumer forward transform (AVX-512)", timing, NumTests);
+
+    for(i = 0; i < NumTests + 1; ++i) {
+      timing[i] = cpucycles();
+      nussbaumer1024_inverse_avx512(transformed1, transformed1);
+    }
+    printResults("Nussbaumer inverse transform (AVX-512)", timing, NumTests);
+  }
+
   // Run the componentwise core
   componentwise32_64_prepare(transformed2);
   for(i = 0; i < NumTests + 1; ++i) {
@@ -79,6 +114,120 @@ int main() {
   }
   printResults("Pointwise multiplication", timing, NumTests);
 
+  // Run the full multiplication, one pair at a time
+  for(i = 0; i < NumTests + 1; ++i) {
+    timing[i] = cpucycles();
+    nussbaumer1024_forward(transformed1, input1);
+    nussbaumer1024_forward(transformed2, input2);
+    componentwise32_64_prepare(transformed1);
+    componentwise32_64_prepare(transformed2);
+    componentwise32_64_run(result, transformed1, transformed2);
+    nussbaumer1024_inverse(result, result);
+  }
+  printResults("Nussbaumer multiplication", timing, NumTests);
+
+  // Run the fused multiplication
+  for(i = 0; i < NumTests + 1; ++i) {
+    timing[i] = cpucycles();
+    nussbaumer1024_multiply(result, input1, input2);
+  }
+  printResults("Nussbaumer fused multiplication", timing, NumTests);
+
+  // Run the multiplication with a prepared operand
+  nussbaumer1024_prepare_operand(&prepared, input1);
+  for(i = 0; i < NumTests + 1; ++i) {
+    timing[i] = cpucycles();
+    nussbaumer1024_multiply_prepared(result, &prepared, input2);
+  }
+  printResults("Nussbaumer multiplication with prepared operand", timing, NumTests);
+
+  // Run the same stages with the intrinsics kernels, to compare them to the assembly above
+  for(i = 0; i < NumTests + 1; ++i) {
+    timing[i] = cpucycles();
+    nussbaumer1024_forward_intrinsics(transformed1, input1);
+    componentwise32_64_prepare_intrinsics(transformed1);
+  }
+  printResults("Nussbaumer forward transform (intrinsics)", timing, NumTests);
+
+  nussbaumer1024_forward_intrinsics(transformed2, input2);
+  componentwise32_64_prepare_intrinsics(transformed2);
+  for(i = 0; i < NumTests + 1; ++i) {
+    timing[i] = cpucycles();
+    componentwise32_64_run_intrinsics(result, transformed1, transformed2);
+  }
+  printResults("Pointwise multiplication (intrinsics)", timing, NumTests);
+
+  for(i = 0; i < NumTests + 1; ++i) {
+    timing[i] = cpucycles();
+    nussbaumer1024_inverse_intrinsics(transformed1, transformed1);
+  }
+  printResults("Nussbaumer inverse transform (intrinsics)", timing, NumTests);
+
+  for(i = 0; i < NumTests + 1; ++i) {
+    timing[i] = cpucycles();
+    nussbaumer1024_multiply_intrinsics(result, input1, input2);
+  }
+  printResults("Nussbaumer fused multiplication (intrinsics)", timing, NumTests);
+
+  // Run the transforms and the multiplication modulo other q, using the generic-modulus kernels
+  for(std::uint16_t q : {2047, 12289, 1024}) {
+    NussbaumerModulus modulus;
+    nussbaumer_modulus_init(modulus, q);
+    std::string suffix = " modulo " + std::to_string(q) + " (generic modulus)";
+
+    for(i = 0; i < NumTests + 1; ++i) {
+      timing[i] = cpucycles();
+      nussbaumer1024_forward_mod(transformed1, input1, modulus);
+    }
+    printResults("Nussbaumer forward transform" + suffix, timing, NumTests);
+
+    nussbaumer1024_forward_mod(transformed2, input2, modulus);
+    componentwise32_64_prepare_mod(transformed1, modulus);
+    componentwise32_64_prepare_mod(transformed2, modulus);
+    for(i = 0; i < NumTests + 1; ++i) {
+      timing[i] = cpucycles();
+      componentwise32_64_run_mod(result, transformed1, transformed2, modulus);
+    }
+    printResults("Pointwise multiplication" + suffix, timing, NumTests);
+
+    for(i = 0; i < NumTests + 1; ++i) {
+      timing[i] = cpucycles();
+      nussbaumer1024_inverse_mod(result, result, modulus);
+    }
+    printResults("Nussbaumer inverse transform" + suffix, timing, NumTests);
+
+    for(i = 0; i < NumTests + 1; ++i) {
+      timing[i] = cpucycles();
+      nussbaumer1024_multiply_mod(result, input1, input2, modulus);
+    }
+    printResults("Nussbaumer multiplication" + suffix, timing, NumTests);
+  }
+
+  // Run the multiplication modulo 12289 at each ring dimension the generic-modulus kernels support
+  for(i = 0; i < 4096; ++i) {
+    sizedInput1[i] = i % 12289;
+    sizedInput2[i] = (3*i) % 12289;
+  }
+  for(std::size_t n = 256; n <= 4096; n *= 2) {
+    NussbaumerModulus modulus;
+    nussbaumer_modulus_init(modulus, 12289);
+    for(i = 0; i < NumTests + 1; ++i) {
+      timing[i] = cpucycles();
+      nussbaumer_multiply_mod(n, sizedResult, sizedInput1, sizedInput2, modulus);
+    }
+    printResults("Nussbaumer multiplication modulo 12289, n = " + std::to_string(n) + " (generic modulus)", timing,
+                 NumTests);
+  }
+
+  // Run the full multiplication of each backend the processor supports
+  for(const NussbaumerBackend* backend : nussbaumer1024_supported_backends()) {
+    for(i = 0; i < NumTests + 1; ++i) {
+      timing[i] = cpucycles();
+      backend->multiply(result, input1, input2);
+    }
+    printResults(std::string("Nussbaumer multiplication, ") + backend->name + " backend", timing, NumTests);
+  }
+
   // Run the NTT forward transform timing tests
   for(i = 0; i < NumTests + 1; ++i) {
     timing[i] = cpucycles();
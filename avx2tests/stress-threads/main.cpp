@@ -0,0 +1,120 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+
+#include "Polynomial.h"
+#include "RingModElt.h"
+#include "NegaConvo.h"
+#include "avx2/Nussbaumer.h"
+#include "avx2/Componentwise.h"
+
+constexpr std::size_t N = 1024;
+constexpr std::size_t Modulo = 2047;
+static const std::size_t NumInputs = 16;
+static const std::size_t NumRounds = 2000;
+
+typedef RingModElt<Modulo> RingType;
+
+/**
+ * An input pair, with the result as calculated by the naive method.
+ */
+struct TestCase {
+  std::uint16_t input1[N] __attribute__((aligned(32)));
+  std::uint16_t input2[N] __attribute__((aligned(32)));
+  std::uint16_t expected[N];
+};
+
+// Static, since std::vector does not respect the alignment of the inputs.
+static TestCase testCases[NumInputs];
+static std::atomic<std::size_t> numFailures(0);
+
+/**
+ * Repeatedly multiply the test cases, alternating between the entry points with explicit
+ * scratch memory and the ones using the stack.
+ * @param[in] threadId   The index of this thread, used to pick a different order of inputs.
+ */
+void runThread(std::size_t threadId) {
+  static thread_local Transformed transformed1, transformed2, transformed3;
+  static thread_local TransformedResult result;
+  static thread_local NussbaumerScratch scratch;
+  static thread_local ComponentwiseWorkspace workspace;
+
+  for(std::size_t round = 0; round < NumRounds; ++round) {
+    TestCase& test = testCases[(round + threadId) % NumInputs];
+    bool useScratch = (round & 1) == 0;
+
+    if(useScratch) {
+      nussbaumer1024_forward_r(transformed1, test.input1, scratch);
+      nussbaumer1024_forward_r(transformed2, test.input2, scratch);
+    }
+    else {
+      nussbaumer1024_forward(transformed1, test.input1);
+      nussbaumer1024_forward(transformed2, test.input2);
+    }
+
+    componentwise32_64_prepare(transformed1);
+    componentwise32_64_prepare(transformed2);
+
+    if(useScratch) {
+      // Also verify the result may overwrite the first input.
+      componentwise32_64_run_r(transformed1, transformed1, transformed2, workspace);
+      nussbaumer1024_inverse_r(result, transformed1, scratch);
+    }
+    else {
+      componentwise32_64_run(transformed3, transformed1, transformed2);
+      nussbaumer1024_inverse(result, transformed3);
+    }
+
+    for(std::size_t i = 0; i < N; ++i) {
+      if(result[i] != test.expected[i]) {
+        std::cout << "Thread " << threadId << " failed in round " << round << " at position " << i << std::endl;
+        ++numFailures;
+        break;
+      }
+    }
+  }
+}
+
+int main() {
+  srand(static_cast<unsigned>(time(NULL)));
+
+  // Calculate the expected results up front; the operation counting in RingModElt is not thread-safe.
+  const int modulo = static_cast<int>(Modulo);
+  for(auto& test : testCases) {
+    Polynomial<RingType> pol1(N), pol2(N);
+    for(std::size_t i = 0; i < N; ++i) {
+      test.input1[i] = rand() & ((1 << 11) - 1);
+      test.input2[i] = rand() & ((1 << 11) - 1);
+      pol1[i] = test.input1[i];
+      pol2[i] = test.input2[i];
+    }
+
+    auto realResult = naivemult_negacyclic(N, pol1, pol2);
+    for(std::size_t i = 0; i < N; ++i)
+      test.expected[i] = ((realResult[i].toInt() % modulo) + modulo) % modulo;
+  }
+
+  std::size_t numThreads = std::max(2u, std::thread::hardware_concurrency());
+  std::vector<std::thread> threads;
+  for(std::size_t i = 0; i < numThreads; ++i)
+    threads.emplace_back(runThread, i);
+  for(auto& thread : threads)
+    thread.join();
+
+  if(componentwise32_64_workspace_size() != sizeof(ComponentwiseWorkspace)) {
+    std::cout << "TEST FAILED: workspace size mismatch" << std::endl;
+    return 1;
+  }
+
+  if(numFailures != 0) {
+    std::cout << "TEST FAILED: " << numFailures << " failures over " << numThreads << " threads" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+
+#include "Polynomial.h"
+#include "RingModElt.h"
+#include "NegaConvo.h"
+#include "dispatch/Dispatch.h"
+
+constexpr std::size_t N = 1024;
+constexpr int Modulo = 2047;
+static const std::size_t NumTests = 200;
+
+typedef RingModElt<Modulo> RingType;
+static std::uint16_t data[N] __attribute__((aligned(32)));
+static std::uint16_t data2[N] __attribute__((aligned(32)));
+static std::uint16_t result[N] __attribute__((aligned(32)));
+static Transformed transformed, transformed2, transformed3;
+static TransformedResult stagedResult;
+static std::size_t numFailures = 0;
+
+/**
+ * Multiply random polynomials through both the staged and the single-call functions of a
+ * backend, and compare them to the naive multiplication.
+ * @param[in] backend    The backend to test.
+ */
+void runTest(const NussbaumerBackend& backend) {
+  Polynomial<RingType> pol1(N), pol2(N);
+  for(std::size_t i = 0; i < N; ++i) {
+    data[i] = rand() & ((1 << 11) - 1);
+    data2[i] = rand() & ((1 << 11) - 1);
+    pol1[i] = data[i];
+    pol2[i] = data2[i];
+  }
+
+  backend.forward(transformed, data);
+  backend.forward(transformed2, data2);
+  backend.prepare(transformed);
+  backend.prepare(transformed2);
+  backend.run(transformed3, transformed, transformed2);
+  backend.inverse(stagedResult, transformed3);
+
+  backend.multiply(result, data, data2);
+
+  auto realResult = naivemult_negacyclic(N, pol1, pol2);
+  for(std::size_t i = 0; i < N; ++i) {
+    int expected = ((realResult[i].toInt() % Modulo) + Modulo) % Modulo;
+    if(stagedResult[i] != expected || result[i] != expected) {
+      std::cout << "Backend " << backend.name << " failed at position " << i << std::endl;
+      ++numFailures;
+      return;
+    }
+  }
+}
+
+int main() {
+  srand(static_cast<unsigned>(time(NULL)));
+
+  auto backends = nussbaumer1024_supported_backends();
+  if(backends.empty() || backends.front() != &nussbaumerGenericBackend) {
+    std::cout << "TEST FAILED: the generic backend is not supported" << std::endl;
+    return 1;
+  }
+  if(&nussbaumer1024_backend() != backends.back()) {
+    std::cout << "TEST FAILED: the selected backend is not the fastest one" << std::endl;
+    return 1;
+  }
+
+  for(auto backend : backends) {
+    for(std::size_t i = 0; i < NumTests; ++i)
+      runTest(*backend);
+  }
+
+  if(numFailures != 0) {
+    std::cout << "TEST FAILED: " << numFailures << " failures" << std::endl;
+    return 1;
+  }
+  return 0;
+}
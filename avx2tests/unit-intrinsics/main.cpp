@@ -0,0 +1,120 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+
+#include "avx2/Componentwise.h"
+#include "avx2/Intrinsics.h"
+#include "avx2/Multiply.h"
+#include "avx2/Nussbaumer.h"
+#include "avx2/Schoolbook.h"
+
+constexpr std::size_t N = 1024;
+static const std::size_t NumTests = 1000;
+
+static std::uint16_t data[N] __attribute__((aligned(32)));
+static std::uint16_t data2[N] __attribute__((aligned(32)));
+static std::uint16_t result[N] __attribute__((aligned(32)));
+static std::uint16_t asmResult[N] __attribute__((aligned(32)));
+static std::uint16_t block[128] __attribute__((aligned(32)));
+static std::uint16_t asmBlock[128] __attribute__((aligned(32)));
+static Transformed transformed, transformed2, asmTransformed, asmTransformed2;
+static std::size_t numFailures = 0;
+
+/**
+ * Compare the output of an intrinsics kernel to that of the assembly, word for word.
+ * @param[in] name       The kernel, for reporting.
+ * @param[in] values     The output of the intrinsics.
+ * @param[in] expected   The output of the assembly.
+ * @param[in] size       The number of words to compare.
+ * @return    Whether they are equal.
+ */
+bool compare(const char* name, const std::uint16_t* values, const std::uint16_t* expected, std::size_t size) {
+  for(std::size_t i = 0; i < size; ++i) {
+    if(values[i] != expected[i]) {
+      std::cout << name << " differs from the assembly at position " << i << ": " << values[i]
+                << " != " << expected[i] << std::endl;
+      ++numFailures;
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Run every stage on data and data2 through both implementations. Each stage gets the output of
+ * the previous assembly stage as input, so a difference is reported where it appears.
+ */
+void runTestOn() {
+  nussbaumer1024_forward_intrinsics(transformed, data);
+  nussbaumer1024_forward_intrinsics(transformed2, data2);
+  nussbaumer1024_forward(asmTransformed, data);
+  nussbaumer1024_forward(asmTransformed2, data2);
+  if(!compare("Forward transform", transformed, asmTransformed, 2048) ||
+     !compare("Forward transform", transformed2, asmTransformed2, 2048))
+    return;
+
+  componentwise32_64_prepare_intrinsics(transformed);
+  componentwise32_64_prepare_intrinsics(transformed2);
+  componentwise32_64_prepare(asmTransformed);
+  componentwise32_64_prepare(asmTransformed2);
+  if(!compare("Prepare", transformed, asmTransformed, 6912) ||
+     !compare("Prepare", transformed2, asmTransformed2, 6912))
+    return;
+
+  componentwise32_64_run_intrinsics(transformed, transformed, transformed2);
+  componentwise32_64_run(asmTransformed, asmTransformed, asmTransformed2);
+  if(!compare("Componentwise multiplication", transformed, asmTransformed, 2048))
+    return;
+
+  nussbaumer1024_inverse_intrinsics(transformed, asmTransformed);
+  nussbaumer1024_inverse(asmTransformed, asmTransformed);
+  if(!compare("Inverse transform", transformed, asmTransformed, N))
+    return;
+
+  nussbaumer1024_multiply_intrinsics(result, data, data2);
+  nussbaumer1024_multiply(asmResult, data, data2);
+  compare("Multiplication", result, asmResult, N);
+}
+
+/**
+ * Compare schoolbook4 on the input in block.
+ */
+void runSchoolbookTestOn() {
+  for(std::size_t i = 0; i < 128; ++i)
+    asmBlock[i] = block[i];
+  schoolbook4_test_intrinsics(block);
+  schoolbook4_test(asmBlock);
+  compare("schoolbook4", block, asmBlock, 7*16);
+}
+
+int main() {
+  srand(static_cast<unsigned>(time(NULL)));
+
+  for(std::size_t test = 0; test < NumTests; ++test) {
+    for(std::size_t i = 0; i < N; ++i) {
+      data[i] = rand() % 2048;
+      data2[i] = rand() % 2048;
+    }
+    runTestOn();
+  }
+  for(std::size_t i = 0; i < N; ++i)
+    data[i] = data2[i] = 2047;
+  runTestOn();
+
+  // schoolbook4 takes inputs of up to 15 bits, as after prepare.
+  for(std::size_t test = 0; test < NumTests; ++test) {
+    for(std::size_t i = 0; i < 128; ++i)
+      block[i] = rand() % 32768;
+    runSchoolbookTestOn();
+  }
+  for(std::size_t i = 0; i < 128; ++i)
+    block[i] = 32767;
+  runSchoolbookTestOn();
+
+  if(numFailures != 0) {
+    std::cout << "TEST FAILED: " << numFailures << " failures" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,172 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+
+#include "Polynomial.h"
+#include "RingModElt.h"
+#include "NegaConvo.h"
+#include "avx2/GenericModulus.h"
+#include "avx2/Multiply.h"
+
+constexpr std::size_t N = 1024;
+constexpr std::size_t MaxN = 4096;
+static const std::size_t NumTests = 50;
+static const std::size_t Sizes[] = {256, 512, 1024, 2048, 4096};
+
+static std::uint16_t data[MaxN] __attribute__((aligned(32)));
+static std::uint16_t data2[MaxN] __attribute__((aligned(32)));
+static std::uint16_t result[MaxN] __attribute__((aligned(32)));
+static std::uint16_t stagedResult[MaxN] __attribute__((aligned(32)));
+static std::uint16_t asmResult[N] __attribute__((aligned(32)));
+static std::uint16_t transformed[NussbaumerTransformedWords4096] __attribute__((aligned(32)));
+static std::uint16_t transformed2[NussbaumerTransformedWords4096] __attribute__((aligned(32)));
+static std::uint16_t transformed3[NussbaumerTransformedWords4096] __attribute__((aligned(32)));
+static std::size_t numFailures = 0;
+
+/**
+ * Multiply the polynomials in data and data2 through both the staged and the single-call
+ * functions, and compare them to the naive multiplication.
+ * @param[in] n          The ring dimension.
+ * @param[in] modulus    The modulus to test.
+ * @param[in] name       Description of the input, for reporting.
+ */
+template<int Modulo>
+void runTestOn(std::size_t n, const NussbaumerModulus& modulus, const char* name) {
+  Polynomial<RingModElt<Modulo>> pol1(n), pol2(n);
+  for(std::size_t i = 0; i < n; ++i) {
+    pol1[i] = data[i];
+    pol2[i] = data2[i];
+  }
+
+  nussbaumer_forward_mod(n, transformed, data, modulus);
+  nussbaumer_forward_mod(n, transformed2, data2, modulus);
+  componentwise_prepare_mod(n, transformed, modulus);
+  componentwise_prepare_mod(n, transformed2, modulus);
+  componentwise_run_mod(n, transformed3, transformed, transformed2, modulus);
+  nussbaumer_inverse_mod(n, stagedResult, transformed3, modulus);
+
+  if(n == N)
+    nussbaumer1024_multiply_mod(result, data, data2, modulus);
+  else
+    nussbaumer_multiply_mod(n, result, data, data2, modulus);
+
+  auto realResult = naivemult_negacyclic(n, pol1, pol2);
+  for(std::size_t i = 0; i < n; ++i) {
+    int expected = ((realResult[i].toInt() % Modulo) + Modulo) % Modulo;
+    if(stagedResult[i] != expected || result[i] != expected) {
+      std::cout << "Modulus " << Modulo << " failed for n = " << n << " on " << name
+                << " input at position " << i << std::endl;
+      ++numFailures;
+      return;
+    }
+  }
+}
+
+/**
+ * Run the tests for one modulus at every supported size: random inputs, and all coefficients
+ * equal to q - 1. The naive multiplication is quadratic, so the larger sizes get fewer tests.
+ */
+template<int Modulo>
+void runTests() {
+  NussbaumerModulus modulus;
+  if(!nussbaumer_modulus_init(modulus, Modulo)) {
+    std::cout << "Modulus " << Modulo << " is not supported" << std::endl;
+    ++numFailures;
+    return;
+  }
+
+  for(std::size_t n : Sizes) {
+    if(!nussbaumer_size_supported(n, modulus))
+      continue;
+
+    for(std::size_t test = 0; test < NumTests*N/n/4 + 1; ++test) {
+      for(std::size_t i = 0; i < n; ++i) {
+        data[i] = rand() % Modulo;
+        data2[i] = rand() % Modulo;
+      }
+      runTestOn<Modulo>(n, modulus, "random");
+    }
+
+    for(std::size_t i = 0; i < n; ++i)
+      data[i] = data2[i] = Modulo - 1;
+    runTestOn<Modulo>(n, modulus, "maximum");
+  }
+}
+
+/**
+ * Check which sizes a power-of-two modulus supports: q*2m must not exceed 2^16.
+ */
+void runSizeChecks() {
+  NussbaumerModulus modulus;
+  nussbaumer_modulus_init(modulus, 2048);
+  bool expected[] = {true, true, false, false, false};
+  for(std::size_t i = 0; i < 5; ++i) {
+    if(nussbaumer_size_supported(Sizes[i], modulus) != expected[i]) {
+      std::cout << "Wrong size support for modulus 2048 and n = " << Sizes[i] << std::endl;
+      ++numFailures;
+    }
+  }
+
+  nussbaumer_modulus_init(modulus, 12289);
+  if(!nussbaumer_size_supported(4096, modulus) || nussbaumer_size_supported(768, modulus)) {
+    std::cout << "Wrong size support for modulus 12289" << std::endl;
+    ++numFailures;
+  }
+}
+
+/**
+ * Check that the results modulo 2047 agree with the assembly implementation.
+ */
+void runAsmComparison() {
+  NussbaumerModulus modulus;
+  nussbaumer_modulus_init(modulus, 2047);
+  for(std::size_t test = 0; test < NumTests; ++test) {
+    for(std::size_t i = 0; i < N; ++i) {
+      data[i] = rand() % 2047;
+      data2[i] = rand() % 2047;
+    }
+    nussbaumer1024_multiply_mod(result, data, data2, modulus);
+    nussbaumer1024_multiply(asmResult, data, data2);
+    for(std::size_t i = 0; i < N; ++i) {
+      if(result[i] != asmResult[i]) {
+        std::cout << "Modulus 2047 differs from the assembly at position " << i << std::endl;
+        ++numFailures;
+        break;
+      }
+    }
+  }
+}
+
+int main() {
+  srand(static_cast<unsigned>(time(NULL)));
+
+  // New Hope's q, other NTT-friendly primes, 2047 itself and the bounds of the supported ranges.
+  runTests<12289>();
+  runTests<7681>();
+  runTests<3329>();
+  runTests<2047>();
+  runTests<16381>();
+  runTests<17>();
+  runTests<1024>();
+  runTests<256>();
+  runTests<2048>();
+  runTests<512>();
+  runTests<2>();
+  runAsmComparison();
+  runSizeChecks();
+
+  NussbaumerModulus modulus;
+  for(std::uint16_t q : {0, 1, 15, 3000, 4096, 16385}) {
+    if(nussbaumer_modulus_init(modulus, q)) {
+      std::cout << "Modulus " << q << " should not be supported" << std::endl;
+      ++numFailures;
+    }
+  }
+
+  if(numFailures != 0) {
+    std::cout << "TEST FAILED: " << numFailures << " failures" << std::endl;
+    return 1;
+  }
+  return 0;
+}
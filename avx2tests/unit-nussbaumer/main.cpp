@@ -12,6 +12,9 @@
 #include "NegaConvo.h"
 #include "avx2/Nussbaumer.h"
 #include "avx2/Componentwise.h"
+#include "avx2/Multiply.h"
+#include "avx2/Prepared.h"
+#include "avx512/Nussbaumer.h"
 
 constexpr std::size_t N = 1024;
 constexpr std::size_t Modulo = 2047;
@@ -22,14 +25,28 @@ static std::uint16_t data[2*N] __attribute__((aligned(32)));
 static std::uint16_t data2[2*N] __attribute__((aligned(32)));
 static Transformed transformed, transformed2, transformed3;
 static TransformedResult result;
-
-void runTransformTestOn(std::uint16_t* data) {
+static std::uint16_t fusedResult[N] __attribute__((aligned(32)));
+static std::uint16_t preparedResult[N] __attribute__((aligned(32)));
+static NussbaumerPreparedOperand prepared, restored;
+static NussbaumerScratch scratch;
+static std::uint8_t serialized[NussbaumerPreparedSerializedSize];
+
+/**
+ * An implementation of the transforms to test.
+ */
+struct Backend {
+  std::string name;
+  NussbaumerForwardFunction forward;
+  NussbaumerInverseFunction inverse;
+};
+
+void runTransformTestOn(std::uint16_t* data, const Backend& backend) {
   Polynomial<RingType> input(N);
   for(std::size_t i = 0; i < N; ++i)
     input[i] = data[i];
 
   // Run the forward Nussbaumer transform
-  nussbaumer1024_forward(transformed, data);
+  backend.forward(transformed, data);
 
   // Verify the output; ignore the first line (it is irrelevant)
   NegaNussbaumer<RingType> nb(N);
@@ -38,21 +55,21 @@ void runTransformTestOn(std::uint16_t* data) {
     for(std::size_t j = 0; j < output[i].getSize() /* = 32 */; ++j) {
       // Note: the output is translated
       if(RingType(transformed[i + j*output.size()]) != output[i][j]) {
-        std::cout << "Transform failed at (" << j << ", " << i <<  ") for: " << input << std::endl;
+        std::cout << backend.name << " transform failed at (" << j << ", " << i <<  ") for: " << input << std::endl;
         return;
       }
 
       // Confirm the constraints
       std::uint16_t value = transformed[i + j*output.size()];
       if(value >= (1 << 14)) {
-        std::cout << "Transform has too many bits set at (" << j << ", " << i <<  ") for: " << input << std::endl;
+        std::cout << backend.name << " transform has too many bits set at (" << j << ", " << i <<  ") for: " << input << std::endl;
         return;
       }
     }
   }
 }
 
-void runInverseTransformTestOn(std::uint16_t* transformed) {
+void runInverseTransformTestOn(std::uint16_t* transformed, const Backend& backend) {
   // Translate the input to the format used for the inverse transform
   std::vector<Polynomial<RingType>> input;
   for(std::size_t col = 0; col < 64; ++col) {
@@ -65,7 +82,7 @@ void runInverseTransformTestOn(std::uint16_t* transformed) {
   }
 
 
-  nussbaumer1024_inverse(transformed, transformed);
+  backend.inverse(transformed, transformed);
 
   NegaNussbaumer<RingType> nb(N);
   auto expectedResult = nb.inverseTransform(input);
@@ -74,84 +91,155 @@ void runInverseTransformTestOn(std::uint16_t* transformed) {
   for(std::size_t row = 0; row < 32; ++row) {
     for(std::size_t col = 0; col < 32; ++col) {
       if((transformed[row*32 + col] - expectedResult[row*32 + col].toInt()) % 2047)
-        std::cout << "Inverse transform has invalid result at " << row << ", " << col << std::endl;
+        std::cout << backend.name << " inverse transform has invalid result at " << row << ", " << col << std::endl;
       if(transformed[row*32 + col] >= 2047)
-        std::cout << "Inverse transform not properly normalized " << row << ", " << col << std::endl;
+        std::cout << backend.name << " inverse transform not properly normalized " << row << ", " << col << std::endl;
     }
   }
 }
 
 
-void runFullTestOn(std::uint16_t* data, std::uint16_t* data2) {
+void runFullTestOn(std::uint16_t* data, std::uint16_t* data2, const Backend& backend) {
   Polynomial<RingType> pol1(1024), pol2(1024);
   for(std::size_t i = 0; i < 1024; ++i) {
     pol1[i] = data[i];
     pol2[i] = data2[i];
   }
 
-  // Perform the multiplication through the AVX2 method
-  nussbaumer1024_forward(transformed, data);
-  nussbaumer1024_forward(transformed2, data2);
+  // Perform the multiplication through the transforms of the backend
+  backend.forward(transformed, data);
+  backend.forward(transformed2, data2);
   componentwise32_64_prepare(transformed);
   componentwise32_64_prepare(transformed2);
   componentwise32_64_run(transformed3, transformed, transformed2);
-  nussbaumer1024_inverse(result, transformed3);
+  backend.inverse(result, transformed3);
+
+  // Perform the multiplication through the fused entry point
+  nussbaumer1024_multiply(fusedResult, data, data2);
+
+  // Perform the multiplication with a prepared operand, sent through serialization
+  nussbaumer1024_prepare_operand(&prepared, data);
+  nussbaumer1024_serialize_prepared(serialized, prepared);
+  if(!nussbaumer1024_deserialize_prepared(restored, serialized, sizeof(serialized)))
+    std::cout << "Prepared operand could not be deserialized" << std::endl;
+  nussbaumer1024_multiply_prepared(preparedResult, &restored, data2);
 
   // Perform the multiplication through the naive method
   auto realResult = naivemult_negacyclic(1024, pol1, pol2);
   for(std::size_t i = 0; i < 1024; ++i) {
     if((realResult[i].toInt() - result[i]) % 2047)
-      std::cout << "Nussbaumer AVX2 test failed at position " << i << std::endl;
+      std::cout << "Nussbaumer " << backend.name << " test failed at position " << i << std::endl;
     if(result[i] >= 2047)
-      std::cout << "Nussbaumer AVX2 result has too high value at position " << i << std::endl;
+      std::cout << "Nussbaumer " << backend.name << " result has too high value at position " << i << std::endl;
+    if(fusedResult[i] != result[i])
+      std::cout << "Fused Nussbaumer AVX2 multiplication differs at position " << i << std::endl;
+    if(preparedResult[i] != result[i])
+      std::cout << "Nussbaumer AVX2 multiplication with prepared operand differs at position " << i << std::endl;
+  }
+
+  // Corrupted data must be rejected
+  if(nussbaumer1024_deserialize_prepared(restored, serialized, sizeof(serialized) - 1))
+    std::cout << "Prepared operand of the wrong length was accepted" << std::endl;
+  serialized[0] ^= 1;
+  if(nussbaumer1024_deserialize_prepared(restored, serialized, sizeof(serialized)))
+    std::cout << "Prepared operand with an invalid header was accepted" << std::endl;
+  serialized[0] ^= 1;
+
+  // A transformed coefficient of 15 bits, for which the derived sums would overflow
+  std::uint8_t saved = serialized[9];
+  serialized[9] = 0x40;
+  if(nussbaumer1024_deserialize_prepared(restored, serialized, sizeof(serialized)))
+    std::cout << "Prepared operand with an out of range coefficient was accepted" << std::endl;
+  serialized[9] = saved;
+
+  // And the last one, so that every serialized coefficient is checked
+  saved = serialized[NussbaumerPreparedSerializedSize - 1];
+  serialized[NussbaumerPreparedSerializedSize - 1] = 0x40;
+  if(nussbaumer1024_deserialize_prepared(restored, serialized, sizeof(serialized)))
+    std::cout << "Prepared operand with an out of range last coefficient was accepted" << std::endl;
+  serialized[NussbaumerPreparedSerializedSize - 1] = saved;
+}
+
+
+void runForwardPrepareTestOn(std::uint16_t* data) {
+  // The transform with the preparation fused must give the same words as the two passes
+  nussbaumer1024_forward(transformed, data);
+  componentwise32_64_prepare(transformed);
+  nussbaumer1024_forward_prepare_r(transformed2, data, scratch);
+  for(std::size_t i = 0; i < sizeof(Transformed) / sizeof(std::uint16_t); ++i) {
+    if(transformed[i] != transformed2[i]) {
+      std::cout << "Fused forward transform and preparation differs at position " << i << std::endl;
+      break;
+    }
   }
 }
 
 
-void runTransformTest() {
+void runTransformTest(const Backend& backend) {
   // Create a bunch of random data to test on
   for(std::size_t i = 0; i < N; ++i)
     data[i] = rand() & ((1 << 11) - 1);
 
-  runTransformTestOn(data);
+  runTransformTestOn(data, backend);
 }
 
 
-void runInverseTransformTest() {
+void runInverseTransformTest(const Backend& backend) {
   // Create a bunch of random data to test on
   for(std::size_t i = 0; i < 2*N; ++i)
     data[i] = rand() & ((1 << 12) - 1);
 
-  runInverseTransformTestOn(data);
+  runInverseTransformTestOn(data, backend);
 }
 
 
-void runFullTest() {
+void runFullTest(const Backend& backend) {
   for(std::size_t i = 0; i < N; ++i) {
     data[i] = rand() & ((1 << 11) - 1);
     data2[i] = rand() & ((1 << 11) - 1);
   }
 
-  runFullTestOn(data, data2);
+  runFullTestOn(data, data2, backend);
+}
+
+
+void runForwardPrepareTest() {
+  for(std::size_t i = 0; i < N; ++i)
+    data[i] = rand() & ((1 << 11) - 1);
+
+  runForwardPrepareTestOn(data);
 }
 
 int main() {
   srand(static_cast<unsigned>(time(NULL)));
 
-  // Run forward tests
-  for(std::size_t i = 0; i < NumTests; ++i)
-    runTransformTest();
-  for(std::size_t i = 0; i < NumTests; ++i)
-    runInverseTransformTest();
-  for(std::size_t i = 0; i < NumTests; ++i)
-    runFullTest();
+  // The AVX-512 transforms are only tested if the processor supports them.
+  std::vector<Backend> backends = { { "AVX2", nussbaumer1024_forward, nussbaumer1024_inverse } };
+  if(nussbaumer1024_avx512_supported())
+    backends.push_back({ "AVX-512", nussbaumer1024_forward_avx512, nussbaumer1024_inverse_avx512 });
+
+  for(const auto& backend : backends) {
+    // Run forward tests
+    for(std::size_t i = 0; i < NumTests; ++i)
+      runTransformTest(backend);
+    for(std::size_t i = 0; i < NumTests; ++i)
+      runInverseTransformTest(backend);
+    for(std::size_t i = 0; i < NumTests; ++i)
+      runFullTest(backend);
+
+    // Run an extra test on the maximum numbers as input, as an extra test for overflows.
+    for(std::size_t i = 0; i < N; ++i)
+      data[i] = 2046;
+    runTransformTestOn(data, backend);
+
+    for(std::size_t i = 0; i < 2*N; ++i)
+      transformed[i] = (1 << 12) - 1;
+    runInverseTransformTestOn(transformed, backend);
+  }
 
-  // Run an extra test on the maximum numbers as input, as an extra test for overflows.
+  for(std::size_t i = 0; i < NumTests; ++i)
+    runForwardPrepareTest();
   for(std::size_t i = 0; i < N; ++i)
     data[i] = 2046;
-  runTransformTestOn(data);
-
-  for(std::size_t i = 0; i < 2*N; ++i)
-    transformed[i] = (1 << 12) - 1;
-  runInverseTransformTestOn(transformed);
+  runForwardPrepareTestOn(data);
 }
@@ -0,0 +1,451 @@
+#include <cstddef>
+#include <cstdint>
+
+// GCC 12 warns about the deliberately undefined upper lanes in some of the AVX-512 intrinsics.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+
+#include "avx2/Componentwise.h"
+#include "avx512/Nussbaumer.h"
+
+// This file is built without -march, so only the functions using AVX-512 are compiled for it;
+// they are only called after checking nussbaumer1024_avx512_supported(). They are placed in the
+// backend section, apart from the portable code (see dispatch/Dispatch.h).
+#define AVX512 __attribute__((target("avx512f,avx512bw"), section("nussbaumer_backend")))
+
+namespace {
+
+constexpr std::uint16_t Modulus = 2047;
+
+// Once the coefficients may exceed this bound they are reduced, so the next level of butterflies
+// cannot overflow 16 bits.
+constexpr unsigned ReduceThreshold = 1u << 14;
+
+/**
+ * The permutations used to multiply by u^k, for k modulo 32: word i of a product is taken from
+ * word index[k][i] of the polynomial.
+ */
+struct RotationIndices {
+  alignas(64) std::uint16_t index[32][32];
+
+  constexpr RotationIndices() : index() {
+    for(unsigned k = 0; k < 32; ++k) {
+      for(unsigned i = 0; i < 32; ++i)
+        index[k][i] = static_cast<std::uint16_t>((i - k) & 31);
+    }
+  }
+};
+
+constexpr RotationIndices rotationIndices;
+
+/**
+ * The 5-bit values with their bits reversed.
+ */
+constexpr std::uint8_t bitrev5[32] = {
+  0, 16,  8, 24,  4, 20, 12, 28,  2, 18, 10, 26,  6, 22, 14, 30,
+  1, 17,  9, 25,  5, 21, 13, 29,  3, 19, 11, 27,  7, 23, 15, 31
+};
+
+/**
+ * Multiplication by u^k modulo u^32 + 1: a permutation of the coefficients, after which some of
+ * them are negated.
+ */
+struct Rotation {
+  __m512i index;
+  __mmask32 negate;
+};
+
+/**
+ * Create the rotation for multiplication by u^k.
+ * @param[in] k    The power of u; only taken modulo 64.
+ * @return    The rotation.
+ */
+AVX512 inline Rotation makeRotation(unsigned k) {
+  k &= 63;
+
+  // The coefficients that wrap around are negated; if k >= 32 all signs are flipped once more.
+  Rotation rot;
+  rot.index = _mm512_load_si512(rotationIndices.index[k & 31]);
+  rot.negate = (1u << (k & 31)) - 1;
+  if(k >= 32)
+    rot.negate = ~rot.negate;
+  return rot;
+}
+
+/**
+ * Partially reduce the values; a value below "bound" results in one below reducedBound(bound).
+ */
+AVX512 inline __m512i reduce(__m512i x) {
+  return _mm512_add_epi16(_mm512_and_si512(x, _mm512_set1_epi16(Modulus)), _mm512_srli_epi16(x, 11));
+}
+
+/**
+ * Gives the exclusive upper bound on the coefficients after reduce().
+ * @param[in] bound    The exclusive upper bound before reducing.
+ * @return    The exclusive upper bound after reducing.
+ */
+inline unsigned reducedBound(unsigned bound) {
+  return Modulus + ((bound - 1) >> 11) + 1;
+}
+
+/**
+ * Gives the multiple of the modulus to add before subtracting coefficients below "bound", which
+ * is the smallest one that keeps the result non-negative. The results of a + u^k*b are then
+ * below bound + offsetFor(bound).
+ * @param[in] bound    The exclusive upper bound on the coefficients.
+ * @return    The multiple of the modulus.
+ */
+inline unsigned offsetFor(unsigned bound) {
+  return (bound - 1 + Modulus - 1) / Modulus * Modulus;
+}
+
+/**
+ * Calculates a + u^k*b.
+ * @param[in] a        The first polynomial.
+ * @param[in] b        The polynomial to rotate.
+ * @param[in] rot      The rotation for u^k.
+ * @param[in] offset   offsetFor() the bound on the coefficients, in each word.
+ * @return    The result, which is not reduced.
+ */
+AVX512 inline __m512i addRotated(__m512i a, __m512i b, const Rotation& rot, __m512i offset) {
+  __m512i rotated = _mm512_permutexvar_epi16(rot.index, b);
+  return _mm512_add_epi16(a, _mm512_mask_sub_epi16(rotated, rot.negate, offset, rotated));
+}
+
+/**
+ * Sets (a, b) to (a + u^k*b, a - u^k*b).
+ * @param[in,out] a        The first polynomial.
+ * @param[in,out] b        The polynomial to rotate.
+ * @param[in]     rot      The rotation for u^k.
+ * @param[in]     offset   offsetFor() the bound on the coefficients, in each word.
+ * @param[in]     reduced  Whether to reduce the results.
+ */
+AVX512 inline void butterfly(__m512i& a, __m512i& b, const Rotation& rot, __m512i offset, bool reduced) {
+  // "term" is u^k*b in the words that are not negated, and offset - u^k*b in the others, so
+  // a + offset - term is a - u^k*b.
+  __m512i rotated = _mm512_permutexvar_epi16(rot.index, b);
+  __m512i term = _mm512_mask_sub_epi16(rotated, rot.negate, offset, rotated);
+  __m512i sum = _mm512_add_epi16(a, term);
+  __m512i diff = _mm512_sub_epi16(_mm512_add_epi16(a, offset), term);
+  a = reduced ? reduce(sum) : sum;
+  b = reduced ? reduce(diff) : diff;
+}
+
+/**
+ * A level of the FFT, in which polynomials e and e + 2^j are combined for each e without bit j
+ * set.
+ */
+struct Level {
+  unsigned j;
+  bool inverse;
+  __m512i offset;
+  bool reduced;
+};
+
+/**
+ * Sets up a level of the FFT, choosing the offset and whether to reduce the results.
+ * @param[in]     j        The level.
+ * @param[in]     inverse  Whether this is a level of the inverse transform.
+ * @param[in,out] bound    The exclusive upper bound on the input coefficients; set to the bound
+ *                         on the output coefficients.
+ * @return    The level.
+ */
+AVX512 inline Level makeLevel(unsigned j, bool inverse, unsigned& bound) {
+  Level level;
+  level.j = j;
+  level.inverse = inverse;
+  level.offset = _mm512_set1_epi16(offsetFor(bound));
+  bound += offsetFor(bound);
+  level.reduced = bound > ReduceThreshold;
+  if(level.reduced)
+    bound = reducedBound(bound);
+  return level;
+}
+
+/**
+ * Gives the power of u the second polynomial of a butterfly is multiplied with.
+ * @param[in] level    The level of the FFT.
+ * @param[in] e        The index of the first polynomial of the butterfly.
+ * @return    The power of u, modulo 64.
+ */
+inline unsigned powerFor(const Level& level, std::size_t e) {
+  // The forward transform uses bitrev(5 - j, s) << j for block s, which equals the 5-bit
+  // reversal of s. The inverse transform uses -t << (5 - j) at offset t within the block.
+  if(!level.inverse)
+    return bitrev5[e >> (level.j + 1)];
+  return static_cast<unsigned>(64 - ((e & ((1u << level.j) - 1)) << (5 - level.j)));
+}
+
+/**
+ * Runs a number of consecutive levels of the FFT on a group of polynomials kept in registers.
+ * Polynomial m of the group is polynomial base + (m << firstBit) of the transform.
+ * @param[in,out] group      The polynomials of the group.
+ * @param[in]     base       The index of the first polynomial of the group.
+ * @param[in]     firstBit   The lowest of the levels.
+ * @param[in]     levels     The levels, in the order to run them in; these are descending if
+ *                           Descending is true and ascending otherwise.
+ */
+template<std::size_t NumLevels, bool Descending>
+AVX512 inline void runLevels(__m512i* group, std::size_t base, unsigned firstBit, const Level* levels) {
+  constexpr std::size_t GroupSize = 1u << NumLevels;
+
+  // The loops are unrolled, so the group stays in registers.
+#pragma GCC unroll 3
+  for(std::size_t l = 0; l < NumLevels; ++l) {
+    std::size_t bit = 1u << (Descending ? NumLevels - 1 - l : l);
+#pragma GCC unroll 8
+    for(std::size_t m = 0; m < GroupSize; ++m) {
+      if(m & bit)
+        continue;
+      Rotation rot = makeRotation(powerFor(levels[l], base + (m << firstBit)));
+      butterfly(group[m], group[m | bit], rot, levels[l].offset, levels[l].reduced);
+    }
+  }
+}
+
+/**
+ * Swaps bit 0 of the row index with bit 0 of the column index, for a pair of rows.
+ */
+AVX512 inline void swapBit1(__m512i& low, __m512i& high) {
+  __m512i newLow = _mm512_mask_blend_epi16(0xAAAAAAAA, low, _mm512_slli_epi32(high, 16));
+  high = _mm512_mask_blend_epi16(0xAAAAAAAA, _mm512_srli_epi32(low, 16), high);
+  low = newLow;
+}
+
+/**
+ * Swaps bit 1 of the row index with bit 1 of the column index, for a pair of rows.
+ */
+AVX512 inline void swapBit2(__m512i& low, __m512i& high) {
+  __m512i newLow = _mm512_mask_shuffle_epi32(low, 0xAAAA, high, _MM_PERM_CCAA);
+  high = _mm512_mask_shuffle_epi32(high, 0x5555, low, _MM_PERM_DDBB);
+  low = newLow;
+}
+
+/**
+ * Swaps bit 2 of the row index with bit 2 of the column index, for a pair of rows.
+ */
+AVX512 inline void swapBit4(__m512i& low, __m512i& high) {
+  __m512i newLow = _mm512_unpacklo_epi64(low, high);
+  high = _mm512_unpackhi_epi64(low, high);
+  low = newLow;
+}
+
+/**
+ * Swaps bit 3 of the row index with bit 3 of the column index, for a pair of rows.
+ */
+AVX512 inline void swapBit8(__m512i& low, __m512i& high) {
+  __m512i newLow = _mm512_mask_shuffle_i64x2(low, 0xCC, high, high, 0xA0);
+  high = _mm512_mask_shuffle_i64x2(high, 0x33, low, low, 0xF5);
+  low = newLow;
+}
+
+/**
+ * Swaps bit 4 of the row index with bit 4 of the column index, for a pair of rows.
+ */
+AVX512 inline void swapBit16(__m512i& low, __m512i& high) {
+  __m512i newLow = _mm512_shuffle_i64x2(low, high, 0x44);
+  high = _mm512_shuffle_i64x2(low, high, 0xEE);
+  low = newLow;
+}
+
+/**
+ * Swaps bits 0-2 of the row index with the same bits of the column index, for 8 consecutive rows
+ * of a 32x32 matrix of words. Together with swapHighBits this transposes the matrix.
+ */
+AVX512 inline void swapLowBits(__m512i* rows) {
+#pragma GCC unroll 4
+  for(std::size_t i = 0; i < 8; i += 2)
+    swapBit1(rows[i], rows[i + 1]);
+#pragma GCC unroll 8
+  for(std::size_t i = 0; i < 8; ++i) {
+    if(!(i & 2))
+      swapBit2(rows[i], rows[i + 2]);
+  }
+#pragma GCC unroll 4
+  for(std::size_t i = 0; i < 4; ++i)
+    swapBit4(rows[i], rows[i + 4]);
+}
+
+/**
+ * Swaps bits 3-4 of the row index with the same bits of the column index, for the rows r, r + 8,
+ * r + 16 and r + 24 of a 32x32 matrix of words.
+ */
+AVX512 inline void swapHighBits(__m512i* rows) {
+  swapBit8(rows[0], rows[1]);
+  swapBit8(rows[2], rows[3]);
+  swapBit16(rows[0], rows[2]);
+  swapBit16(rows[1], rows[3]);
+}
+
+}
+
+
+/**
+ * Checks whether the processor supports the AVX-512 (F and BW) instructions used by the
+ * functions in this file.
+ * @return Whether the AVX-512 transforms can be used.
+ */
+bool nussbaumer1024_avx512_supported() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+}
+
+/**
+ * Performs the forward Nussbaumer transform using AVX-512BW.
+ * @param[out] dest    The memory to store the transformed input.
+ * @param[in]  src     The coefficients of the polynomial.
+ */
+AVX512 void nussbaumer1024_forward_avx512(Transformed dest, std::uint16_t* src) {
+  __m512i pols[64];
+
+  // The levels of the FFT, with the output in bit-reversed order. The coefficients are only
+  // reduced when needed; the output stays below 2^14.
+  unsigned bound = 1u << 11;
+  Level levels[5];
+  for(unsigned j = 0; j < 5; ++j)
+    levels[j] = makeLevel(4 - j, false, bound);
+
+  // Polynomial i consists of the coefficients i, 32 + i, 64 + i, ..., which is a transpose. The
+  // second step of the transpose is combined with the first two levels.
+  for(std::size_t base = 0; base < 32; base += 8) {
+    __m512i rows[8];
+    for(std::size_t i = 0; i < 8; ++i)
+      rows[i] = _mm512_loadu_si512(src + 32*(base + i));
+    swapLowBits(rows);
+    for(std::size_t i = 0; i < 8; ++i)
+      pols[base + i] = rows[i];
+  }
+
+  // The second half starts out as a copy of the first.
+  for(std::size_t base = 0; base < 8; ++base) {
+    __m512i rows[4], copy[4];
+    for(std::size_t i = 0; i < 4; ++i)
+      rows[i] = pols[base + 8*i];
+    swapHighBits(rows);
+    for(std::size_t i = 0; i < 4; ++i)
+      copy[i] = rows[i];
+
+    runLevels<2, true>(rows, base, 3, levels);
+    runLevels<2, true>(copy, base + 32, 3, levels);
+    for(std::size_t i = 0; i < 4; ++i) {
+      pols[base + 8*i] = rows[i];
+      pols[base + 8*i + 32] = copy[i];
+    }
+  }
+
+  // The last three levels, combined with the first step of transposing the output.
+  for(std::size_t base = 0; base < 64; base += 8) {
+    __m512i rows[8];
+    for(std::size_t i = 0; i < 8; ++i)
+      rows[i] = pols[base + i];
+    runLevels<3, true>(rows, base, 0, levels + 2);
+    swapLowBits(rows);
+    for(std::size_t i = 0; i < 8; ++i)
+      pols[base + i] = rows[i];
+  }
+
+  // Store coefficient j of polynomial i at i + 64*j.
+  for(std::size_t half = 0; half < 2; ++half) {
+    for(std::size_t base = 0; base < 8; ++base) {
+      __m512i rows[4];
+      for(std::size_t i = 0; i < 4; ++i)
+        rows[i] = pols[32*half + base + 8*i];
+      swapHighBits(rows);
+      for(std::size_t i = 0; i < 4; ++i)
+        _mm512_storeu_si512(dest + 64*(base + 8*i) + 32*half, rows[i]);
+    }
+  }
+}
+
+/**
+ * Calculate the inverse Nussbaumer transform using AVX-512BW.
+ * @param[out] dest    The memory region to store the result.
+ * @param[in]  src     The transformed value.
+ */
+AVX512 void nussbaumer1024_inverse_avx512(TransformedResult dest, Transformed src) {
+  __m512i pols[64];
+
+  // The levels of the inverse FFT, through a DIT with bit-reversed input; the powers of u are
+  // negative.
+  unsigned bound = 1u << 12;
+  Level levels[6];
+  for(unsigned j = 0; j < 6; ++j)
+    levels[j] = makeLevel(j, true, bound);
+
+  // Transpose the input, with the first step of the transpose combined with the first three
+  // levels.
+  for(std::size_t half = 0; half < 2; ++half) {
+    for(std::size_t base = 0; base < 8; ++base) {
+      __m512i rows[4];
+      for(std::size_t i = 0; i < 4; ++i)
+        rows[i] = _mm512_loadu_si512(src + 64*(base + 8*i) + 32*half);
+      swapHighBits(rows);
+      for(std::size_t i = 0; i < 4; ++i)
+        pols[32*half + base + 8*i] = rows[i];
+    }
+  }
+
+  for(std::size_t base = 0; base < 64; base += 8) {
+    __m512i rows[8];
+    for(std::size_t i = 0; i < 8; ++i)
+      rows[i] = pols[base + i];
+    swapLowBits(rows);
+    runLevels<3, false>(rows, base, 0, levels);
+    for(std::size_t i = 0; i < 8; ++i)
+      pols[base + i] = rows[i];
+  }
+
+  // The last three levels, followed by unpacking: coefficient 32*j + i of the result is
+  // coefficient j of z[i] + u*z[32 + i]. These are then transposed, in two steps again.
+  Rotation shift = makeRotation(1);
+  __m512i offset = _mm512_set1_epi16(offsetFor(bound));
+  for(std::size_t base = 0; base < 8; ++base) {
+    __m512i group[8], rows[4];
+    for(std::size_t m = 0; m < 8; ++m)
+      group[m] = pols[base + 8*m];
+    runLevels<3, false>(group, base, 3, levels + 3);
+
+    for(std::size_t i = 0; i < 4; ++i)
+      rows[i] = addRotated(group[i], group[i + 4], shift, offset);
+    swapHighBits(rows);
+    for(std::size_t i = 0; i < 4; ++i)
+      pols[base + 8*i] = rows[i];
+  }
+
+  // The results stay below 2^15, so two reductions bring them to at most 2047. Then multiply by
+  // 1/64 = 2^5, which is a rotation of the 11 bits; 2047 itself is mapped to 0 afterwards.
+  for(std::size_t base = 0; base < 32; base += 8) {
+    __m512i rows[8];
+    for(std::size_t i = 0; i < 8; ++i)
+      rows[i] = pols[base + i];
+    swapLowBits(rows);
+
+    for(std::size_t i = 0; i < 8; ++i) {
+      __m512i value = reduce(reduce(rows[i]));
+      value = _mm512_or_si512(_mm512_and_si512(_mm512_slli_epi16(value, 5), _mm512_set1_epi16(Modulus)),
+                              _mm512_srli_epi16(value, 6));
+      value = _mm512_min_epu16(value, _mm512_sub_epi16(value, _mm512_set1_epi16(Modulus)));
+      _mm512_storeu_si512(dest + 32*(base + i), value);
+    }
+  }
+}
+
+/**
+ * Multiply two polynomials modulo X^1024 + 1, using the AVX-512BW transforms.
+ * @param[out] dest    The 1024 coefficients of the product, reduced modulo 2047.
+ * @param[in]  src1    The first polynomial.
+ * @param[in]  src2    The second polynomial.
+ */
+void nussbaumer1024_multiply_avx512(std::uint16_t* dest, std::uint16_t* src1, std::uint16_t* src2) {
+  Transformed transformed1, transformed2;
+  ComponentwiseWorkspace workspace;
+
+  nussbaumer1024_forward_avx512(transformed1, src1);
+  nussbaumer1024_forward_avx512(transformed2, src2);
+  componentwise32_64_prepare(transformed1);
+  componentwise32_64_prepare(transformed2);
+  componentwise32_64_run_r(transformed1, transformed1, transformed2, workspace);
+  nussbaumer1024_inverse_avx512(dest, transformed1);
+}
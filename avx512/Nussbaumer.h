@@ -0,0 +1,52 @@
+#ifndef AVX512_NUSSBAUMER_H_
+#define AVX512_NUSSBAUMER_H_
+
+#include <cstdint>
+
+#include "avx2/Nussbaumer.h"
+
+/**
+ * Type of the forward Nussbaumer transform entry points.
+ */
+typedef void (*NussbaumerForwardFunction)(Transformed dest, std::uint16_t* src);
+
+/**
+ * Type of the inverse Nussbaumer transform entry points.
+ */
+typedef void (*NussbaumerInverseFunction)(TransformedResult dest, Transformed src);
+
+/**
+ * Checks whether the processor supports the AVX-512 (F and BW) instructions used by the
+ * functions in this file.
+ * @return Whether the AVX-512 transforms can be used.
+ */
+bool nussbaumer1024_avx512_supported();
+
+/**
+ * Performs the forward Nussbaumer transform using AVX-512BW, where each of the 32-coefficient
+ * inner polynomials is kept in a single zmm register. The output has the same layout and bounds
+ * as nussbaumer1024_forward. Only call this if nussbaumer1024_avx512_supported() returns true.
+ * @param[out] dest    The memory to store the transformed input.
+ * @param[in]  src     The coefficients of the polynomial.
+ */
+void nussbaumer1024_forward_avx512(Transformed dest, std::uint16_t* src);
+
+/**
+ * Calculate the inverse Nussbaumer transform using AVX-512BW. The input and output are the same
+ * as for nussbaumer1024_inverse, and dest may be equal to src. Only call this if
+ * nussbaumer1024_avx512_supported() returns true.
+ * @param[out] dest    The memory region to store the result.
+ * @param[in]  src     The transformed value.
+ */
+void nussbaumer1024_inverse_avx512(TransformedResult dest, Transformed src);
+
+/**
+ * Multiply two polynomials modulo X^1024 + 1, using the AVX-512BW transforms and the AVX2
+ * componentwise multiplication. Only call this if nussbaumer1024_avx512_supported() returns true.
+ * @param[out] dest    The 1024 coefficients of the product, reduced modulo 2047.
+ * @param[in]  src1    The first polynomial; coefficients must have at most 11 bits.
+ * @param[in]  src2    The second polynomial; coefficients must have at most 11 bits.
+ */
+void nussbaumer1024_multiply_avx512(std::uint16_t* dest, std::uint16_t* src1, std::uint16_t* src2);
+
+#endif
@@ -0,0 +1,245 @@
+/**
+ * @file BarrettRingElt.h
+ * @author Gerben van der Lubbe
+ *
+ * File for storing elements in the ring Z/qZ, multiplying with Barrett reduction.
+ */
+
+#ifndef BARRETTRINGELT_H
+#define BARRETTRINGELT_H
+
+#include <iostream>
+#include <cstdint>
+
+#include "Util.h"
+#include "OpCount.h"
+#include "DoubleWord.h"
+
+/**
+ * Class to deal with the ring Z/qZ, where q == Modulus, using Barrett reduction. An element is
+ * stored as its value in [0, q) in a Word, and a product is reduced by estimating the quotient
+ * with two multiplications and shifts instead of a division. Unlike MontgomeryRingElt, the
+ * modulus may be even, and no conversion is needed. Word may be std::uint32_t (for q < 2^31) or
+ * std::uint64_t (for q < 2^63). The constant for the reduction is calculated at compile time.
+ *
+ * The interface and the operation counts are those of RingModElt. The NegaNussbaumer variants
+ * pass constants through an int, so these need q < 2^31.
+ */
+template<std::uint64_t Modulus, typename Word = std::uint32_t, typename Counter = OpCount>
+class BarrettRingElt : public Multiplies<BarrettRingElt<Modulus, Word, Counter>>,
+                       public Multiplies<BarrettRingElt<Modulus, Word, Counter>, int>,
+                       public Adds<BarrettRingElt<Modulus, Word, Counter>>,
+                       public Subtracts<BarrettRingElt<Modulus, Word, Counter>>,
+                       public CompEquality<BarrettRingElt<Modulus, Word, Counter>> {
+public:
+  static_assert(Modulus > 1, "the modulus must be at least 2");
+  static_assert(bitLength(Modulus) < 8*sizeof(Word), "the modulus must leave one bit of the word free");
+
+  BarrettRingElt(std::int64_t value = 0);
+
+  std::int64_t toInt() const;
+
+  const BarrettRingElt<Modulus, Word, Counter>& operator+=(const BarrettRingElt<Modulus, Word, Counter>& e);
+  const BarrettRingElt<Modulus, Word, Counter>& operator-=(const BarrettRingElt<Modulus, Word, Counter>& e);
+  const BarrettRingElt<Modulus, Word, Counter>& operator*=(const BarrettRingElt<Modulus, Word, Counter>& e);
+  const BarrettRingElt<Modulus, Word, Counter>& operator*=(const int& e);
+
+  const BarrettRingElt<Modulus, Word, Counter> operator-() const;
+
+  static bool getInverse(BarrettRingElt<Modulus, Word, Counter>& inverse,
+                         const BarrettRingElt<Modulus, Word, Counter>& value);
+
+  static Counter& getOpCount();
+  static void setOpCount(const Counter& opCount);
+
+  friend bool operator==(const BarrettRingElt<Modulus, Word, Counter>& a,
+                         const BarrettRingElt<Modulus, Word, Counter>& b) {
+    return a.value_ == b.value_;
+  }
+
+private:
+  typedef typename DoubleWord<Word>::Type Wide;
+
+  /// The bit length k of q
+  static constexpr unsigned int ModulusBits = bitLength(Modulus);
+  /// floor(2^2k / q)
+  static constexpr Word Factor = barrettFactor<Word>(Modulus);
+
+  static Word reduce(Wide value);
+
+  Word value_ = 0;
+  static Counter opCount_;
+};
+
+
+/**
+ * Write a BarrettRingElt to a stream.
+ * @param[in] out      The stream to write to.
+ * @param[in] e        The BarrettRingElt to write.
+ * @return    A reference to the stream.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+std::ostream& operator<<(std::ostream& out, const BarrettRingElt<Modulus, Word, Counter>& e) {
+  out << e.toInt();
+  return out;
+}
+
+
+template<std::uint64_t Modulus, typename Word, typename Counter>
+constexpr unsigned int BarrettRingElt<Modulus, Word, Counter>::ModulusBits;
+
+template<std::uint64_t Modulus, typename Word, typename Counter>
+constexpr Word BarrettRingElt<Modulus, Word, Counter>::Factor;
+
+
+/**
+ * Keeps track of the number of operations performed on the ring.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+Counter BarrettRingElt<Modulus, Word, Counter>::opCount_;
+
+
+/**
+ * Gets the counter for number of operations on the ring. This value is
+ * different for different Modulus.
+ * @return A reference to the counter.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+Counter& BarrettRingElt<Modulus, Word, Counter>::getOpCount() {
+  return opCount_;
+}
+
+
+/**
+ * Update the operation counter to this value.
+ * @param[in] opCount  The number of operations at this time.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+void BarrettRingElt<Modulus, Word, Counter>::setOpCount(const Counter& opCount) {
+  opCount_ = opCount;
+}
+
+
+/**
+ * Barrett reduction: calculate value mod q.
+ * @param[in] value    The value to reduce, less than q^2.
+ * @return    The reduced value, in [0, q).
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+Word BarrettRingElt<Modulus, Word, Counter>::reduce(Wide value) {
+  // Both factors of the estimate are below 2^(k+1), so their product fits; the estimate is at
+  // most 2 below the real quotient.
+  Wide quotient = ((value >> (ModulusBits - 1))*Factor) >> (ModulusBits + 1);
+  Wide result = value - quotient*Modulus;
+  if(result >= Modulus)
+    result -= Modulus;
+  return static_cast<Word>(result >= Modulus ? result - Modulus : result);
+}
+
+
+/**
+ * Create a ring element modulo the Modulus, with a specified integer value.
+ * @param[in] value   The initial value to set; it does not have to be reduced.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+BarrettRingElt<Modulus, Word, Counter>::BarrettRingElt(std::int64_t value)
+: value_(static_cast<Word>(reduceSigned(value, Modulus)))
+{}
+
+
+/**
+ * Convert the element of the used ring (Z/mZ where m = Modulus) to the integer
+ * value.
+ * @return The integer value, in [0, q).
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+std::int64_t BarrettRingElt<Modulus, Word, Counter>::toInt() const {
+  return static_cast<std::int64_t>(value_);
+}
+
+
+/**
+ * Addition assignment operator for BarrettRingElt.
+ * @param[in] e        The value to add.
+ * @return    A reference to self.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+const BarrettRingElt<Modulus, Word, Counter>& BarrettRingElt<Modulus, Word, Counter>::operator+=(
+                                            const BarrettRingElt<Modulus, Word, Counter>& e
+                                                                                              ) {
+  value_ += e.value_;
+  if(value_ >= Modulus)
+    value_ -= Modulus;
+  opCount_.countAddition();
+  return *this;
+}
+
+
+/**
+ * Subtract-assignment from the BarrettRingElt.
+ * @param[in] e        The value to subtract.
+ * @return    A reference to self.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+const BarrettRingElt<Modulus, Word, Counter>& BarrettRingElt<Modulus, Word, Counter>::operator-=(
+                                            const BarrettRingElt<Modulus, Word, Counter>& e
+                                                                                              ) {
+  value_ = value_ >= e.value_ ? value_ - e.value_ : value_ + (Modulus - e.value_);
+  opCount_.countAddition();
+  return *this;
+}
+
+
+/**
+ * Multiplication-assignment operator by another BarrettRingElt.
+ * @param[in] e        The BarrettRingElt value to multiply with.
+ * @return    A reference to self.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+const BarrettRingElt<Modulus, Word, Counter>& BarrettRingElt<Modulus, Word, Counter>::operator*=(
+                                            const BarrettRingElt<Modulus, Word, Counter>& e
+                                                                                              ) {
+  value_ = reduce(static_cast<Wide>(value_)*e.value_);
+  opCount_.countMultiplication();
+  return *this;
+}
+
+
+/**
+ * Multiplication-assignment operator by a constant.
+ * @param[in] e        The constant value to multiply with.
+ * @return    A reference to self.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+const BarrettRingElt<Modulus, Word, Counter>& BarrettRingElt<Modulus, Word, Counter>::operator*=(
+                                                      const int& e
+                                                                                              ) {
+  value_ = reduce(static_cast<Wide>(value_)*reduceSigned(e, Modulus));
+  opCount_.countConstMult();
+  return *this;
+}
+
+
+/**
+ * Sign inversion operator for a BarrettRingElt (counted as an addition).
+ * @return   The value, sign-inverted.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+const BarrettRingElt<Modulus, Word, Counter> BarrettRingElt<Modulus, Word, Counter>::operator-() const {
+  BarrettRingElt<Modulus, Word, Counter> ret(BarrettRingElt<Modulus, Word, Counter>() - *this);
+  return ret;
+}
+
+
+template<std::uint64_t Modulus, typename Word, typename Counter>
+bool BarrettRingElt<Modulus, Word, Counter>::getInverse(BarrettRingElt<Modulus, Word, Counter>& inverse,
+                                                           const BarrettRingElt<Modulus, Word, Counter>& value) {
+  std::uint64_t inverseValue;
+  if(!inverseModulo(inverseValue, static_cast<std::uint64_t>(value.toInt()), Modulus))
+    return false;
+
+  inverse = BarrettRingElt<Modulus, Word, Counter>(static_cast<std::int64_t>(inverseValue));
+  return true;
+}
+
+#endif
@@ -0,0 +1,168 @@
+/**
+ * @file Butterfly.h
+ * @author Gerben van der Lubbe
+ *
+ * In-place butterflies on polynomials modulo u^r + 1, as used by the FFT steps of Nussbaumer's
+ * algorithm. Multiplying by u^k moves coefficient j to j + k, negating it for every wrap past
+ * u^r = -1; the butterflies follow the cycles of this permutation, so each coefficient is read
+ * once and written once, without temporary polynomials.
+ */
+
+#ifndef BUTTERFLY_H
+#define BUTTERFLY_H
+
+#include <cstddef>
+
+#include "PolynomialMatrix.h"
+
+/**
+ * Get the position and sign of coefficient j after a multiplication by u^steps modulo u^r + 1.
+ * @param[in]  j        The index of the coefficient.
+ * @param[in]  steps    The power of u, with 0 <= steps < 2r.
+ * @param[in]  r        The size of the polynomials.
+ * @param[out] negate   Whether the coefficient is negated.
+ * @return     The new index.
+ */
+inline std::size_t rotatedIndex(std::size_t j, std::size_t steps, std::size_t r, bool& negate) {
+  std::size_t dest = j + steps;
+  negate = (dest / r) & 1;
+  return dest % r;
+}
+
+
+/**
+ * Normalize a power of u to 0 <= steps < 2r, as u^2r = 1.
+ * @param[in] steps    The power of u.
+ * @param[in] r        The size of the polynomials.
+ * @return    The normalized power.
+ */
+inline std::size_t normalizeSteps(std::ptrdiff_t steps, std::size_t r) {
+  std::ptrdiff_t twoR = static_cast<std::ptrdiff_t>(2*r);
+  steps %= twoR;
+  if(steps < 0)
+    steps += twoR;
+  return static_cast<std::size_t>(steps);
+}
+
+
+/**
+ * Get the number of cycles of the permutation of a rotation by steps: gcd(steps mod r, r).
+ * @param[in] steps    The normalized power of u.
+ * @param[in] r        The size of the polynomials.
+ * @return    The number of cycles; the first one starts at index 0, the next at 1, etc.
+ */
+inline std::size_t rotationCycles(std::size_t steps, std::size_t r) {
+  std::size_t a = r, b = steps % r;
+  while(b != 0) {
+    std::size_t tmp = a % b;
+    a = b;
+    b = tmp;
+  }
+  return a;
+}
+
+
+/**
+ * Calculate (simultaneously) e = e + u^steps*f and f = e - u^steps*f modulo u^r + 1, in place.
+ * @param[in,out] e        The first polynomial.
+ * @param[in,out] f        The second polynomial, of the same size.
+ * @param[in]     steps    The power of u to multiply f with.
+ * @param[in]     needE    Whether e is needed; if not, e is set to 0 without calculating it.
+ * @param[in]     needF    Whether f is needed; if not, f is left unchanged.
+ */
+template<typename RingElt>
+void butterflyDit(const PolynomialView<RingElt>& e, const PolynomialView<RingElt>& f, std::ptrdiff_t steps,
+                  bool needE = true, bool needF = true) {
+  std::size_t r = e.getSize();
+  std::size_t k = normalizeSteps(steps, r);
+  std::size_t cycles = rotationCycles(k, r);
+
+  for(std::size_t start = 0; start < cycles; ++start) {
+    // Carry the coefficient of f along the cycle, reading the next one before overwriting it.
+    RingElt carry = f[start];
+    std::size_t j = start;
+    while(true) {
+      bool negate;
+      std::size_t index = rotatedIndex(j, k, r, negate);
+      RingElt next = f[index];
+      RingElt a = e[index];
+      if(needE)
+        e[index] = negate ? a - carry : a + carry;
+      else
+        e[index] = RingElt();
+      if(needF)
+        f[index] = negate ? a + carry : a - carry;
+
+      if(index == start)
+        break;
+      carry = next;
+      j = index;
+    }
+  }
+}
+
+
+/**
+ * Calculate (simultaneously) e = e + f and f = u^steps*(e - f) modulo u^r + 1, in place.
+ * @param[in,out] e        The first polynomial.
+ * @param[in,out] f        The second polynomial, of the same size.
+ * @param[in]     steps    The power of u to multiply the difference with.
+ */
+template<typename RingElt>
+void butterflyDif(const PolynomialView<RingElt>& e, const PolynomialView<RingElt>& f, std::ptrdiff_t steps) {
+  std::size_t r = e.getSize();
+  std::size_t k = normalizeSteps(steps, r);
+  std::size_t cycles = rotationCycles(k, r);
+
+  for(std::size_t start = 0; start < cycles; ++start) {
+    // Carry the difference along the cycle; each position is summed before its f is replaced.
+    RingElt diff = e[start] - f[start];
+    e[start] += f[start];
+    std::size_t j = start;
+    while(true) {
+      bool negate;
+      std::size_t index = rotatedIndex(j, k, r, negate);
+      if(index == start) {
+        f[index] = negate ? -diff : diff;
+        break;
+      }
+
+      RingElt nextDiff = e[index] - f[index];
+      e[index] += f[index];
+      f[index] = negate ? -diff : diff;
+      diff = nextDiff;
+      j = index;
+    }
+  }
+}
+
+
+/**
+ * Multiply a polynomial by u^steps modulo u^r + 1, in place.
+ * @param[in,out] pol      The polynomial.
+ * @param[in]     steps    The power of u.
+ */
+template<typename RingElt>
+void rotateInPlace(const PolynomialView<RingElt>& pol, std::ptrdiff_t steps) {
+  std::size_t r = pol.getSize();
+  std::size_t k = normalizeSteps(steps, r);
+  std::size_t cycles = rotationCycles(k, r);
+
+  for(std::size_t start = 0; start < cycles; ++start) {
+    RingElt carry = pol[start];
+    std::size_t j = start;
+    while(true) {
+      bool negate;
+      std::size_t index = rotatedIndex(j, k, r, negate);
+      RingElt next = pol[index];
+      pol[index] = negate ? -carry : carry;
+
+      if(index == start)
+        break;
+      carry = next;
+      j = index;
+    }
+  }
+}
+
+#endif
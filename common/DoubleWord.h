@@ -0,0 +1,129 @@
+/**
+ * @file DoubleWord.h
+ * @author Gerben van der Lubbe
+ *
+ * Helpers shared by the ring elements that reduce with Montgomery or Barrett reduction.
+ */
+
+#ifndef DOUBLEWORD_H
+#define DOUBLEWORD_H
+
+#include <cstdint>
+
+/**
+ * The unsigned type that holds the product of two Words.
+ */
+template<typename Word>
+struct DoubleWord;
+
+template<>
+struct DoubleWord<std::uint32_t> {
+  typedef std::uint64_t Type;
+};
+
+template<>
+struct DoubleWord<std::uint64_t> {
+  __extension__ typedef unsigned __int128 Type;
+};
+
+
+/**
+ * Get the number of bits needed to represent the value.
+ * @param[in] value    The value.
+ * @return    The index of the highest set bit plus one, or 0 for 0.
+ */
+constexpr unsigned int bitLength(std::uint64_t value) {
+  unsigned int length = 0;
+  while(value != 0) {
+    ++length;
+    value >>= 1;
+  }
+  return length;
+}
+
+
+/**
+ * Get -modulus^-1 modulo 2^w, with w the number of bits in a Word, by Newton iteration.
+ * @param[in] modulus  The modulus, which must be odd.
+ * @return    The negated inverse.
+ */
+template<typename Word>
+constexpr Word montgomeryNegInverse(Word modulus) {
+  // An odd modulus is its own inverse modulo 2^3; each step doubles the number of correct bits.
+  Word inverse = modulus;
+  for(int i = 0; i < 5; ++i)
+    inverse *= 2 - modulus*inverse;
+  return -inverse;
+}
+
+
+/**
+ * Get R^2 modulo the modulus, where R = 2^w and w is the number of bits in a Word.
+ * @param[in] modulus  The modulus.
+ * @return    R^2 mod modulus.
+ */
+template<typename Word>
+constexpr Word montgomeryRSquared(Word modulus) {
+  typedef typename DoubleWord<Word>::Type Wide;
+  Wide r = (Wide(1) << (8*sizeof(Word))) % modulus;
+  return static_cast<Word>(r*r % modulus);
+}
+
+
+/**
+ * Get the Barrett constant floor(2^2k / modulus), where k is the bit length of the modulus.
+ * @param[in] modulus  The modulus, of at most 8*sizeof(Word) - 1 bits.
+ * @return    The constant, which is less than 2^(k+1).
+ */
+template<typename Word>
+constexpr Word barrettFactor(Word modulus) {
+  typedef typename DoubleWord<Word>::Type Wide;
+  return static_cast<Word>((Wide(1) << (2*bitLength(modulus))) / modulus);
+}
+
+
+/**
+ * Reduce a signed integer to the range [0, modulus).
+ * @param[in] value    The value to reduce.
+ * @param[in] modulus  The modulus, less than 2^63.
+ * @return    The reduced value.
+ */
+constexpr std::uint64_t reduceSigned(std::int64_t value, std::uint64_t modulus) {
+  std::int64_t rem = value % static_cast<std::int64_t>(modulus);
+  return static_cast<std::uint64_t>(rem < 0 ? rem + static_cast<std::int64_t>(modulus) : rem);
+}
+
+
+/**
+ * Calculate the inverse of a value modulo a modulus with the extended Euclidian algorithm.
+ * @param[out] inverse  The inverse, in [0, modulus), if it exists.
+ * @param[in]  value    The value to invert, in [0, modulus).
+ * @param[in]  modulus  The modulus, less than 2^63.
+ * @return     Whether the value is invertible.
+ */
+inline bool inverseModulo(std::uint64_t& inverse, std::uint64_t value, std::uint64_t modulus) {
+  std::int64_t t = 0;
+  std::int64_t tNew = 1;
+  std::int64_t r = static_cast<std::int64_t>(modulus);
+  std::int64_t rNew = static_cast<std::int64_t>(value);
+  while(rNew != 0) {
+    std::int64_t q = r / rNew;
+    std::int64_t tmp;
+
+    tmp = t - q*tNew;
+    t = tNew;
+    tNew = tmp;
+
+    tmp = r - q*rNew;
+    r = rNew;
+    rNew = tmp;
+  }
+
+  if(r > 1)
+    return false;
+
+  inverse = reduceSigned(t, modulus);
+  return true;
+}
+
+#endif
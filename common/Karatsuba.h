@@ -12,6 +12,8 @@
 #include <iostream>
 
 #include "Polynomial.h"
+#include "PolynomialMatrix.h"
+#include "NussbaumerArena.h"
 
 /**
  * Perform the Karatsuba method of polynomial multiplication. The two
@@ -81,4 +83,151 @@ Polynomial<RingType> karatsuba(const Polynomial<RingType>& p1,
   return ret;
 }
 
+
+/**
+ * Multiply two polynomials modulo X^n + 1 with the Karatsuba method: calculate the full product,
+ * and subtract its upper half from the lower half.
+ * @param[in] n      The n of X^n + 1, which is the size of both polynomials (a power of 2).
+ * @param[in] p1     The first polynomial.
+ * @param[in] p2     The second polynomial.
+ * @return    The negacyclic convolution of p1 and p2.
+ */
+template<typename RingType>
+Polynomial<RingType> karatsuba_negacyclic(std::size_t n,
+                                          const Polynomial<RingType>& p1,
+                                          const Polynomial<RingType>& p2) {
+  assert(p1.getSize() == n);
+  Polynomial<RingType> product = karatsuba(p1, p2);
+  Polynomial<RingType> ret(n);
+  for(std::size_t i = 0; i < n - 1; ++i)
+    ret[i] = product[i] - product[i + n];
+  ret[n - 1] = product[n - 1];
+  return ret;
+}
+
+
+/**
+ * Get the number of arena elements that karatsuba with an arena needs for polynomials of size n:
+ * two sums and three products for each level of recursion.
+ * @param[in] n      The size of both polynomials (a power of 2).
+ * @return    The number of elements.
+ */
+template<typename RingType>
+std::size_t karatsuba_scratch_size(std::size_t n) {
+  if(n == 1)
+    return 0;
+
+  std::size_t m = n/2;
+  return 2*NussbaumerArena<RingType>::roundUp(m) + 3*NussbaumerArena<RingType>::roundUp(2*m - 1) +
+         karatsuba_scratch_size<RingType>(m);
+}
+
+
+/**
+ * Perform the Karatsuba method of polynomial multiplication, like the other karatsuba, but on
+ * contiguous coefficients, with the same operations, taking all temporaries from the arena.
+ * @param[out]    ret      The product of p1 and p2, of 2n - 1 coefficients; it must not overlap
+ *                         p1 or p2.
+ * @param[in]     p1       The first polynomial.
+ * @param[in]     p2       The second polynomial.
+ * @param[in]     n        The size of both polynomials (a power of 2).
+ * @param[in,out] arena    The arena, with at least karatsuba_scratch_size(n) elements free.
+ */
+template<typename RingType>
+void karatsuba(RingType* ret, const RingType* p1, const RingType* p2, std::size_t n,
+               NussbaumerArena<RingType>& arena) {
+  if(n == 1) {  // Base case for recursion, multiplication of constants
+    ret[0] = p1[0]*p2[0];
+    return;
+  }
+
+  std::size_t m = n/2;
+  assert((n & 1) == 0);
+
+  // The low halves are p1 and p2, the high halves start at m
+  std::size_t mark = arena.getUsed();
+  RingType* p1Sum = arena.allocate(m);
+  RingType* p2Sum = arena.allocate(m);
+  for(std::size_t i = 0; i < m; ++i) {
+    p1Sum[i] = p1[i] + p1[m + i];
+    p2Sum[i] = p2[i] + p2[m + i];
+  }
+
+  // (a + bx^m)(c + dx^m) = ac + [(a + b)(c + d) - ac - bd]x^m + bdx^{2m}, as above
+  RingType* ac = arena.allocate(2*m - 1);
+  RingType* bd = arena.allocate(2*m - 1);
+  RingType* prod = arena.allocate(2*m - 1);
+  karatsuba(ac, p1, p2, m, arena);
+  karatsuba(bd, p1 + m, p2 + m, m, arena);
+  karatsuba(prod, p1Sum, p2Sum, m, arena);
+
+  std::size_t from, to;
+  for(from = 0; from < 2*m - 1; ++from)
+    ret[from] = ac[from];
+  for(from = m, to = 2*m; from < 2*m - 1; ++from, ++to)
+    ret[to] = prod[from];
+  for(from = m, ++to; from < 2*m - 1; ++from, ++to)
+    ret[to] = bd[from];
+
+  for(from = 0, to = m; to < 2*m - 1; ++from, ++to)
+    ret[to] -= bd[from];
+  for(from = m, to = 2*m; from < 2*m - 1; ++from, ++to)
+    ret[to] -= ret[from];
+  ret[3*m - 1] = bd[m - 1];
+
+  for(from = 0, to = m; from < m - 1; ++from, ++to)
+    ret[to] += prod[from] - ac[from];
+  ret[2*m - 1] = prod[m - 1] - bd[m - 1] - ac[m - 1];
+
+  for(from = m, to = 2*m; from < 2*m - 1; ++from, ++to)
+    ret[to] -= bd[from];
+
+  arena.release(mark);
+}
+
+
+/**
+ * Get the number of arena elements that karatsuba_negacyclic with an arena needs: a copy of
+ * both polynomials, the full product and the scratch of karatsuba.
+ * @param[in] n      The n of X^n + 1 (a power of 2).
+ * @return    The number of elements.
+ */
+template<typename RingType>
+std::size_t karatsuba_negacyclic_scratch_size(std::size_t n) {
+  return 2*NussbaumerArena<RingType>::roundUp(n) + NussbaumerArena<RingType>::roundUp(2*n - 1) +
+         karatsuba_scratch_size<RingType>(n);
+}
+
+
+/**
+ * Multiply two polynomials modulo X^n + 1 with the Karatsuba method, like the other
+ * karatsuba_negacyclic, but taking all temporaries from the arena and writing the result in place.
+ * @param[in]     n        The n of X^n + 1, which is the size of both polynomials (a power of 2).
+ * @param[out]    ret      The negacyclic convolution of p1 and p2.
+ * @param[in]     p1       The first polynomial.
+ * @param[in]     p2       The second polynomial.
+ * @param[in,out] arena    The arena, with at least karatsuba_negacyclic_scratch_size(n) elements
+ *                         free.
+ */
+template<typename RingType>
+void karatsuba_negacyclic(std::size_t n, const PolynomialView<RingType>& ret,
+                          const ConstPolynomialView<RingType>& p1, const ConstPolynomialView<RingType>& p2,
+                          NussbaumerArena<RingType>& arena) {
+  assert(p1.getSize() == n);
+  std::size_t mark = arena.getUsed();
+  RingType* in1 = arena.allocate(n);
+  RingType* in2 = arena.allocate(n);
+  for(std::size_t i = 0; i < n; ++i) {
+    in1[i] = p1[i];
+    in2[i] = p2[i];
+  }
+
+  RingType* product = arena.allocate(2*n - 1);
+  karatsuba(product, in1, in2, n, arena);
+  for(std::size_t i = 0; i < n - 1; ++i)
+    ret[i] = product[i] - product[i + n];
+  ret[n - 1] = product[n - 1];
+  arena.release(mark);
+}
+
 #endif
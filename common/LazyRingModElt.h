@@ -0,0 +1,257 @@
+/**
+ * @file LazyRingModElt.h
+ * @author Gerben van der Lubbe
+ *
+ * File for storing elements in the ring Z/qZ, reducing modulo q only when needed.
+ */
+
+#ifndef LAZYRINGMODELT_H
+#define LAZYRINGMODELT_H
+
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+
+#include "Util.h"
+#include "OpCount.h"
+#include "DoubleWord.h"
+
+/**
+ * Class to deal with the ring Z/qZ, where q == Modulus, like RingModElt, but without reducing in
+ * its operations: the value is kept in a 64-bit integer, and additions, subtractions and
+ * multiplications are plain integer operations. It is only reduced modulo q by reduce(), and
+ * when it is read.
+ *
+ * Keeping the values in range is up to the algorithm, which knows statically how much they can
+ * grow: a reduced value is below 2^ModulusBits in absolute value, each addition or subtraction
+ * stage adds at most one bit, and a product has the bits of both factors; all must stay below 2^63.
+ * NegaNussbaumer does so through NussbaumerLazyRing, reducing only at the ends of the transforms
+ * and after the componentwise products, so its butterflies are plain additions. Reductions are
+ * counted as divisions.
+ */
+template<int Modulus, typename Counter = OpCount>
+class LazyRingModElt : public Multiplies<LazyRingModElt<Modulus, Counter>>,
+                       public Multiplies<LazyRingModElt<Modulus, Counter>, int>,
+                       public Adds<LazyRingModElt<Modulus, Counter>>,
+                       public Subtracts<LazyRingModElt<Modulus, Counter>>,
+                       public CompEquality<LazyRingModElt<Modulus, Counter>> {
+public:
+  static_assert(Modulus > 1 && Modulus < (1 << 30), "the modulus must fit in 30 bits");
+
+  /// The number of bits of a reduced value, in absolute value
+  static constexpr unsigned int ModulusBits = bitLength(Modulus - 1);
+
+  LazyRingModElt(std::int64_t value = 0);
+
+  int toInt() const;
+  void reduce();
+
+  const LazyRingModElt<Modulus, Counter>& operator+=(const LazyRingModElt<Modulus, Counter>& e);
+  const LazyRingModElt<Modulus, Counter>& operator-=(const LazyRingModElt<Modulus, Counter>& e);
+  const LazyRingModElt<Modulus, Counter>& operator*=(const LazyRingModElt<Modulus, Counter>& e);
+  const LazyRingModElt<Modulus, Counter>& operator*=(const int& e);
+
+  const LazyRingModElt<Modulus, Counter> operator-() const;
+
+  static bool getInverse(LazyRingModElt<Modulus, Counter>& inverse,
+                         const LazyRingModElt<Modulus, Counter>& value);
+
+  static Counter& getOpCount();
+  static void setOpCount(const Counter& opCount);
+
+private:
+  std::int64_t value_ = 0;
+  static Counter opCount_;
+};
+
+
+/**
+ * Write a LazyRingModElt to a stream.
+ * @param[in] out      The stream to write to.
+ * @param[in] e        The LazyRingModElt to write.
+ * @return    A reference to the stream.
+ */
+template<int Modulus, typename Counter>
+std::ostream& operator<<(std::ostream& out, const LazyRingModElt<Modulus, Counter>& e) {
+  out << e.toInt();
+  return out;
+}
+
+
+/**
+ * Keeps track of the number of operations performed on the ring.
+ */
+template<int Modulus, typename Counter>
+Counter LazyRingModElt<Modulus, Counter>::opCount_;
+
+
+/**
+ * Gets the counter for number of operations on the ring. This value is
+ * different for different Modulus.
+ * @return A reference to the counter.
+ */
+template<int Modulus, typename Counter>
+Counter& LazyRingModElt<Modulus, Counter>::getOpCount() {
+  return opCount_;
+}
+
+
+/**
+ * Update the operation counter to this value.
+ * @param[in] opCount  The number of operations at this time.
+ */
+template<int Modulus, typename Counter>
+void LazyRingModElt<Modulus, Counter>::setOpCount(const Counter& opCount) {
+  opCount_ = opCount;
+}
+
+
+template<int Modulus, typename Counter>
+constexpr unsigned int LazyRingModElt<Modulus, Counter>::ModulusBits;
+
+
+/**
+ * Create a ring element modulo the Modulus, with a specified integer value.
+ * @param[in] value   The initial value to set (must be in the ring).
+ */
+template<int Modulus, typename Counter>
+LazyRingModElt<Modulus, Counter>::LazyRingModElt(std::int64_t value)
+: value_(value)
+{}
+
+
+/**
+ * Convert the element to the integer value, reducing it; the result has the sign of the
+ * unreduced value, as for RingModElt.
+ * @return The integer value.
+ */
+template<int Modulus, typename Counter>
+int LazyRingModElt<Modulus, Counter>::toInt() const {
+  return static_cast<int>(value_ % Modulus);
+}
+
+
+/**
+ * Reduce the value modulo the Modulus, so that it is below 2^ModulusBits in absolute value again.
+ */
+template<int Modulus, typename Counter>
+void LazyRingModElt<Modulus, Counter>::reduce() {
+  value_ %= Modulus;
+  opCount_.countDivision();
+}
+
+
+/**
+ * Addition assignment operator for LazyRingModElt.
+ * @param[in] e        The value to add.
+ * @return    A reference to self.
+ */
+template<int Modulus, typename Counter>
+const LazyRingModElt<Modulus, Counter>& LazyRingModElt<Modulus, Counter>::operator+=(
+                                            const LazyRingModElt<Modulus, Counter>& e
+                                                                        ) {
+  value_ += e.value_;
+  opCount_.countAddition();
+  return *this;
+}
+
+
+/**
+ * Subtract-assignment from the LazyRingModElt.
+ * @param[in] e        The value to subtract.
+ * @return    A reference to self.
+ */
+template<int Modulus, typename Counter>
+const LazyRingModElt<Modulus, Counter>& LazyRingModElt<Modulus, Counter>::operator-=(
+                                            const LazyRingModElt<Modulus, Counter>& e
+                                                                        ) {
+  value_ -= e.value_;
+  opCount_.countAddition();
+  return *this;
+}
+
+
+/**
+ * Multiplication-assignment operator by another LazyRingModElt.
+ * @param[in] e        The LazyRingModElt value to multiply with.
+ * @return    A reference to self.
+ */
+template<int Modulus, typename Counter>
+const LazyRingModElt<Modulus, Counter>& LazyRingModElt<Modulus, Counter>::operator*=(
+                                            const LazyRingModElt<Modulus, Counter>& e
+                                                                        ) {
+  value_ *= e.value_;
+  opCount_.countMultiplication();
+  return *this;
+}
+
+
+/**
+ * Multiplication-assignment operator by a constant.
+ * @param[in] e        The constant value to multiply with.
+ * @return    A reference to self.
+ */
+template<int Modulus, typename Counter>
+const LazyRingModElt<Modulus, Counter>& LazyRingModElt<Modulus, Counter>::operator*=(
+                                                      const int& e
+                                                                        ) {
+  value_ *= e;
+  opCount_.countConstMult();
+  return *this;
+}
+
+
+/**
+ * Sign inversion operator for a LazyRingModElt (counted as an addition).
+ * @return   The value, sign-inverted.
+ */
+template<int Modulus, typename Counter>
+const LazyRingModElt<Modulus, Counter> LazyRingModElt<Modulus, Counter>::operator-() const {
+  LazyRingModElt<Modulus, Counter> ret(LazyRingModElt<Modulus, Counter>() - *this);
+  return ret;
+}
+
+
+/**
+ * Compare two LazyRingModElts for equality.
+ * @param[in] a        The first value to test.
+ * @param[in] b        The second value to test.
+ * @return    true iff the two are equal (using the modulus).
+ */
+template<int Modulus, typename Counter>
+bool operator==(const LazyRingModElt<Modulus, Counter>& a, const LazyRingModElt<Modulus, Counter>& b) {
+  // Modulo is still needed, as the reduced values may be negative or positive.
+  return (static_cast<std::int64_t>(a.toInt()) - b.toInt()) % Modulus == 0;
+}
+
+
+template<int Modulus, typename Counter>
+bool LazyRingModElt<Modulus, Counter>::getInverse(LazyRingModElt<Modulus, Counter>& inverse,
+                                                  const LazyRingModElt<Modulus, Counter>& value) {
+  // Use the extended Euclidian algorithm to get the inverse.
+  int t = 0;
+  int tNew = 1;
+  int r = Modulus;
+  int rNew = value.toInt();
+  while(rNew != 0) {
+    int q = r / rNew;
+    int tmp;
+
+    tmp = t - q*tNew;
+    t = tNew;
+    tNew = tmp;
+
+    tmp = r - q*rNew;
+    r = rNew;
+    rNew = tmp;
+  }
+
+  if(r > 1 || r < -1)
+    return false;
+
+  inverse = LazyRingModElt<Modulus, Counter>(r*t);
+  assert((static_cast<std::int64_t>(r*t)*value.toInt() - 1) % Modulus == 0);
+  return true;
+}
+
+#endif
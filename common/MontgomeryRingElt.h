@@ -0,0 +1,244 @@
+/**
+ * @file MontgomeryRingElt.h
+ * @author Gerben van der Lubbe
+ *
+ * File for storing elements in the ring Z/qZ in Montgomery form.
+ */
+
+#ifndef MONTGOMERYRINGELT_H
+#define MONTGOMERYRINGELT_H
+
+#include <iostream>
+#include <cstdint>
+
+#include "Util.h"
+#include "OpCount.h"
+#include "DoubleWord.h"
+
+/**
+ * Class to deal with the ring Z/qZ, where q == Modulus, using Montgomery multiplication. An
+ * element a is stored as a*R mod q in a Word, with R = 2^w and w the number of bits in a Word, so
+ * a product is reduced with two multiplications and a shift instead of a division. Word may be
+ * std::uint32_t (for q < 2^31) or std::uint64_t (for q < 2^63). The constants for the reduction
+ * are calculated at compile time.
+ *
+ * The interface and the operation counts are those of RingModElt. The NegaNussbaumer variants
+ * pass constants through an int, so these need q < 2^31.
+ */
+template<std::uint64_t Modulus, typename Word = std::uint32_t, typename Counter = OpCount>
+class MontgomeryRingElt : public Multiplies<MontgomeryRingElt<Modulus, Word, Counter>>,
+                          public Multiplies<MontgomeryRingElt<Modulus, Word, Counter>, int>,
+                          public Adds<MontgomeryRingElt<Modulus, Word, Counter>>,
+                          public Subtracts<MontgomeryRingElt<Modulus, Word, Counter>>,
+                          public CompEquality<MontgomeryRingElt<Modulus, Word, Counter>> {
+public:
+  static_assert(Modulus > 1 && Modulus % 2 == 1, "Montgomery reduction needs an odd modulus");
+  static_assert(bitLength(Modulus) < 8*sizeof(Word), "the modulus must leave one bit of the word free");
+
+  MontgomeryRingElt(std::int64_t value = 0);
+
+  std::int64_t toInt() const;
+
+  const MontgomeryRingElt<Modulus, Word, Counter>& operator+=(const MontgomeryRingElt<Modulus, Word, Counter>& e);
+  const MontgomeryRingElt<Modulus, Word, Counter>& operator-=(const MontgomeryRingElt<Modulus, Word, Counter>& e);
+  const MontgomeryRingElt<Modulus, Word, Counter>& operator*=(const MontgomeryRingElt<Modulus, Word, Counter>& e);
+  const MontgomeryRingElt<Modulus, Word, Counter>& operator*=(const int& e);
+
+  const MontgomeryRingElt<Modulus, Word, Counter> operator-() const;
+
+  static bool getInverse(MontgomeryRingElt<Modulus, Word, Counter>& inverse,
+                         const MontgomeryRingElt<Modulus, Word, Counter>& value);
+
+  static Counter& getOpCount();
+  static void setOpCount(const Counter& opCount);
+
+  friend bool operator==(const MontgomeryRingElt<Modulus, Word, Counter>& a,
+                         const MontgomeryRingElt<Modulus, Word, Counter>& b) {
+    // The Montgomery form is unique in [0, q).
+    return a.value_ == b.value_;
+  }
+
+private:
+  typedef typename DoubleWord<Word>::Type Wide;
+
+  /// -q^-1 mod R
+  static constexpr Word NegInverse = montgomeryNegInverse<Word>(Modulus);
+  /// R^2 mod q, to convert to Montgomery form
+  static constexpr Word RSquared = montgomeryRSquared<Word>(Modulus);
+
+  static Word reduce(Wide value);
+
+  Word value_ = 0;
+  static Counter opCount_;
+};
+
+
+/**
+ * Write a MontgomeryRingElt to a stream.
+ * @param[in] out      The stream to write to.
+ * @param[in] e        The MontgomeryRingElt to write.
+ * @return    A reference to the stream.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+std::ostream& operator<<(std::ostream& out, const MontgomeryRingElt<Modulus, Word, Counter>& e) {
+  out << e.toInt();
+  return out;
+}
+
+
+template<std::uint64_t Modulus, typename Word, typename Counter>
+constexpr Word MontgomeryRingElt<Modulus, Word, Counter>::NegInverse;
+
+template<std::uint64_t Modulus, typename Word, typename Counter>
+constexpr Word MontgomeryRingElt<Modulus, Word, Counter>::RSquared;
+
+
+/**
+ * Keeps track of the number of operations performed on the ring.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+Counter MontgomeryRingElt<Modulus, Word, Counter>::opCount_;
+
+
+/**
+ * Gets the counter for number of operations on the ring. This value is
+ * different for different Modulus.
+ * @return A reference to the counter.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+Counter& MontgomeryRingElt<Modulus, Word, Counter>::getOpCount() {
+  return opCount_;
+}
+
+
+/**
+ * Update the operation counter to this value.
+ * @param[in] opCount  The number of operations at this time.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+void MontgomeryRingElt<Modulus, Word, Counter>::setOpCount(const Counter& opCount) {
+  opCount_ = opCount;
+}
+
+
+/**
+ * Montgomery reduction: calculate value*R^-1 mod q.
+ * @param[in] value    The value to reduce, less than q*R.
+ * @return    The reduced value, in [0, q).
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+Word MontgomeryRingElt<Modulus, Word, Counter>::reduce(Wide value) {
+  // Add the multiple of q that makes the lower word 0; as q < R/2, this does not overflow.
+  Word m = static_cast<Word>(value)*NegInverse;
+  Word result = static_cast<Word>((value + static_cast<Wide>(m)*Modulus) >> (8*sizeof(Word)));
+  return result >= Modulus ? result - Modulus : result;
+}
+
+
+/**
+ * Create a ring element modulo the Modulus, with a specified integer value.
+ * @param[in] value   The initial value to set; it does not have to be reduced.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+MontgomeryRingElt<Modulus, Word, Counter>::MontgomeryRingElt(std::int64_t value)
+: value_(reduce(static_cast<Wide>(reduceSigned(value, Modulus))*RSquared))
+{}
+
+
+/**
+ * Convert the element of the used ring (Z/mZ where m = Modulus) to the integer
+ * value.
+ * @return The integer value, in [0, q).
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+std::int64_t MontgomeryRingElt<Modulus, Word, Counter>::toInt() const {
+  return static_cast<std::int64_t>(reduce(value_));
+}
+
+
+/**
+ * Addition assignment operator for MontgomeryRingElt.
+ * @param[in] e        The value to add.
+ * @return    A reference to self.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+const MontgomeryRingElt<Modulus, Word, Counter>& MontgomeryRingElt<Modulus, Word, Counter>::operator+=(
+                                            const MontgomeryRingElt<Modulus, Word, Counter>& e
+                                                                                              ) {
+  value_ += e.value_;
+  if(value_ >= Modulus)
+    value_ -= Modulus;
+  opCount_.countAddition();
+  return *this;
+}
+
+
+/**
+ * Subtract-assignment from the MontgomeryRingElt.
+ * @param[in] e        The value to subtract.
+ * @return    A reference to self.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+const MontgomeryRingElt<Modulus, Word, Counter>& MontgomeryRingElt<Modulus, Word, Counter>::operator-=(
+                                            const MontgomeryRingElt<Modulus, Word, Counter>& e
+                                                                                              ) {
+  value_ = value_ >= e.value_ ? value_ - e.value_ : value_ + (Modulus - e.value_);
+  opCount_.countAddition();
+  return *this;
+}
+
+
+/**
+ * Multiplication-assignment operator by another MontgomeryRingElt.
+ * @param[in] e        The MontgomeryRingElt value to multiply with.
+ * @return    A reference to self.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+const MontgomeryRingElt<Modulus, Word, Counter>& MontgomeryRingElt<Modulus, Word, Counter>::operator*=(
+                                            const MontgomeryRingElt<Modulus, Word, Counter>& e
+                                                                                              ) {
+  value_ = reduce(static_cast<Wide>(value_)*e.value_);
+  opCount_.countMultiplication();
+  return *this;
+}
+
+
+/**
+ * Multiplication-assignment operator by a constant.
+ * @param[in] e        The constant value to multiply with.
+ * @return    A reference to self.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+const MontgomeryRingElt<Modulus, Word, Counter>& MontgomeryRingElt<Modulus, Word, Counter>::operator*=(
+                                                      const int& e
+                                                                                              ) {
+  // Convert the constant to Montgomery form first; the reduction of the product removes one factor R.
+  value_ = reduce(static_cast<Wide>(value_)*MontgomeryRingElt<Modulus, Word, Counter>(e).value_);
+  opCount_.countConstMult();
+  return *this;
+}
+
+
+/**
+ * Sign inversion operator for a MontgomeryRingElt (counted as an addition).
+ * @return   The value, sign-inverted.
+ */
+template<std::uint64_t Modulus, typename Word, typename Counter>
+const MontgomeryRingElt<Modulus, Word, Counter> MontgomeryRingElt<Modulus, Word, Counter>::operator-() const {
+  MontgomeryRingElt<Modulus, Word, Counter> ret(MontgomeryRingElt<Modulus, Word, Counter>() - *this);
+  return ret;
+}
+
+
+template<std::uint64_t Modulus, typename Word, typename Counter>
+bool MontgomeryRingElt<Modulus, Word, Counter>::getInverse(MontgomeryRingElt<Modulus, Word, Counter>& inverse,
+                                                           const MontgomeryRingElt<Modulus, Word, Counter>& value) {
+  std::uint64_t inverseValue;
+  if(!inverseModulo(inverseValue, static_cast<std::uint64_t>(value.toInt()), Modulus))
+    return false;
+
+  inverse = MontgomeryRingElt<Modulus, Word, Counter>(static_cast<std::int64_t>(inverseValue));
+  return true;
+}
+
+#endif
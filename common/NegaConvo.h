@@ -42,4 +42,31 @@ auto naivemult_negacyclic(
 }
 
 
+/**
+ * Naive algorithm for calculating p1*p2 reduced modulo x^n - 1, the cyclic convolution. This can
+ * be used to double-check the result of CyclicNussbaumer.
+ * @param[in] n    The n in x^n - 1, the modulo to calculate the product in.
+ * @param[in] p1   The first polynomial.
+ * @param[in] p2   The second polynomial.
+ */
+template<typename RingElt>
+auto naivemult_cyclic(
+                 std::size_t n,
+                 const Polynomial<RingElt>& p1,
+                 const Polynomial<RingElt>& p2) {
+  assert(n > 0);
+
+  // Calculate the product polynomial
+  Polynomial<RingElt> product(p1);
+  product *= p2;
+
+  // X^i with i >= n is X^(i - n) modulo X^n - 1
+  for(std::size_t i = product.getSize() - 1; i >= n; --i)
+    product[i - n] += product[i];
+
+  product.setSize(n);
+  return product;
+}
+
+
 #endif
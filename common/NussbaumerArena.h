@@ -0,0 +1,144 @@
+/**
+ * @file NussbaumerArena.h
+ * @author Gerben van der Lubbe
+ *
+ * File containing a scratch memory arena for the recursion of Nussbaumer's algorithm.
+ */
+
+#ifndef NUSSBAUMERARENA_H
+#define NUSSBAUMERARENA_H
+
+#include <vector>
+#include <new>
+#include <cstddef>
+
+#include "PolynomialMatrix.h"
+
+/**
+ * A block of ring elements, allocated once, that is handed out in pieces from the front. The
+ * pieces are freed in the reverse order of allocation, by releasing back to a mark of getUsed();
+ * as every level of the recursion releases what it took before returning, the deepest chain of
+ * levels is all that is in use at once. reset() frees everything.
+ *
+ * Each piece starts on a cache line if the size of RingElt divides 64.
+ */
+template<typename RingElt>
+class NussbaumerArena {
+public:
+  NussbaumerArena(std::size_t capacity = 0);
+
+  RingElt* allocate(std::size_t count);
+  void release(std::size_t used);
+  void reset();
+
+  std::size_t getUsed() const;
+  std::size_t getPeak() const;
+  std::size_t getCapacity() const;
+
+  static std::size_t roundUp(std::size_t count);
+
+private:
+  /// The number of elements in a cache line, or 1 if they do not fit exactly
+  static constexpr std::size_t Granule = 64 % sizeof(RingElt) == 0 ? 64 / sizeof(RingElt) : 1;
+
+  std::vector<RingElt, AlignedAllocator<RingElt>> storage_;
+  std::size_t used_ = 0;
+  std::size_t peak_ = 0;
+};
+
+
+template<typename RingElt>
+constexpr std::size_t NussbaumerArena<RingElt>::Granule;
+
+
+/**
+ * Create an arena; this is its only allocation.
+ * @param[in] capacity   The number of elements in the arena, as computed with roundUp for each
+ *                       piece (see NegaNussbaumer::getScratchSize).
+ */
+template<typename RingElt>
+NussbaumerArena<RingElt>::NussbaumerArena(std::size_t capacity)
+: storage_(capacity, RingElt())
+{}
+
+
+/**
+ * Take a piece of the arena. The elements are not reset; they hold whatever was last stored.
+ * @param[in] count    The number of elements.
+ * @return    The first element of the piece.
+ */
+template<typename RingElt>
+RingElt* NussbaumerArena<RingElt>::allocate(std::size_t count) {
+  std::size_t size = roundUp(count);
+  if(size > storage_.size() - used_)
+    throw std::bad_alloc();
+
+  RingElt* ret = storage_.data() + used_;
+  used_ += size;
+  if(used_ > peak_)
+    peak_ = used_;
+  return ret;
+}
+
+
+/**
+ * Free all pieces allocated since getUsed() returned the given value.
+ * @param[in] used     The earlier value of getUsed().
+ */
+template<typename RingElt>
+void NussbaumerArena<RingElt>::release(std::size_t used) {
+  assert(used <= used_);
+  used_ = used;
+}
+
+
+/**
+ * Free all pieces at once.
+ */
+template<typename RingElt>
+void NussbaumerArena<RingElt>::reset() {
+  used_ = 0;
+}
+
+
+/**
+ * Get the number of elements in use, to release() back to later.
+ * @return The number of elements in use.
+ */
+template<typename RingElt>
+std::size_t NussbaumerArena<RingElt>::getUsed() const {
+  return used_;
+}
+
+
+/**
+ * Get the largest number of elements that has been in use at once.
+ * @return The peak use.
+ */
+template<typename RingElt>
+std::size_t NussbaumerArena<RingElt>::getPeak() const {
+  return peak_;
+}
+
+
+/**
+ * Get the number of elements in the arena.
+ * @return The capacity.
+ */
+template<typename RingElt>
+std::size_t NussbaumerArena<RingElt>::getCapacity() const {
+  return storage_.size();
+}
+
+
+/**
+ * Get the number of elements that allocate(count) takes from the arena.
+ * @param[in] count    The number of elements asked for.
+ * @return    count, rounded up to whole cache lines.
+ */
+template<typename RingElt>
+std::size_t NussbaumerArena<RingElt>::roundUp(std::size_t count) {
+  return (count + Granule - 1) / Granule * Granule;
+}
+
+#endif
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+
+#include "NussbaumerWisdom.h"
+
+/**
+ * Get the wisdom used by NegaNussbaumer. On the first call, it is loaded from the file named by
+ * the environment variable NUSSBAUMER_WISDOM, if set.
+ * @return   A reference to the global wisdom.
+ */
+NussbaumerWisdom& NussbaumerWisdom::global() {
+  static NussbaumerWisdom wisdom = [] {
+    NussbaumerWisdom ret;
+    const char* filename = std::getenv("NUSSBAUMER_WISDOM");
+    if(filename != nullptr && !ret.load(filename))
+      std::cerr << "Failed to load Nussbaumer wisdom from " << filename << std::endl;
+    return ret;
+  }();
+  return wisdom;
+}
+
+
+/**
+ * Look up the split for a multiplication.
+ * @param[in]  ring       The name of the ring type.
+ * @param[in]  N          The size of the multiplication.
+ * @param[in]  cutoff     The recursion cutoff.
+ * @param[in]  baseCase   The base case multiplication, as an integer.
+ * @param[out] lgM        The best log_2 m, if known.
+ * @return     Whether the split is known.
+ */
+bool NussbaumerWisdom::lookup(const char* ring, std::size_t N, std::size_t cutoff, int baseCase,
+                              std::size_t& lgM) const {
+  auto it = plans_.find(std::make_tuple(ring, N, cutoff, baseCase));
+  if(it == plans_.end())
+    return false;
+
+  lgM = it->second;
+  return true;
+}
+
+
+/**
+ * Store the split for a multiplication, replacing the old one.
+ * @param[in] ring       The name of the ring type.
+ * @param[in] N          The size of the multiplication.
+ * @param[in] cutoff     The recursion cutoff.
+ * @param[in] baseCase   The base case multiplication, as an integer.
+ * @param[in] lgM        The best log_2 m.
+ */
+void NussbaumerWisdom::set(const std::string& ring, std::size_t N, std::size_t cutoff, int baseCase,
+                           std::size_t lgM) {
+  plans_[Key(ring, N, cutoff, baseCase)] = lgM;
+}
+
+
+/**
+ * Forget all splits.
+ */
+void NussbaumerWisdom::clear() {
+  plans_.clear();
+}
+
+
+/**
+ * Add the splits in a file, replacing known ones. A split that NegaNussbaumer cannot use (N not a
+ * power of two, or log_2 m not in 1..log_2(N)/2) makes the file invalid; the splits before it are
+ * kept.
+ * @param[in] filename   The file to read.
+ * @return    Whether the file could be read and parsed completely, with only valid splits.
+ */
+bool NussbaumerWisdom::load(const std::string& filename) {
+  std::ifstream in(filename);
+  if(!in)
+    return false;
+
+  std::string ring;
+  std::size_t N, cutoff, lgM;
+  int baseCase;
+  while(in >> ring >> N >> cutoff >> baseCase >> lgM) {
+    std::size_t lgN = 0;
+    while(lgN < 8*sizeof(std::size_t) - 1 && (std::size_t(1) << lgN) < N)
+      ++lgN;
+    if(N < 2 || (std::size_t(1) << lgN) != N || lgM < 1 || lgM > (lgN >> 1))
+      return false;
+    set(ring, N, cutoff, baseCase, lgM);
+  }
+
+  return in.eof();
+}
+
+
+/**
+ * Write all splits to a file.
+ * @param[in] filename   The file to write.
+ * @return    Whether the file was written.
+ */
+bool NussbaumerWisdom::save(const std::string& filename) const {
+  std::ofstream out(filename);
+  for(const auto& plan : plans_) {
+    out << std::get<0>(plan.first) << " " << std::get<1>(plan.first) << " " << std::get<2>(plan.first)
+        << " " << std::get<3>(plan.first) << " " << plan.second << "\n";
+  }
+  return static_cast<bool>(out);
+}
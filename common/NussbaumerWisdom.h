@@ -0,0 +1,44 @@
+/**
+ * @file NussbaumerWisdom.h
+ * @author Gerben van der Lubbe
+ *
+ * File to store the measured best splits N = m*r of Nussbaumer's algorithm.
+ */
+
+#ifndef NUSSBAUMERWISDOM_H
+#define NUSSBAUMERWISDOM_H
+
+#include <string>
+#include <map>
+#include <tuple>
+#include <functional>
+#include <cstddef>
+
+/**
+ * The best log_2 m for each ring type, N, recursion cutoff and base case, as measured on this host
+ * by an autotuner (see NussbaumerAutotune.h). Like FFTW's wisdom, it can be saved to and loaded
+ * from a file; the file is only meaningful on the host and build it was measured with. Each line
+ * holds the ring, N, the cutoff, the base case and log_2 m, separated by spaces.
+ *
+ * NegaNussbaumer looks its split up in the global wisdom, which is loaded from the file named by
+ * the environment variable NUSSBAUMER_WISDOM on first use, if it is set.
+ */
+class NussbaumerWisdom {
+public:
+  static NussbaumerWisdom& global();
+
+  bool lookup(const char* ring, std::size_t N, std::size_t cutoff, int baseCase, std::size_t& lgM) const;
+  void set(const std::string& ring, std::size_t N, std::size_t cutoff, int baseCase, std::size_t lgM);
+  void clear();
+
+  bool load(const std::string& filename);
+  bool save(const std::string& filename) const;
+
+private:
+  typedef std::tuple<std::string, std::size_t, std::size_t, int> Key;
+
+  // Compare transparently, so that a lookup does not construct (and allocate) a string
+  std::map<Key, std::size_t, std::less<>> plans_;
+};
+
+#endif
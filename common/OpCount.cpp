@@ -125,3 +125,15 @@ std::ostream& operator<<(std::ostream& oss, const OpCount& opCount) {
       << opCount.getNumBitwise() << " bitwise";
   return oss;
 }
+
+
+/**
+ * Write a NoOpCount to a stream; as nothing was counted, this just says so.
+ * @param[in] oss      The output stream to write to.
+ * @param[in] opCount  The (empty) operation count.
+ * @return    A reference to the stream.
+ */
+std::ostream& operator<<(std::ostream& oss, const NoOpCount& opCount) {
+  oss << "operations not counted";
+  return oss;
+}
@@ -43,4 +43,30 @@ public:
 
 std::ostream& operator<<(std::ostream& oss, const OpCount& opCount);
 
+
+/**
+ * Drop-in replacement for OpCount that counts nothing. Its functions are empty and inline, so a
+ * ring using it pays nothing for the counting.
+ */
+class NoOpCount {
+public:
+  NoOpCount reset() { return NoOpCount(); }
+
+  void countAddition() {}
+  void countMultiplication() {}
+  void countConstMult() {}
+  void countDivision() {}
+  void countShift() {}
+  void countBitwise() {}
+
+  std::size_t getNumAdditions() const { return 0; }
+  std::size_t getNumMultiplications() const { return 0; }
+  std::size_t getNumConstMults() const { return 0; }
+  std::size_t getNumDivisions() const { return 0; }
+  std::size_t getNumShifts() const { return 0; }
+  std::size_t getNumBitwise() const { return 0; }
+};
+
+std::ostream& operator<<(std::ostream& oss, const NoOpCount& opCount);
+
 #endif
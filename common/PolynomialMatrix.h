@@ -0,0 +1,459 @@
+/**
+ * @file PolynomialMatrix.h
+ * @author Gerben van der Lubbe
+ *
+ * Flat storage for a list of polynomials of equal size, such as the transformed polynomials of
+ * Nussbaumer's algorithm. All coefficients are stored in a single aligned, row-major block; rows
+ * and columns are accessed through views that behave like a Polynomial without owning memory.
+ */
+
+#ifndef POLYNOMIALMATRIX_H
+#define POLYNOMIALMATRIX_H
+
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "Polynomial.h"
+
+/**
+ * Allocator returning memory aligned to Alignment bytes, so the rows of a matrix start on a
+ * cache line. The memory comes from operator new, so replacing it (to count allocations, say)
+ * covers these too; the distance to the start of the allocation is stored in the byte before the
+ * aligned block.
+ */
+template<typename T, std::size_t Alignment = 64>
+class AlignedAllocator {
+public:
+  static_assert(Alignment > 0 && Alignment <= 128 && (Alignment & (Alignment - 1)) == 0,
+                "the alignment must be a power of 2 of at most 128");
+
+  typedef T value_type;
+
+  template<typename U>
+  struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+  AlignedAllocator() = default;
+
+  template<typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+  T* allocate(std::size_t count) {
+    unsigned char* raw = static_cast<unsigned char*>(::operator new(count*sizeof(T) + Alignment));
+    std::size_t offset = Alignment - reinterpret_cast<std::uintptr_t>(raw) % Alignment;
+    raw[offset - 1] = static_cast<unsigned char>(offset);
+    return reinterpret_cast<T*>(raw + offset);
+  }
+
+  void deallocate(T* ptr, std::size_t) {
+    unsigned char* aligned = reinterpret_cast<unsigned char*>(ptr);
+    ::operator delete(aligned - aligned[-1]);
+  }
+
+  template<typename U>
+  bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+
+  template<typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+
+/**
+ * A read-only view of size coefficients, stride elements apart. Arithmetic on views returns a
+ * new Polynomial.
+ */
+template<typename RingElt>
+class ConstPolynomialView {
+public:
+  ConstPolynomialView(const RingElt* data, std::size_t size, std::size_t stride = 1);
+  ConstPolynomialView(const Polynomial<RingElt>& pol);
+
+  std::size_t getSize() const;
+  const RingElt& operator[](std::size_t index) const;
+
+  operator Polynomial<RingElt>() const;
+
+  friend Polynomial<RingElt> operator+(const ConstPolynomialView& a, const ConstPolynomialView& b) {
+    Polynomial<RingElt> ret(a);
+    for(std::size_t i = 0; i < ret.getSize(); ++i)
+      ret[i] += b[i];
+    return ret;
+  }
+
+  friend Polynomial<RingElt> operator-(const ConstPolynomialView& a, const ConstPolynomialView& b) {
+    Polynomial<RingElt> ret(a);
+    for(std::size_t i = 0; i < ret.getSize(); ++i)
+      ret[i] -= b[i];
+    return ret;
+  }
+
+  friend Polynomial<RingElt> operator-(const ConstPolynomialView& a) {
+    return -Polynomial<RingElt>(a);
+  }
+
+  friend bool operator==(const ConstPolynomialView& a, const ConstPolynomialView& b) {
+    if(a.getSize() != b.getSize())
+      return false;
+    for(std::size_t i = 0; i < a.getSize(); ++i)
+      if(a[i] != b[i])
+        return false;
+    return true;
+  }
+
+  friend bool operator!=(const ConstPolynomialView& a, const ConstPolynomialView& b) {
+    return !(a == b);
+  }
+
+protected:
+  RingElt* mutableData() const;
+
+private:
+  const RingElt* data_;
+  std::size_t size_, stride_;
+};
+
+
+/**
+ * A view of size coefficients, stride elements apart, that can be written. Assigning to it
+ * copies the coefficients into the viewed memory; the sizes must match.
+ */
+template<typename RingElt>
+class PolynomialView : public ConstPolynomialView<RingElt> {
+public:
+  PolynomialView(RingElt* data, std::size_t size, std::size_t stride = 1);
+
+  using ConstPolynomialView<RingElt>::getSize;
+  RingElt& operator[](std::size_t index) const;
+
+  const PolynomialView& operator=(const PolynomialView& other) const;
+  const PolynomialView& operator=(const ConstPolynomialView<RingElt>& other) const;
+
+  const PolynomialView& operator+=(const ConstPolynomialView<RingElt>& other) const;
+  const PolynomialView& operator-=(const ConstPolynomialView<RingElt>& other) const;
+
+  template<typename OtherT>
+  const PolynomialView& operator*=(const OtherT& scalar) const;
+};
+
+
+/**
+ * A rows x cols matrix of ring elements in one contiguous, aligned block. Row i holds the
+ * coefficients of polynomial i. The block is either owned, or borrowed from the caller (such as
+ * a NussbaumerArena); a copy always owns its block.
+ */
+template<typename RingElt>
+class PolynomialMatrix {
+public:
+  PolynomialMatrix(std::size_t rows = 0, std::size_t cols = 0);
+  PolynomialMatrix(RingElt* data, std::size_t rows, std::size_t cols);
+
+  PolynomialMatrix(const PolynomialMatrix& other);
+  PolynomialMatrix(PolynomialMatrix&& other) = default;
+  PolynomialMatrix& operator=(const PolynomialMatrix& other);
+  PolynomialMatrix& operator=(PolynomialMatrix&& other) = default;
+
+  std::size_t getNumRows() const;
+  std::size_t getNumCols() const;
+
+  PolynomialView<RingElt> operator[](std::size_t row);
+  ConstPolynomialView<RingElt> operator[](std::size_t row) const;
+
+  PolynomialView<RingElt> column(std::size_t col);
+  ConstPolynomialView<RingElt> column(std::size_t col) const;
+
+  void swapRows(std::size_t row1, std::size_t row2);
+
+private:
+  std::size_t rows_, cols_;
+  std::vector<RingElt, AlignedAllocator<RingElt>> coefs_;
+  RingElt* data_;           //!< coefs_.data(), or the borrowed block
+};
+
+
+/**
+ * Create a view of memory.
+ * @param[in] data     The first coefficient.
+ * @param[in] size     The number of coefficients.
+ * @param[in] stride   The distance between two coefficients, in elements.
+ */
+template<typename RingElt>
+ConstPolynomialView<RingElt>::ConstPolynomialView(const RingElt* data, std::size_t size, std::size_t stride)
+: data_(data), size_(size), stride_(stride)
+{}
+
+
+/**
+ * Create a view of the coefficients of a polynomial. The polynomial must not be resized while
+ * the view is in use.
+ * @param[in] pol      The polynomial.
+ */
+template<typename RingElt>
+ConstPolynomialView<RingElt>::ConstPolynomialView(const Polynomial<RingElt>& pol)
+: data_(pol.getSize() ? &pol[0] : nullptr), size_(pol.getSize()), stride_(1)
+{}
+
+
+/**
+ * Get the number of coefficients in the view.
+ * @return The size.
+ */
+template<typename RingElt>
+std::size_t ConstPolynomialView<RingElt>::getSize() const {
+  return size_;
+}
+
+
+/**
+ * Get a coefficient.
+ * @param[in] index   The index of the coefficient (0 <= index < getSize())
+ * @return    The coefficient.
+ */
+template<typename RingElt>
+const RingElt& ConstPolynomialView<RingElt>::operator[](std::size_t index) const {
+  assert(index < size_);
+  return data_[index*stride_];
+}
+
+
+/**
+ * Copy the viewed coefficients into a new polynomial.
+ * @return The polynomial.
+ */
+template<typename RingElt>
+ConstPolynomialView<RingElt>::operator Polynomial<RingElt>() const {
+  Polynomial<RingElt> ret(size_);
+  for(std::size_t i = 0; i < size_; ++i)
+    ret[i] = (*this)[i];
+  return ret;
+}
+
+
+/**
+ * Get the viewed memory for writing, for PolynomialView, which is only created from writable
+ * memory.
+ * @return The first coefficient.
+ */
+template<typename RingElt>
+RingElt* ConstPolynomialView<RingElt>::mutableData() const {
+  return const_cast<RingElt*>(data_);
+}
+
+
+/**
+ * Create a writable view of memory.
+ * @param[in] data     The first coefficient.
+ * @param[in] size     The number of coefficients.
+ * @param[in] stride   The distance between two coefficients, in elements.
+ */
+template<typename RingElt>
+PolynomialView<RingElt>::PolynomialView(RingElt* data, std::size_t size, std::size_t stride)
+: ConstPolynomialView<RingElt>(data, size, stride)
+{}
+
+
+/**
+ * Get a coefficient for writing.
+ * @param[in] index   The index of the coefficient (0 <= index < getSize())
+ * @return    The coefficient.
+ */
+template<typename RingElt>
+RingElt& PolynomialView<RingElt>::operator[](std::size_t index) const {
+  return const_cast<RingElt&>(ConstPolynomialView<RingElt>::operator[](index));
+}
+
+
+/**
+ * Copy the coefficients of another view into this one.
+ * @param[in] other   The view to copy; it must have the same size.
+ * @return    A reference to this view.
+ */
+template<typename RingElt>
+const PolynomialView<RingElt>& PolynomialView<RingElt>::operator=(const PolynomialView<RingElt>& other) const {
+  return *this = static_cast<const ConstPolynomialView<RingElt>&>(other);
+}
+
+
+/**
+ * Copy coefficients into the view; a Polynomial converts to a view, so it can be assigned too.
+ * @param[in] other   The coefficients to copy; they must have the same size.
+ * @return    A reference to this view.
+ */
+template<typename RingElt>
+const PolynomialView<RingElt>& PolynomialView<RingElt>::operator=(const ConstPolynomialView<RingElt>& other) const {
+  assert(other.getSize() == getSize());
+  for(std::size_t i = 0; i < getSize(); ++i)
+    (*this)[i] = other[i];
+  return *this;
+}
+
+
+/**
+ * Add other coefficients to the viewed ones.
+ * @param[in] other   The coefficients to add; they must have the same size.
+ * @return    A reference to this view.
+ */
+template<typename RingElt>
+const PolynomialView<RingElt>& PolynomialView<RingElt>::operator+=(const ConstPolynomialView<RingElt>& other) const {
+  assert(other.getSize() == getSize());
+  for(std::size_t i = 0; i < getSize(); ++i)
+    (*this)[i] += other[i];
+  return *this;
+}
+
+
+/**
+ * Subtract other coefficients from the viewed ones.
+ * @param[in] other   The coefficients to subtract; they must have the same size.
+ * @return    A reference to this view.
+ */
+template<typename RingElt>
+const PolynomialView<RingElt>& PolynomialView<RingElt>::operator-=(const ConstPolynomialView<RingElt>& other) const {
+  assert(other.getSize() == getSize());
+  for(std::size_t i = 0; i < getSize(); ++i)
+    (*this)[i] -= other[i];
+  return *this;
+}
+
+
+/**
+ * Multiply the viewed coefficients by a scalar.
+ * @param[in] scalar   The scalar to multiply with.
+ * @return    A reference to this view.
+ */
+template<typename RingElt> template<typename OtherT>
+const PolynomialView<RingElt>& PolynomialView<RingElt>::operator*=(const OtherT& scalar) const {
+  for(std::size_t i = 0; i < getSize(); ++i)
+    (*this)[i] *= scalar;
+  return *this;
+}
+
+
+/**
+ * Create a matrix with all coefficients 0, in a single allocation.
+ * @param[in] rows    The number of polynomials.
+ * @param[in] cols    The number of coefficients of each polynomial.
+ */
+template<typename RingElt>
+PolynomialMatrix<RingElt>::PolynomialMatrix(std::size_t rows, std::size_t cols)
+: rows_(rows), cols_(cols), coefs_(rows*cols, RingElt()), data_(coefs_.data())
+{}
+
+
+/**
+ * Create a matrix in memory owned by the caller, which must outlive it. The coefficients are
+ * not initialized.
+ * @param[in] data    The block of rows*cols coefficients.
+ * @param[in] rows    The number of polynomials.
+ * @param[in] cols    The number of coefficients of each polynomial.
+ */
+template<typename RingElt>
+PolynomialMatrix<RingElt>::PolynomialMatrix(RingElt* data, std::size_t rows, std::size_t cols)
+: rows_(rows), cols_(cols), data_(data)
+{}
+
+
+/**
+ * Copy a matrix into a block owned by the copy.
+ * @param[in] other   The matrix to copy.
+ */
+template<typename RingElt>
+PolynomialMatrix<RingElt>::PolynomialMatrix(const PolynomialMatrix& other)
+: rows_(other.rows_), cols_(other.cols_), coefs_(other.data_, other.data_ + other.rows_*other.cols_),
+  data_(coefs_.data())
+{}
+
+
+/**
+ * Replace the matrix with a copy of another, in a block owned by this matrix.
+ * @param[in] other   The matrix to copy.
+ * @return    A reference to this matrix.
+ */
+template<typename RingElt>
+PolynomialMatrix<RingElt>& PolynomialMatrix<RingElt>::operator=(const PolynomialMatrix& other) {
+  if(this != &other)
+    *this = PolynomialMatrix<RingElt>(other);
+  return *this;
+}
+
+
+/**
+ * Get the number of rows, or polynomials.
+ * @return The number of rows.
+ */
+template<typename RingElt>
+std::size_t PolynomialMatrix<RingElt>::getNumRows() const {
+  return rows_;
+}
+
+
+/**
+ * Get the number of columns, or coefficients per polynomial.
+ * @return The number of columns.
+ */
+template<typename RingElt>
+std::size_t PolynomialMatrix<RingElt>::getNumCols() const {
+  return cols_;
+}
+
+
+/**
+ * Get a row of the matrix, which is contiguous.
+ * @param[in] row     The row (0 <= row < getNumRows())
+ * @return    A view of the row.
+ */
+template<typename RingElt>
+PolynomialView<RingElt> PolynomialMatrix<RingElt>::operator[](std::size_t row) {
+  assert(row < rows_);
+  return PolynomialView<RingElt>(data_ + row*cols_, cols_);
+}
+
+
+/**
+ * Get a row of the matrix, which is contiguous.
+ * @param[in] row     The row (0 <= row < getNumRows())
+ * @return    A read-only view of the row.
+ */
+template<typename RingElt>
+ConstPolynomialView<RingElt> PolynomialMatrix<RingElt>::operator[](std::size_t row) const {
+  assert(row < rows_);
+  return ConstPolynomialView<RingElt>(data_ + row*cols_, cols_);
+}
+
+
+/**
+ * Get a column of the matrix: coefficient col of every polynomial, getNumCols() elements apart.
+ * @param[in] col     The column (0 <= col < getNumCols())
+ * @return    A view of the column.
+ */
+template<typename RingElt>
+PolynomialView<RingElt> PolynomialMatrix<RingElt>::column(std::size_t col) {
+  assert(col < cols_);
+  return PolynomialView<RingElt>(data_ + col, rows_, cols_);
+}
+
+
+/**
+ * Get a column of the matrix: coefficient col of every polynomial, getNumCols() elements apart.
+ * @param[in] col     The column (0 <= col < getNumCols())
+ * @return    A read-only view of the column.
+ */
+template<typename RingElt>
+ConstPolynomialView<RingElt> PolynomialMatrix<RingElt>::column(std::size_t col) const {
+  assert(col < cols_);
+  return ConstPolynomialView<RingElt>(data_ + col, rows_, cols_);
+}
+
+
+/**
+ * Exchange the coefficients of two rows.
+ * @param[in] row1    The first row.
+ * @param[in] row2    The second row.
+ */
+template<typename RingElt>
+void PolynomialMatrix<RingElt>::swapRows(std::size_t row1, std::size_t row2) {
+  for(std::size_t i = 0; i < cols_; ++i)
+    std::swap(data_[row1*cols_ + i], data_[row2*cols_ + i]);
+}
+
+#endif
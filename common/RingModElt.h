@@ -10,51 +10,66 @@
 
 #include <iostream>
 #include <cassert>
+#include <cstdint>
+#include <type_traits>
 
 #include "Util.h"
 #include "OpCount.h"
 
 /**
  * Class to deal with the ring Z/qZ, where q == Modulus.
+ * The operations are counted in a Counter: OpCount for analysis, or NoOpCount to leave the
+ * counting out entirely (see UncountedRingModElt).
+ *
+ * The value is stored in an int, in (-q, q). For q of more than 15 bits, products (and for
+ * q >= 2^30, sums) are calculated in 64 bits before they are reduced.
  */
-template<int Modulus>
-class RingModElt : public Multiplies<RingModElt<Modulus>>,
-                   public Multiplies<RingModElt<Modulus>, int>,
-                   public Adds<RingModElt<Modulus>>,
-                   public Subtracts<RingModElt<Modulus>>,
-                   public CompEquality<RingModElt<Modulus>> {
+template<int Modulus, typename Counter = OpCount>
+class RingModElt : public Multiplies<RingModElt<Modulus, Counter>>,
+                   public Multiplies<RingModElt<Modulus, Counter>, int>,
+                   public Adds<RingModElt<Modulus, Counter>>,
+                   public Subtracts<RingModElt<Modulus, Counter>>,
+                   public CompEquality<RingModElt<Modulus, Counter>> {
 public:
   RingModElt(int value = 0);
 
   int toInt() const;
 
-  const RingModElt<Modulus>& operator+=(const RingModElt<Modulus>& e);
-  const RingModElt<Modulus>& operator-=(const RingModElt<Modulus>& e);
-  const RingModElt<Modulus>& operator*=(const RingModElt<Modulus>& e);
-  const RingModElt<Modulus>& operator*=(const int& e);
+  const RingModElt<Modulus, Counter>& operator+=(const RingModElt<Modulus, Counter>& e);
+  const RingModElt<Modulus, Counter>& operator-=(const RingModElt<Modulus, Counter>& e);
+  const RingModElt<Modulus, Counter>& operator*=(const RingModElt<Modulus, Counter>& e);
+  const RingModElt<Modulus, Counter>& operator*=(const int& e);
 
-  const RingModElt<Modulus> operator-() const;
+  const RingModElt<Modulus, Counter> operator-() const;
 
-  static bool getInverse(RingModElt<Modulus>& inverse,
-                         const RingModElt<Modulus>& value);
+  static bool getInverse(RingModElt<Modulus, Counter>& inverse,
+                         const RingModElt<Modulus, Counter>& value);
 
-  static OpCount& getOpCount();
-  static void setOpCount(const OpCount& opCount);
+  static Counter& getOpCount();
+  static void setOpCount(const Counter& opCount);
 
 private:
+  /// The type to calculate in: int if the product of two values fits in it
+  typedef typename std::conditional<(Modulus > 46340), std::int64_t, int>::type Wide;
+
   int value_ = 0;
-  static OpCount opCount_;
+  static Counter opCount_;
 };
 
 
+/// RingModElt without operation counting, for when only the result and the speed matter.
+template<int Modulus>
+using UncountedRingModElt = RingModElt<Modulus, NoOpCount>;
+
+
 /**
  * Write a RingModElt to a stream.
  * @param[in] out      The stream to write to.
  * @param[in] e        The RingModElt to write.
  * @return    A reference to the stream.
  */
-template<int Modulus>
-std::ostream& operator<<(std::ostream& out, const RingModElt<Modulus>& e) {
+template<int Modulus, typename Counter>
+std::ostream& operator<<(std::ostream& out, const RingModElt<Modulus, Counter>& e) {
   out << e.toInt();
   return out;
 }
@@ -63,8 +78,8 @@ std::ostream& operator<<(std::ostream& out, const RingModElt<Modulus>& e) {
 /**
  * Keeps track of the number of operations performed on the ring.
  */
-template<int Modulus>
-OpCount RingModElt<Modulus>::opCount_;
+template<int Modulus, typename Counter>
+Counter RingModElt<Modulus, Counter>::opCount_;
 
 
 /**
@@ -72,8 +87,8 @@ OpCount RingModElt<Modulus>::opCount_;
  * different for different Modulus.
  * @return A reference to the OpCount class.
  */
-template<int Modulus>
-OpCount& RingModElt<Modulus>::getOpCount() {
+template<int Modulus, typename Counter>
+Counter& RingModElt<Modulus, Counter>::getOpCount() {
   return opCount_;
 }
 
@@ -82,8 +97,8 @@ OpCount& RingModElt<Modulus>::getOpCount() {
  * Update the operation counter to this value.
  * @param[in] opCount  The number of operations at this time.
  */
-template<int Modulus>
-void RingModElt<Modulus>::setOpCount(const OpCount& opCount) {
+template<int Modulus, typename Counter>
+void RingModElt<Modulus, Counter>::setOpCount(const Counter& opCount) {
   opCount_ = opCount;
 }
 
@@ -92,8 +107,8 @@ void RingModElt<Modulus>::setOpCount(const OpCount& opCount) {
  * Create a ring element modulo the Modulus, with a specified integer value.
  * @param[in] value   The initial value to set (must be in the ring).
  */
-template<int Modulus>
-RingModElt<Modulus>::RingModElt(int value)
+template<int Modulus, typename Counter>
+RingModElt<Modulus, Counter>::RingModElt(int value)
 : value_(value)
 {}
 
@@ -103,8 +118,8 @@ RingModElt<Modulus>::RingModElt(int value)
  * value.
  * @return The integer value.
  */
-template<int Modulus>
-int RingModElt<Modulus>::toInt() const {
+template<int Modulus, typename Counter>
+int RingModElt<Modulus, Counter>::toInt() const {
   return value_;
 }
 
@@ -114,11 +129,11 @@ int RingModElt<Modulus>::toInt() const {
  * @param[in] e        The value to add.
  * @return    A reference to self.
  */
-template<int Modulus>
-const RingModElt<Modulus>& RingModElt<Modulus>::operator+=(
-                                            const RingModElt<Modulus>& e
+template<int Modulus, typename Counter>
+const RingModElt<Modulus, Counter>& RingModElt<Modulus, Counter>::operator+=(
+                                            const RingModElt<Modulus, Counter>& e
                                                             ) {
-  value_ = (value_ + e.value_) % Modulus;
+  value_ = static_cast<int>((static_cast<Wide>(value_) + e.value_) % Modulus);
   opCount_.countAddition();
   return *this;
 }
@@ -129,11 +144,11 @@ const RingModElt<Modulus>& RingModElt<Modulus>::operator+=(
  * @param[in] e        The value to subtract.
  * @return    A reference to self.
  */
-template<int Modulus>
-const RingModElt<Modulus>& RingModElt<Modulus>::operator-=(
-                                            const RingModElt<Modulus>& e
+template<int Modulus, typename Counter>
+const RingModElt<Modulus, Counter>& RingModElt<Modulus, Counter>::operator-=(
+                                            const RingModElt<Modulus, Counter>& e
                                                             ) {
-  value_ = (value_ - e.value_) % Modulus;
+  value_ = static_cast<int>((static_cast<Wide>(value_) - e.value_) % Modulus);
   opCount_.countAddition();
   return *this;
 }
@@ -144,11 +159,11 @@ const RingModElt<Modulus>& RingModElt<Modulus>::operator-=(
  * @param[in] e        The RingModElt value to multiply with.
  * @return    A reference to self.
  */
-template<int Modulus>
-const RingModElt<Modulus>& RingModElt<Modulus>::operator*=(
-                                            const RingModElt<Modulus>& e
+template<int Modulus, typename Counter>
+const RingModElt<Modulus, Counter>& RingModElt<Modulus, Counter>::operator*=(
+                                            const RingModElt<Modulus, Counter>& e
                                                             ) {
-  value_ = (value_ * e.value_) % Modulus;
+  value_ = static_cast<int>((static_cast<Wide>(value_) * e.value_) % Modulus);
   opCount_.countMultiplication();
   return *this;
 }
@@ -159,11 +174,11 @@ const RingModElt<Modulus>& RingModElt<Modulus>::operator*=(
  * @param[in] e        The constant value to multiply with.
  * @return    A reference to self.
  */
-template<int Modulus>
-const RingModElt<Modulus>& RingModElt<Modulus>::operator*=(
+template<int Modulus, typename Counter>
+const RingModElt<Modulus, Counter>& RingModElt<Modulus, Counter>::operator*=(
                                                       const int& e
                                                             ) {
-  value_ = (value_ * e) % Modulus;
+  value_ = static_cast<int>((static_cast<Wide>(value_) * e) % Modulus);
   opCount_.countConstMult();
   return *this;
 }
@@ -173,9 +188,9 @@ const RingModElt<Modulus>& RingModElt<Modulus>::operator*=(
  * Sign inversion operator for a RingModElt (counted as an addition).
  * @return   The value, sign-inverted.
  */
-template<int Modulus>
-const RingModElt<Modulus> RingModElt<Modulus>::operator-() const {
-  RingModElt<Modulus> ret(RingModElt<Modulus>() - *this);
+template<int Modulus, typename Counter>
+const RingModElt<Modulus, Counter> RingModElt<Modulus, Counter>::operator-() const {
+  RingModElt<Modulus, Counter> ret(RingModElt<Modulus, Counter>() - *this);
   return ret;
 }
 
@@ -186,17 +201,17 @@ const RingModElt<Modulus> RingModElt<Modulus>::operator-() const {
  * @param[in] b        The second value to test.
  * @return    true iff the two are equal (using the modulus).
  */
-template<int Modulus>
-bool operator==(const RingModElt<Modulus>& a, const RingModElt<Modulus>& b) {
+template<int Modulus, typename Counter>
+bool operator==(const RingModElt<Modulus, Counter>& a, const RingModElt<Modulus, Counter>& b) {
   // Modulo is still needed, as an integer may be negative or positive.
-  return (a.toInt() - b.toInt()) % Modulus == 0;
+  return (static_cast<std::int64_t>(a.toInt()) - b.toInt()) % Modulus == 0;
 }
 
 
 
-template<int Modulus>
-bool RingModElt<Modulus>::getInverse(RingModElt<Modulus>& inverse,
-                                     const RingModElt<Modulus>& value) {
+template<int Modulus, typename Counter>
+bool RingModElt<Modulus, Counter>::getInverse(RingModElt<Modulus, Counter>& inverse,
+                                     const RingModElt<Modulus, Counter>& value) {
   // Use the extended Euclidian algorithm to get the inverse.
   int t = 0;
   int tNew = 1;
@@ -218,8 +233,8 @@ bool RingModElt<Modulus>::getInverse(RingModElt<Modulus>& inverse,
   if(r > 1)
     return false;
 
-  inverse = RingModElt<Modulus>(t);
-  assert((t*value.toInt() - 1) % Modulus == 0);
+  inverse = RingModElt<Modulus, Counter>(t);
+  assert((static_cast<std::int64_t>(t)*value.toInt() - 1) % Modulus == 0);
   return true;
 }
 
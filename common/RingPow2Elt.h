@@ -0,0 +1,269 @@
+/**
+ * @file RingPow2Elt.h
+ * @author Gerben van der Lubbe
+ *
+ * File for storing elements in the ring Z/2^kZ.
+ */
+
+#ifndef RINGPOW2ELT_H
+#define RINGPOW2ELT_H
+
+#include <iostream>
+#include <cstdint>
+#include <type_traits>
+
+#include "Util.h"
+#include "OpCount.h"
+
+/**
+ * Class to deal with the ring Z/2^kZ, where k == Bits. The value is stored in the smallest of
+ * std::uint16_t, std::uint32_t and std::uint64_t that has k bits, and the operations simply wrap
+ * around in it: as 2^k divides the size of the word, this is correct modulo 2^k, and no reduction
+ * is needed until the value is read, when the bits above k are masked off.
+ *
+ * Only odd values are invertible. For Nussbaumer's algorithm, where the result is multiplied by a
+ * power of two, calculate in a ring with that many more bits and divide the factor out with
+ * shiftRight (see NegaNussbaumer::correctByShift).
+ */
+template<unsigned int Bits, typename Counter = OpCount>
+class RingPow2Elt : public Multiplies<RingPow2Elt<Bits, Counter>>,
+                    public Multiplies<RingPow2Elt<Bits, Counter>, int>,
+                    public Adds<RingPow2Elt<Bits, Counter>>,
+                    public Subtracts<RingPow2Elt<Bits, Counter>>,
+                    public CompEquality<RingPow2Elt<Bits, Counter>> {
+public:
+  static_assert(Bits > 0 && Bits <= 63, "the modulus must be 2^1 up to 2^63");
+
+  /// The storage type
+  typedef typename std::conditional<Bits <= 16, std::uint16_t,
+          typename std::conditional<Bits <= 32, std::uint32_t, std::uint64_t>::type>::type Word;
+
+  /// The mask of the bits that are in the ring
+  static constexpr std::uint64_t Mask = (std::uint64_t(1) << Bits) - 1;
+
+  RingPow2Elt(std::int64_t value = 0);
+
+  template<unsigned int OtherBits>
+  RingPow2Elt(const RingPow2Elt<OtherBits, Counter>& other);
+
+  std::int64_t toInt() const;
+
+  const RingPow2Elt<Bits, Counter>& operator+=(const RingPow2Elt<Bits, Counter>& e);
+  const RingPow2Elt<Bits, Counter>& operator-=(const RingPow2Elt<Bits, Counter>& e);
+  const RingPow2Elt<Bits, Counter>& operator*=(const RingPow2Elt<Bits, Counter>& e);
+  const RingPow2Elt<Bits, Counter>& operator*=(const int& e);
+
+  const RingPow2Elt<Bits, Counter> operator-() const;
+
+  RingPow2Elt<Bits, Counter> shiftRight(unsigned int bits) const;
+
+  static bool getInverse(RingPow2Elt<Bits, Counter>& inverse,
+                         const RingPow2Elt<Bits, Counter>& value);
+
+  static Counter& getOpCount();
+  static void setOpCount(const Counter& opCount);
+
+private:
+  /// Word after integer promotion; the arithmetic is done in this type so that it wraps around.
+  typedef decltype(Word() + 0u) Promoted;
+
+  Word value_ = 0;
+  static Counter opCount_;
+};
+
+
+/**
+ * Write a RingPow2Elt to a stream.
+ * @param[in] out      The stream to write to.
+ * @param[in] e        The RingPow2Elt to write.
+ * @return    A reference to the stream.
+ */
+template<unsigned int Bits, typename Counter>
+std::ostream& operator<<(std::ostream& out, const RingPow2Elt<Bits, Counter>& e) {
+  out << e.toInt();
+  return out;
+}
+
+
+template<unsigned int Bits, typename Counter>
+constexpr std::uint64_t RingPow2Elt<Bits, Counter>::Mask;
+
+
+/**
+ * Keeps track of the number of operations performed on the ring.
+ */
+template<unsigned int Bits, typename Counter>
+Counter RingPow2Elt<Bits, Counter>::opCount_;
+
+
+/**
+ * Gets the counter for number of operations on the ring. This value is
+ * different for different Bits.
+ * @return A reference to the counter.
+ */
+template<unsigned int Bits, typename Counter>
+Counter& RingPow2Elt<Bits, Counter>::getOpCount() {
+  return opCount_;
+}
+
+
+/**
+ * Update the operation counter to this value.
+ * @param[in] opCount  The number of operations at this time.
+ */
+template<unsigned int Bits, typename Counter>
+void RingPow2Elt<Bits, Counter>::setOpCount(const Counter& opCount) {
+  opCount_ = opCount;
+}
+
+
+/**
+ * Create a ring element modulo 2^Bits, with a specified integer value.
+ * @param[in] value   The initial value to set; it does not have to be reduced.
+ */
+template<unsigned int Bits, typename Counter>
+RingPow2Elt<Bits, Counter>::RingPow2Elt(std::int64_t value)
+: value_(static_cast<Word>(value))
+{}
+
+
+/**
+ * Convert an element modulo another power of two. To fewer bits, this is reduction modulo 2^Bits;
+ * to more bits, the value in [0, 2^OtherBits) is taken as representative.
+ * @param[in] other   The element to convert.
+ */
+template<unsigned int Bits, typename Counter> template<unsigned int OtherBits>
+RingPow2Elt<Bits, Counter>::RingPow2Elt(const RingPow2Elt<OtherBits, Counter>& other)
+: value_(static_cast<Word>(other.toInt()))
+{}
+
+
+/**
+ * Convert the element of the used ring (Z/2^kZ where k = Bits) to the integer value.
+ * @return The integer value, in [0, 2^Bits).
+ */
+template<unsigned int Bits, typename Counter>
+std::int64_t RingPow2Elt<Bits, Counter>::toInt() const {
+  return static_cast<std::int64_t>(value_ & Mask);
+}
+
+
+/**
+ * Addition assignment operator for RingPow2Elt.
+ * @param[in] e        The value to add.
+ * @return    A reference to self.
+ */
+template<unsigned int Bits, typename Counter>
+const RingPow2Elt<Bits, Counter>& RingPow2Elt<Bits, Counter>::operator+=(
+                                            const RingPow2Elt<Bits, Counter>& e
+                                                                        ) {
+  value_ = static_cast<Word>(static_cast<Promoted>(value_) + e.value_);
+  opCount_.countAddition();
+  return *this;
+}
+
+
+/**
+ * Subtract-assignment from the RingPow2Elt.
+ * @param[in] e        The value to subtract.
+ * @return    A reference to self.
+ */
+template<unsigned int Bits, typename Counter>
+const RingPow2Elt<Bits, Counter>& RingPow2Elt<Bits, Counter>::operator-=(
+                                            const RingPow2Elt<Bits, Counter>& e
+                                                                        ) {
+  value_ = static_cast<Word>(static_cast<Promoted>(value_) - e.value_);
+  opCount_.countAddition();
+  return *this;
+}
+
+
+/**
+ * Multiplication-assignment operator by another RingPow2Elt.
+ * @param[in] e        The RingPow2Elt value to multiply with.
+ * @return    A reference to self.
+ */
+template<unsigned int Bits, typename Counter>
+const RingPow2Elt<Bits, Counter>& RingPow2Elt<Bits, Counter>::operator*=(
+                                            const RingPow2Elt<Bits, Counter>& e
+                                                                        ) {
+  value_ = static_cast<Word>(static_cast<Promoted>(value_)*e.value_);
+  opCount_.countMultiplication();
+  return *this;
+}
+
+
+/**
+ * Multiplication-assignment operator by a constant.
+ * @param[in] e        The constant value to multiply with.
+ * @return    A reference to self.
+ */
+template<unsigned int Bits, typename Counter>
+const RingPow2Elt<Bits, Counter>& RingPow2Elt<Bits, Counter>::operator*=(
+                                                      const int& e
+                                                                        ) {
+  value_ = static_cast<Word>(static_cast<Promoted>(value_)*static_cast<Word>(e));
+  opCount_.countConstMult();
+  return *this;
+}
+
+
+/**
+ * Sign inversion operator for a RingPow2Elt (counted as an addition).
+ * @return   The value, sign-inverted.
+ */
+template<unsigned int Bits, typename Counter>
+const RingPow2Elt<Bits, Counter> RingPow2Elt<Bits, Counter>::operator-() const {
+  RingPow2Elt<Bits, Counter> ret(RingPow2Elt<Bits, Counter>() - *this);
+  return ret;
+}
+
+
+/**
+ * Divide by 2^bits, rounding down. This is the exact division if the value is a multiple of
+ * 2^bits, in which case the quotient is correct modulo 2^(Bits - bits).
+ * @param[in] bits     The power of two to divide by.
+ * @return    The quotient.
+ */
+template<unsigned int Bits, typename Counter>
+RingPow2Elt<Bits, Counter> RingPow2Elt<Bits, Counter>::shiftRight(unsigned int bits) const {
+  opCount_.countShift();
+  return RingPow2Elt<Bits, Counter>(toInt() >> bits);
+}
+
+
+/**
+ * Compare two RingPow2Elts for equality.
+ * @param[in] a        The first value to test.
+ * @param[in] b        The second value to test.
+ * @return    true iff the two are equal modulo 2^Bits.
+ */
+template<unsigned int Bits, typename Counter>
+bool operator==(const RingPow2Elt<Bits, Counter>& a, const RingPow2Elt<Bits, Counter>& b) {
+  return a.toInt() == b.toInt();
+}
+
+
+/**
+ * Get the inverse of an element, which exists iff it is odd.
+ * @param[out] inverse  The inverse, if it exists.
+ * @param[in]  value    The element to invert.
+ * @return     Whether the element is invertible.
+ */
+template<unsigned int Bits, typename Counter>
+bool RingPow2Elt<Bits, Counter>::getInverse(RingPow2Elt<Bits, Counter>& inverse,
+                                            const RingPow2Elt<Bits, Counter>& value) {
+  std::uint64_t odd = static_cast<std::uint64_t>(value.toInt());
+  if((odd & 1) == 0)
+    return false;
+
+  // An odd value is its own inverse modulo 2^3; each Newton step doubles the number of correct bits.
+  std::uint64_t result = odd;
+  for(int i = 0; i < 5; ++i)
+    result *= 2 - odd*result;
+
+  inverse = RingPow2Elt<Bits, Counter>(static_cast<std::int64_t>(result & Mask));
+  return true;
+}
+
+#endif
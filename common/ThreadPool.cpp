@@ -0,0 +1,153 @@
+#include <atomic>
+
+#include "ThreadPool.h"
+
+/// The index of the queue of the current thread, for the pool it works for
+static thread_local const ThreadPool* currentPool = nullptr;
+static thread_local std::size_t currentQueue = 0;
+
+
+/**
+ * Start the threads of the pool. The thread creating it counts as one of them, so numThreads - 1
+ * threads are started.
+ * @param[in] numThreads   The number of threads to run tasks on; 0 is taken as 1.
+ */
+ThreadPool::ThreadPool(std::size_t numThreads) {
+  if(numThreads == 0)
+    numThreads = 1;
+
+  for(std::size_t i = 0; i < numThreads; ++i)
+    queues_.emplace_back(new Queue);
+  for(std::size_t i = 1; i < numThreads; ++i)
+    threads_.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+
+/**
+ * Stop the threads, after they have run all queued tasks.
+ */
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(idleMutex_);
+    stop_ = true;
+  }
+  idle_.notify_all();
+  for(auto& thread : threads_)
+    thread.join();
+}
+
+
+/**
+ * Get the number of threads that run tasks, including the calling one.
+ * @return The number of threads.
+ */
+std::size_t ThreadPool::getNumThreads() const {
+  return queues_.size();
+}
+
+
+/**
+ * Run body(i) for every begin <= i < end, in parallel, and wait until all are done. Each index is
+ * one task, so the body should be a sizeable piece of work.
+ * @param[in] begin    The first index.
+ * @param[in] end      One past the last index.
+ * @param[in] body     The function to call for each index.
+ */
+void ThreadPool::parallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t)>& body) {
+  if(end <= begin)
+    return;
+  if(queues_.size() == 1) {
+    for(std::size_t i = begin; i < end; ++i)
+      body(i);
+    return;
+  }
+
+  std::atomic<std::size_t> remaining(end - begin);
+  std::size_t self = getOwnQueue();
+
+  // Count the tasks before queueing them, so that taking one never makes the count negative
+  {
+    std::lock_guard<std::mutex> lock(idleMutex_);
+    numQueued_ += end - begin;
+  }
+  {
+    std::lock_guard<std::mutex> lock(queues_[self]->mutex);
+    for(std::size_t i = begin; i < end; ++i) {
+      queues_[self]->tasks.emplace_back([&body, &remaining, i] {
+        body(i);
+        --remaining;
+      });
+    }
+  }
+  idle_.notify_all();
+
+  // Work along until the last task is done; it may run on another thread after the queues are empty.
+  while(remaining != 0) {
+    if(!runTask(self))
+      std::this_thread::yield();
+  }
+}
+
+
+/**
+ * Run tasks until the pool is destroyed, sleeping while there are none.
+ * @param[in] self     The index of the queue of this thread.
+ */
+void ThreadPool::workerLoop(std::size_t self) {
+  currentPool = this;
+  currentQueue = self;
+
+  for(;;) {
+    {
+      std::unique_lock<std::mutex> lock(idleMutex_);
+      idle_.wait(lock, [this] { return stop_ || numQueued_ != 0; });
+      if(stop_ && numQueued_ == 0)
+        return;
+    }
+    runTask(self);
+  }
+}
+
+
+/**
+ * Run one task: the newest one of the own queue, or the oldest one of another queue.
+ * @param[in] self     The index of the queue of this thread.
+ * @return    Whether there was a task to run.
+ */
+bool ThreadPool::runTask(std::size_t self) {
+  Task task;
+  for(std::size_t i = 0; i < queues_.size() && !task; ++i) {
+    Queue& queue = *queues_[(self + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.tasks.empty())
+      continue;
+
+    if(i == 0) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    }
+    else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+  }
+  if(!task)
+    return false;
+
+  {
+    std::lock_guard<std::mutex> lock(idleMutex_);
+    --numQueued_;
+  }
+  task();
+  return true;
+}
+
+
+/**
+ * Get the queue of the calling thread: its own for the threads of the pool, and the first one
+ * (which has no thread of its own) for other threads.
+ * @return The index of the queue.
+ */
+std::size_t ThreadPool::getOwnQueue() const {
+  return currentPool == this ? currentQueue : 0;
+}
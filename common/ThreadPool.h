@@ -0,0 +1,66 @@
+/**
+ * @file ThreadPool.h
+ * @author Gerben van der Lubbe
+ *
+ * File containing a work-stealing thread pool, to run independent parts of an algorithm in
+ * parallel.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+/**
+ * A pool of threads that each have a queue of tasks. A thread takes tasks from the back of its
+ * own queue and, when that is empty, steals from the front of the others. The thread calling
+ * parallelFor works along until its tasks are done, so a task may call parallelFor itself without
+ * blocking a thread.
+ *
+ * With 1 thread, no threads are started and parallelFor runs the loop in the calling thread.
+ */
+class ThreadPool {
+public:
+  ThreadPool(std::size_t numThreads = std::thread::hardware_concurrency());
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  std::size_t getNumThreads() const;
+
+  void parallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t)>& body);
+
+private:
+  typedef std::function<void()> Task;
+
+  /**
+   * The tasks of one thread.
+   */
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void workerLoop(std::size_t self);
+  bool runTask(std::size_t self);
+  std::size_t getOwnQueue() const;
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+
+  /// Protects numQueued_ and stop_, for the idle threads to wait on
+  std::mutex idleMutex_;
+  std::condition_variable idle_;
+  std::size_t numQueued_ = 0;
+  bool stop_ = false;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#include "WallClock.h"
+
+/**
+ * Start measuring.
+ */
+WallClock::WallClock()
+: start_(std::chrono::steady_clock::now()), elapsed_(0)
+{}
+
+
+/**
+ * Restart the measurement, like OpCount::reset.
+ * @return   A WallClock holding the time elapsed until now.
+ */
+WallClock WallClock::reset() {
+  auto now = std::chrono::steady_clock::now();
+  WallClock res = *this;
+  res.elapsed_ = now - start_;
+  start_ = now;
+  return res;
+}
+
+
+/**
+ * Get the time measured by reset.
+ * @return   The elapsed time in microseconds.
+ */
+double WallClock::getMicroseconds() const {
+  return std::chrono::duration<double, std::micro>(elapsed_).count();
+}
+
+
+/**
+ * Write the elapsed time of a WallClock to a stream.
+ * @param[in] oss      The output stream to write to.
+ * @param[in] clock    The result of WallClock::reset.
+ * @return    A reference to the stream.
+ */
+std::ostream& operator<<(std::ostream& oss, const WallClock& clock) {
+  oss << clock.getMicroseconds() << " us";
+  return oss;
+}
@@ -0,0 +1,32 @@
+/**
+ * @file WallClock.h
+ * @author Gerben van der Lubbe
+ *
+ * File to measure the wall-clock time of the steps that OpCount counts.
+ */
+
+#ifndef WALLCLOCK_H
+#define WALLCLOCK_H
+
+#include <iostream>
+#include <chrono>
+
+/**
+ * Class to measure the elapsed time since it was created or last reset.
+ */
+class WallClock {
+public:
+  WallClock();
+
+  WallClock reset();
+
+  double getMicroseconds() const;
+
+private:
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::duration elapsed_;
+};
+
+std::ostream& operator<<(std::ostream& oss, const WallClock& clock);
+
+#endif
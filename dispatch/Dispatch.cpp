@@ -0,0 +1,86 @@
+#include "avx2/Componentwise.h"
+#include "avx2/Multiply.h"
+#include "avx512/Nussbaumer.h"
+#include "dispatch/Dispatch.h"
+#include "dispatch/Generic.h"
+
+namespace {
+
+/**
+ * The portable backend can always be used.
+ */
+bool genericSupported() {
+  return true;
+}
+
+/**
+ * Checks whether the processor supports AVX2.
+ */
+bool avx2Supported() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+/**
+ * Checks whether the processor supports both the AVX2 and AVX-512BW instructions.
+ */
+bool avx512Supported() {
+  return avx2Supported() && nussbaumer1024_avx512_supported();
+}
+
+}
+
+
+const NussbaumerBackend nussbaumerGenericBackend = {
+  "generic",
+  genericSupported,
+  nussbaumer1024_forward_generic,
+  componentwise32_64_prepare_generic,
+  componentwise32_64_run_generic,
+  nussbaumer1024_inverse_generic,
+  nussbaumer1024_multiply_generic
+};
+
+const NussbaumerBackend nussbaumerAvx2Backend = {
+  "AVX2",
+  avx2Supported,
+  nussbaumer1024_forward,
+  componentwise32_64_prepare,
+  componentwise32_64_run,
+  nussbaumer1024_inverse,
+  nussbaumer1024_multiply
+};
+
+const NussbaumerBackend nussbaumerAvx512Backend = {
+  "AVX-512",
+  avx512Supported,
+  nussbaumer1024_forward_avx512,
+  componentwise32_64_prepare,
+  componentwise32_64_run,
+  nussbaumer1024_inverse_avx512,
+  nussbaumer1024_multiply_avx512
+};
+
+/**
+ * Gets the fastest backend supported by the processor. The processor features are only detected
+ * on the first call.
+ * @return The backend to use.
+ */
+const NussbaumerBackend& nussbaumer1024_backend() {
+  static const NussbaumerBackend& backend = *nussbaumer1024_supported_backends().back();
+  return backend;
+}
+
+/**
+ * Gets all backends supported by the processor.
+ * @return The backends, from the slowest to the fastest.
+ */
+std::vector<const NussbaumerBackend*> nussbaumer1024_supported_backends() {
+  std::vector<const NussbaumerBackend*> backends;
+  for(auto backend : { &nussbaumerGenericBackend, &nussbaumerAvx2Backend, &nussbaumerAvx512Backend }) {
+    if(backend->supported())
+      backends.push_back(backend);
+  }
+
+  return backends;
+}
@@ -0,0 +1,73 @@
+#ifndef DISPATCH_DISPATCH_H_
+#define DISPATCH_DISPATCH_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "avx2/Nussbaumer.h"
+
+/*
+ * bin/libnussbaumer-portable.a holds the dispatch and all backends, and runs on any x86-64
+ * processor: the C++ is built without -march, and all code using AVX2 or AVX-512 (the AVX2
+ * assembly and the target("avx512f,avx512bw") functions) is placed in the nussbaumer_backend
+ * section. That code is only reached through a backend whose supported() returned true;
+ * portabletests/dispatch checks that no instruction outside the section needs AVX.
+ */
+
+/**
+ * An implementation of the Nussbaumer multiplication modulo X^1024 + 1 and q = 2047. The
+ * transformed values are only meaningful to the backend that produced them. Inputs must be
+ * 32-byte aligned and have coefficients of at most 11 bits.
+ */
+struct NussbaumerBackend {
+  /** Name of the backend, for reporting. */
+  const char* name;
+
+  /** Whether the processor supports the backend. */
+  bool (*supported)();
+
+  /** The forward transform. */
+  void (*forward)(Transformed dest, std::uint16_t* src);
+
+  /** Prepare transformed values for the componentwise multiplication. */
+  void (*prepare)(std::uint16_t* data);
+
+  /** The componentwise multiplication of two prepared values. */
+  void (*run)(std::uint16_t* dest, std::uint16_t* prep1, std::uint16_t* prep2);
+
+  /** The inverse transform, giving fully reduced coefficients. */
+  void (*inverse)(TransformedResult dest, Transformed src);
+
+  /** The full multiplication of two polynomials. */
+  void (*multiply)(std::uint16_t* dest, std::uint16_t* src1, std::uint16_t* src2);
+};
+
+/**
+ * Portable C++, for any x86-64 processor.
+ */
+extern const NussbaumerBackend nussbaumerGenericBackend;
+
+/**
+ * The AVX2 assembly.
+ */
+extern const NussbaumerBackend nussbaumerAvx2Backend;
+
+/**
+ * The AVX-512BW transforms, with the AVX2 componentwise multiplication.
+ */
+extern const NussbaumerBackend nussbaumerAvx512Backend;
+
+/**
+ * Gets the fastest backend supported by the processor. The processor features are only detected
+ * on the first call.
+ * @return The backend to use.
+ */
+const NussbaumerBackend& nussbaumer1024_backend();
+
+/**
+ * Gets all backends supported by the processor.
+ * @return The backends, from the slowest to the fastest.
+ */
+std::vector<const NussbaumerBackend*> nussbaumer1024_supported_backends();
+
+#endif
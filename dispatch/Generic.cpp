@@ -0,0 +1,155 @@
+#include <cstddef>
+#include <cstdint>
+
+#include "BitManip.h"
+#include "dispatch/Generic.h"
+
+namespace {
+
+constexpr int Modulus = 2047;
+
+// The inverse of 2m = 64 modulo 2047.
+constexpr int InverseOf64 = 32;
+
+/**
+ * The 64 polynomials of 32 coefficients making up a transformed value.
+ */
+typedef int Polynomials[64][32];
+
+/**
+ * Reduce a value to the range [0, Modulus).
+ */
+inline int reduce(int value) {
+  value %= Modulus;
+  return value < 0 ? value + Modulus : value;
+}
+
+/**
+ * Sets (a, b) to (a + u^k*b, a - u^k*b), modulo u^32 + 1.
+ * @param[in,out] a    The first polynomial.
+ * @param[in,out] b    The polynomial to rotate.
+ * @param[in]     k    The power of u; only taken modulo 64.
+ */
+void butterfly(int* a, int* b, unsigned k) {
+  k &= 63;
+
+  // The coefficients that wrap around are negated; if k >= 32 all signs are flipped once more.
+  int rotated[32];
+  for(unsigned i = 0; i < 32; ++i) {
+    int value = b[(i - k) & 31];
+    bool negate = (i < (k & 31)) != (k >= 32);
+    rotated[i] = negate ? -value : value;
+  }
+
+  for(std::size_t i = 0; i < 32; ++i) {
+    int sum = reduce(a[i] + rotated[i]);
+    b[i] = reduce(a[i] - rotated[i]);
+    a[i] = sum;
+  }
+}
+
+}
+
+
+/**
+ * Performs the forward Nussbaumer transform in portable C++.
+ * @param[out] dest    The memory to store the transformed input.
+ * @param[in]  src     The coefficients of the polynomial.
+ */
+void nussbaumer1024_forward_generic(Transformed dest, std::uint16_t* src) {
+  Polynomials pols;
+  for(std::size_t i = 0; i < 64; ++i) {
+    for(std::size_t j = 0; j < 32; ++j)
+      pols[i][j] = reduce(src[32*j + (i % 32)]);
+  }
+
+  for(std::size_t j = 5; j-- > 0;) {
+    for(std::size_t sPart = 0; sPart < (32u >> j); ++sPart) {
+      std::size_t s = sPart << (j + 1);
+      unsigned k = static_cast<unsigned>(bitrev(5 - j, sPart) << j);
+
+      for(std::size_t t = 0; t < (1u << j); ++t)
+        butterfly(pols[s + t], pols[s + t + (1u << j)], k);
+    }
+  }
+
+  for(std::size_t i = 0; i < 64; ++i) {
+    for(std::size_t j = 0; j < 32; ++j)
+      dest[i + 64*j] = static_cast<std::uint16_t>(pols[i][j]);
+  }
+}
+
+/**
+ * Prepare for componentwise32_64_run_generic; the portable backend needs no preparation.
+ * @param[in,out] data   The transformed polynomials.
+ */
+void componentwise32_64_prepare_generic(std::uint16_t* /* data */) {
+}
+
+/**
+ * Multiplies the 64 polynomials of 32 coefficients modulo u^32 + 1, in portable C++.
+ * @param[out] dest      Stores the result; may be the same as prep1.
+ * @param[in]  prep1     The first polynomials, prepared.
+ * @param[in]  prep2     The second polynomials, prepared.
+ */
+void componentwise32_64_run_generic(std::uint16_t* dest, std::uint16_t* prep1, std::uint16_t* prep2) {
+  for(std::size_t i = 0; i < 64; ++i) {
+    // The sums of 32 products of fully reduced values fit in 32 bits.
+    int product[32] = { 0 };
+    for(std::size_t a = 0; a < 32; ++a) {
+      for(std::size_t b = 0; b < 32; ++b) {
+        int term = prep1[i + 64*a] * prep2[i + 64*b];
+        if(a + b < 32)
+          product[a + b] += term;
+        else
+          product[a + b - 32] -= term;
+      }
+    }
+
+    for(std::size_t j = 0; j < 32; ++j)
+      dest[i + 64*j] = static_cast<std::uint16_t>(reduce(product[j]));
+  }
+}
+
+/**
+ * Calculate the inverse Nussbaumer transform in portable C++.
+ * @param[out] dest    The memory region to store the result; may be the same as src.
+ * @param[in]  src     The transformed value.
+ */
+void nussbaumer1024_inverse_generic(TransformedResult dest, Transformed src) {
+  Polynomials pols;
+  for(std::size_t i = 0; i < 64; ++i) {
+    for(std::size_t j = 0; j < 32; ++j)
+      pols[i][j] = reduce(src[i + 64*j]);
+  }
+
+  for(std::size_t j = 0; j <= 5; ++j) {
+    for(std::size_t t = 0; t < (1u << j); ++t) {
+      unsigned k = static_cast<unsigned>(64 - (t << (5 - j)));
+
+      for(std::size_t s = 0; s < 64; s += (2u << j))
+        butterfly(pols[s + t], pols[s + t + (1u << j)], k);
+    }
+  }
+
+  // Unpack the polynomial and multiply with the inverse of 2m.
+  for(std::size_t i = 0; i < 32; ++i) {
+    dest[i] = static_cast<std::uint16_t>(reduce((pols[i][0] - pols[32 + i][31])*InverseOf64));
+    for(std::size_t j = 1; j < 32; ++j)
+      dest[32*j + i] = static_cast<std::uint16_t>(reduce((pols[i][j] + pols[32 + i][j - 1])*InverseOf64));
+  }
+}
+
+/**
+ * Multiply two polynomials modulo X^1024 + 1 in portable C++.
+ * @param[out] dest    The 1024 coefficients of the product, reduced modulo 2047.
+ * @param[in]  src1    The first polynomial.
+ * @param[in]  src2    The second polynomial.
+ */
+void nussbaumer1024_multiply_generic(std::uint16_t* dest, std::uint16_t* src1, std::uint16_t* src2) {
+  Transformed transformed1, transformed2;
+  nussbaumer1024_forward_generic(transformed1, src1);
+  nussbaumer1024_forward_generic(transformed2, src2);
+  componentwise32_64_run_generic(transformed1, transformed1, transformed2);
+  nussbaumer1024_inverse_generic(dest, transformed1);
+}
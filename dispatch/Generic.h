@@ -0,0 +1,45 @@
+#ifndef DISPATCH_GENERIC_H_
+#define DISPATCH_GENERIC_H_
+
+#include <cstdint>
+
+#include "avx2/Nussbaumer.h"
+
+/**
+ * Performs the forward Nussbaumer transform in portable C++. The output has the same layout as
+ * nussbaumer1024_forward, with fully reduced coefficients.
+ * @param[out] dest    The memory to store the transformed input.
+ * @param[in]  src     The coefficients of the polynomial.
+ */
+void nussbaumer1024_forward_generic(Transformed dest, std::uint16_t* src);
+
+/**
+ * Prepare for componentwise32_64_run_generic; the portable backend needs no preparation.
+ * @param[in,out] data   The transformed polynomials.
+ */
+void componentwise32_64_prepare_generic(std::uint16_t* data);
+
+/**
+ * Multiplies the 64 polynomials of 32 coefficients modulo u^32 + 1, in portable C++.
+ * @param[out] dest      Stores the result; may be the same as prep1.
+ * @param[in]  prep1     The first polynomials, prepared.
+ * @param[in]  prep2     The second polynomials, prepared.
+ */
+void componentwise32_64_run_generic(std::uint16_t* dest, std::uint16_t* prep1, std::uint16_t* prep2);
+
+/**
+ * Calculate the inverse Nussbaumer transform in portable C++.
+ * @param[out] dest    The memory region to store the result; may be the same as src.
+ * @param[in]  src     The transformed value.
+ */
+void nussbaumer1024_inverse_generic(TransformedResult dest, Transformed src);
+
+/**
+ * Multiply two polynomials modulo X^1024 + 1 in portable C++.
+ * @param[out] dest    The 1024 coefficients of the product, reduced modulo 2047.
+ * @param[in]  src1    The first polynomial.
+ * @param[in]  src2    The second polynomial.
+ */
+void nussbaumer1024_multiply_generic(std::uint16_t* dest, std::uint16_t* src1, std::uint16_t* src2);
+
+#endif
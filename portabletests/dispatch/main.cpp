@@ -0,0 +1,169 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <climits>
+#include <unistd.h>
+
+#include "Polynomial.h"
+#include "RingModElt.h"
+#include "NegaConvo.h"
+#include "dispatch/Dispatch.h"
+
+constexpr std::size_t N = 1024;
+constexpr int Modulo = 2047;
+static const std::size_t NumTests = 50;
+
+/// The section of the code that needs more than the baseline x86-64 instruction set
+static const std::string BackendSection = "nussbaumer_backend";
+
+typedef RingModElt<Modulo> RingType;
+static std::uint16_t data[N] __attribute__((aligned(32)));
+static std::uint16_t data2[N] __attribute__((aligned(32)));
+static std::uint16_t result[N] __attribute__((aligned(32)));
+
+/**
+ * Checks whether a disassembled instruction (in AT&T syntax) needs AVX: it is VEX or EVEX
+ * encoded, or uses the ymm, zmm or AVX-512 mask registers.
+ * @param[in] mnemonic   The mnemonic of the instruction.
+ * @param[in] operands   The operands of the instruction.
+ * @return    Whether the instruction needs AVX.
+ */
+bool needsAvx(const std::string& mnemonic, const std::string& operands) {
+  if(!mnemonic.empty() && mnemonic[0] == 'v' && mnemonic != "verr" && mnemonic != "verw")
+    return true;
+  if(operands.find("%ymm") != std::string::npos || operands.find("%zmm") != std::string::npos)
+    return true;
+  for(std::size_t pos = operands.find("%k"); pos != std::string::npos; pos = operands.find("%k", pos + 1)) {
+    if(pos + 2 < operands.size() && operands[pos + 2] >= '0' && operands[pos + 2] <= '7')
+      return true;
+  }
+  return false;
+}
+
+/**
+ * Disassemble this executable, and check that no code outside the backend section needs AVX, so
+ * that the executable runs up to the run-time check on any x86-64 processor.
+ * @return    Whether the check succeeded.
+ */
+bool checkInstructions() {
+  // Resolve the executable first; in the shell of popen, /proc/self/exe would be objdump itself.
+  char path[PATH_MAX];
+  ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+  if(length <= 0) {
+    std::cout << "TEST FAILED: could not find the executable" << std::endl;
+    return false;
+  }
+  path[length] = '\0';
+
+  FILE* objdump = popen(("objdump -d --no-show-raw-insn '" + std::string(path) + "'").c_str(), "r");
+  if(objdump == nullptr) {
+    std::cout << "TEST FAILED: could not run objdump" << std::endl;
+    return false;
+  }
+
+  std::string section, function;
+  std::size_t numPortable = 0, numBackendAvx = 0, numViolations = 0;
+  char buffer[4096];
+  while(fgets(buffer, sizeof(buffer), objdump) != nullptr) {
+    std::string line(buffer);
+    if(line.compare(0, 23, "Disassembly of section ") == 0) {
+      section = line.substr(23, line.find(':') - 23);
+      continue;
+    }
+    std::size_t open = line.find(" <");
+    if(!line.empty() && line[0] != ' ' && open != std::string::npos) {
+      function = line.substr(open + 2, line.rfind('>') - open - 2);
+      continue;
+    }
+
+    // Instructions are "  address:\tmnemonic operands"
+    std::size_t tab = line.find(":\t");
+    if(tab == std::string::npos)
+      continue;
+    std::istringstream instruction(line.substr(tab + 2));
+    std::string mnemonic, operands;
+    instruction >> mnemonic;
+    std::getline(instruction, operands);
+
+    if(section == BackendSection) {
+      if(needsAvx(mnemonic, operands))
+        ++numBackendAvx;
+    }
+    else {
+      ++numPortable;
+      if(needsAvx(mnemonic, operands)) {
+        if(numViolations < 10)
+          std::cout << "AVX instruction in " << function << " (" << section << "): " << mnemonic << operands << std::endl;
+        ++numViolations;
+      }
+    }
+  }
+
+  if(pclose(objdump) != 0 || numPortable == 0) {
+    std::cout << "TEST FAILED: could not disassemble the executable" << std::endl;
+    return false;
+  }
+  if(numBackendAvx == 0) {
+    std::cout << "TEST FAILED: the " << BackendSection << " section has no AVX instructions" << std::endl;
+    return false;
+  }
+  if(numViolations != 0) {
+    std::cout << "TEST FAILED: " << numViolations << " AVX instructions outside the "
+              << BackendSection << " section" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Multiply random polynomials through a backend, and compare the product to the naive
+ * multiplication.
+ * @param[in] backend    The backend to test.
+ * @return    Whether the product was correct.
+ */
+bool runTest(const NussbaumerBackend& backend) {
+  Polynomial<RingType> pol1(N), pol2(N);
+  for(std::size_t i = 0; i < N; ++i) {
+    data[i] = rand() & ((1 << 11) - 1);
+    data2[i] = rand() & ((1 << 11) - 1);
+    pol1[i] = data[i];
+    pol2[i] = data2[i];
+  }
+
+  backend.multiply(result, data, data2);
+
+  auto realResult = naivemult_negacyclic(N, pol1, pol2);
+  for(std::size_t i = 0; i < N; ++i) {
+    int expected = ((realResult[i].toInt() % Modulo) + Modulo) % Modulo;
+    if(result[i] != expected) {
+      std::cout << "Backend " << backend.name << " failed at position " << i << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  srand(static_cast<unsigned>(time(NULL)));
+
+  if(!checkInstructions())
+    return 1;
+
+  std::size_t numFailures = 0;
+  for(auto backend : nussbaumer1024_supported_backends()) {
+    for(std::size_t i = 0; i < NumTests; ++i) {
+      if(!runTest(*backend))
+        ++numFailures;
+    }
+  }
+
+  if(numFailures != 0) {
+    std::cout << "TEST FAILED: " << numFailures << " failures" << std::endl;
+    return 1;
+  }
+  return 0;
+}
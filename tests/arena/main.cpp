@@ -0,0 +1,192 @@
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "Polynomial.h"
+#include "RingModElt.h"
+#include "LazyRingModElt.h"
+#include "MontgomeryRingElt.h"
+#include "../knuth_optimized4/NegaNussbaumer.h"
+#include "NussbaumerArena.h"
+#include "NegaConvo.h"
+#include "WallClock.h"
+#include "compat/Poly.h"
+
+/// Number of runs per setting; the fastest one is reported
+static const std::size_t NumRuns = 5;
+
+// Every heap allocation goes through the operators below, which keep these statistics.
+static std::size_t numAllocations = 0;
+static std::size_t liveBytes = 0;
+static std::size_t peakBytes = 0;
+
+/// Room before each allocation to store its size, keeping the alignment of malloc
+static const std::size_t HeaderSize = alignof(std::max_align_t);
+
+void* operator new(std::size_t size) {
+  unsigned char* raw = static_cast<unsigned char*>(std::malloc(size + HeaderSize));
+  if(raw == nullptr)
+    throw std::bad_alloc();
+
+  *reinterpret_cast<std::size_t*>(raw) = size;
+  ++numAllocations;
+  liveBytes += size;
+  if(liveBytes > peakBytes)
+    peakBytes = liveBytes;
+  return raw + HeaderSize;
+}
+
+void operator delete(void* ptr) noexcept {
+  if(ptr == nullptr)
+    return;
+
+  // Through an integer, as the compiler may see the pointer as the start of an array
+  unsigned char* raw = reinterpret_cast<unsigned char*>(reinterpret_cast<std::uintptr_t>(ptr) - HeaderSize);
+  liveBytes -= *reinterpret_cast<std::size_t*>(raw);
+  std::free(raw);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  operator delete(ptr);
+}
+
+
+/**
+ * The allocations of a part of the program.
+ */
+struct AllocStats {
+  std::size_t allocations;
+  std::size_t peakBytes;
+};
+
+
+/**
+ * Start counting allocations, with the peak measured from the memory in use now.
+ */
+static void startAllocStats() {
+  numAllocations = 0;
+  peakBytes = liveBytes;
+}
+
+
+/**
+ * Get the allocations since startAllocStats.
+ * @param[in] baseBytes   The memory in use at startAllocStats, which is not counted in the peak.
+ * @return    The number of allocations and the peak memory.
+ */
+static AllocStats getAllocStats(std::size_t baseBytes) {
+  return AllocStats{numAllocations, peakBytes - baseBytes};
+}
+
+
+/**
+ * Compare the allocating NegaNussbaumer with the one taking its scratch memory from an arena, and
+ * print the allocations, the peak memory and the time of each.
+ * @param[in] name       The name of the ring type and settings, for printing.
+ * @param[in] in1        The first polynomial.
+ * @param[in] in2        The second polynomial.
+ * @param[in] cutoff     The recursion cutoff.
+ * @param[in] baseCase   The base case multiplication.
+ * @return    Whether both give the correct product.
+ */
+template<typename RingElt>
+bool compare(const std::string& name, const Polynomial<std::uint16_t>& in1, const Polynomial<std::uint16_t>& in2,
+             std::size_t cutoff, NussbaumerBaseCase baseCase) {
+  Polynomial<RingElt> p1 = in1, p2 = in2;
+  NegaNussbaumer<RingElt> nussbaumer(PARAM_N, cutoff, baseCase);
+  std::cout << name << ":" << std::endl;
+
+  // Allocating every transformed polynomial and intermediate product
+  Polynomial<RingElt> result;
+  AllocStats stats = AllocStats();
+  std::size_t additions = 0, multiplications = 0;
+  double time = 0;
+  for(std::size_t run = 0; run < NumRuns; ++run) {
+    std::size_t baseBytes = liveBytes;
+    RingElt::getOpCount().reset();
+    startAllocStats();
+    WallClock clock;
+    auto resTrans = nussbaumer.componentwise(nussbaumer.transform(p1), nussbaumer.transform(p2));
+    result = nussbaumer.inverseTransform(resTrans);
+    double runTime = clock.reset().getMicroseconds();
+    if(run == 0) {
+      stats = getAllocStats(baseBytes);
+      additions = RingElt::getOpCount().getNumAdditions();
+      multiplications = RingElt::getOpCount().getNumMultiplications();
+      std::cout << "  Allocating: " << RingElt::getOpCount().reset() << std::endl;
+    }
+    if(run == 0 || runTime < time)
+      time = runTime;
+  }
+  std::cout << "    " << stats.allocations << " allocations, peak " << stats.peakBytes << " bytes, "
+            << time << " us" << std::endl;
+
+  // With an arena, sized once for the whole recursion
+  std::size_t baseBytes = liveBytes;
+  startAllocStats();
+  NussbaumerArena<RingElt> arena(nussbaumer.getScratchSize());
+  AllocStats arenaStats = getAllocStats(baseBytes);
+
+  Polynomial<RingElt> arenaResult(PARAM_N);
+  PolynomialView<RingElt> arenaResultView(&arenaResult[0], PARAM_N);
+  for(std::size_t run = 0; run < NumRuns; ++run) {
+    baseBytes = liveBytes;
+    RingElt::getOpCount().reset();
+    startAllocStats();
+    WallClock clock;
+    nussbaumer.multiply(arenaResultView, p1, p2, arena);
+    double runTime = clock.reset().getMicroseconds();
+    if(run == 0) {
+      stats = getAllocStats(baseBytes);
+      if(RingElt::getOpCount().getNumAdditions() != additions ||
+         RingElt::getOpCount().getNumMultiplications() != multiplications) {
+        std::cerr << "TEST FAILED: " << name << " takes other operations with an arena!" << std::endl;
+        return false;
+      }
+      std::cout << "  Arena: " << RingElt::getOpCount().reset() << std::endl;
+    }
+    if(run == 0 || runTime < time)
+      time = runTime;
+  }
+  std::cout << "    " << stats.allocations << " allocations, peak " << stats.peakBytes << " bytes, "
+            << time << " us" << std::endl;
+  std::cout << "    Arena: 1 allocation of " << arenaStats.peakBytes << " bytes, of which " << arena.getPeak()*sizeof(RingElt)
+            << " used" << std::endl << std::endl;
+
+  if(stats.allocations != 0) {
+    std::cerr << "TEST FAILED: " << name << " allocates with an arena!" << std::endl;
+    return false;
+  }
+
+  auto expected = naivemult_negacyclic(PARAM_N, p1, p2);
+  if(nussbaumer.correct(result) != expected || nussbaumer.correct(arenaResult) != expected) {
+    std::cerr << "TEST FAILED: " << name << " results not equal!" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main() {
+  poly a, b;
+  poly_create_random(&a);
+  poly_create_random(&b);
+  Polynomial<std::uint16_t> in1 = a.toPolynomial();
+  Polynomial<std::uint16_t> in2 = b.toPolynomial();
+
+  typedef MontgomeryRingElt<PARAM_Q, std::uint32_t, NoOpCount> UncountedMontgomery;
+  bool ok = compare<RingModElt<PARAM_Q>>("RingModElt", in1, in2, 2, NussbaumerBaseCase::Karatsuba) &&
+            compare<RingModElt<PARAM_Q>>("RingModElt, Karatsuba below 8", in1, in2, 8, NussbaumerBaseCase::Karatsuba) &&
+            compare<UncountedRingModElt<PARAM_Q>>("Uncounted RingModElt", in1, in2, 2, NussbaumerBaseCase::Karatsuba) &&
+            compare<UncountedRingModElt<PARAM_Q>>("Uncounted RingModElt, schoolbook below 8", in1, in2, 8,
+                                                  NussbaumerBaseCase::Schoolbook) &&
+            compare<UncountedRingModElt<PARAM_Q>>("Uncounted RingModElt, Karatsuba below 8", in1, in2, 8,
+                                                  NussbaumerBaseCase::Karatsuba) &&
+            compare<UncountedMontgomery>("Uncounted MontgomeryRingElt, schoolbook below 8", in1, in2, 8,
+                                         NussbaumerBaseCase::Schoolbook) &&
+            compare<LazyRingModElt<PARAM_Q>>("LazyRingModElt, Karatsuba below 8", in1, in2, 8,
+                                             NussbaumerBaseCase::Karatsuba);
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+
+#include "Polynomial.h"
+#include "RingModElt.h"
+#include "MontgomeryRingElt.h"
+#include "RingPow2Elt.h"
+#include "../knuth_optimized4/NegaNussbaumer.h"
+#include "../knuth_optimized4/NussbaumerAutotune.h"
+#include "NussbaumerWisdom.h"
+#include "NegaConvo.h"
+#include "compat/Poly.h"
+
+/**
+ * Tune the split for a ring type, and check that a NegaNussbaumer constructed afterwards uses it
+ * and multiplies correctly.
+ * @param[in] name     The name of the ring type, for printing.
+ * @param[in] in1      The first polynomial.
+ * @param[in] in2      The second polynomial.
+ * @return    Whether the test succeeded.
+ */
+template<typename RingElt>
+bool tune(const std::string& name, const Polynomial<std::uint16_t>& in1, const Polynomial<std::uint16_t>& in2) {
+  std::cout << name << ":" << std::endl;
+  std::size_t lgM = nussbaumerAutotune<RingElt>(PARAM_N, 8, NussbaumerBaseCase::Schoolbook, 5, &std::cout);
+  std::cout << "  Best: m = " << (std::size_t(1) << lgM) << std::endl << std::endl;
+
+  NegaNussbaumer<RingElt> nussbaumer(PARAM_N, 8, NussbaumerBaseCase::Schoolbook);
+  if(nussbaumer.getLgM() != lgM) {
+    std::cerr << "TEST FAILED: " << name << " does not use the tuned split" << std::endl;
+    return false;
+  }
+
+  Polynomial<RingElt> p1 = in1, p2 = in2;
+  auto resTrans = nussbaumer.componentwise(nussbaumer.transform(p1), nussbaumer.transform(p2));
+  if(nussbaumer.correct(nussbaumer.inverseTransform(resTrans)) != naivemult_negacyclic(PARAM_N, p1, p2)) {
+    std::cerr << "TEST FAILED: " << name << " results not equal with the tuned split" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  // The wisdom is written to the given file, or to bin/ when run from the repository
+  std::string filename = argc > 1 ? argv[1] : "bin/nussbaumer.wisdom";
+
+  typedef RingModElt<PARAM_Q> RingType;
+  poly a, b;
+  poly_create_random(&a);
+  poly_create_random(&b);
+  Polynomial<std::uint16_t> in1 = a.toPolynomial();
+  Polynomial<std::uint16_t> in2 = b.toPolynomial();
+
+  // Every split gives the same product, at a different operation count
+  Polynomial<RingType> p1 = in1, p2 = in2;
+  auto expected = naivemult_negacyclic(PARAM_N, p1, p2);
+  for(std::size_t lgM = 1; lgM <= (nussbaumerLog2(PARAM_N) >> 1); ++lgM) {
+    NegaNussbaumer<RingType> nussbaumer(PARAM_N, 2, NussbaumerBaseCase::Karatsuba, lgM);
+    RingType::getOpCount().reset();
+    auto resTrans = nussbaumer.componentwise(nussbaumer.transform(p1), nussbaumer.transform(p2));
+    auto result = nussbaumer.correct(nussbaumer.inverseTransform(resTrans));
+    std::cout << "m = " << (std::size_t(1) << lgM) << ": " << RingType::getOpCount().reset() << std::endl;
+    if(result != expected) {
+      std::cerr << "TEST FAILED: results not equal for m = " << (std::size_t(1) << lgM) << std::endl;
+      return 1;
+    }
+  }
+  std::cout << std::endl;
+
+  if(!tune<UncountedRingModElt<PARAM_Q>>("Uncounted RingModElt", in1, in2) ||
+     !tune<MontgomeryRingElt<PARAM_Q, std::uint32_t, NoOpCount>>("Uncounted MontgomeryRingElt", in1, in2))
+    return 1;
+
+  // The constructor must find the splits again after a round trip through the file
+  NussbaumerWisdom& wisdom = NussbaumerWisdom::global();
+  std::size_t lgM = NegaNussbaumer<UncountedRingModElt<PARAM_Q>>(PARAM_N, 8, NussbaumerBaseCase::Schoolbook).getLgM();
+  if(!wisdom.save(filename)) {
+    std::cerr << "TEST FAILED: could not write " << filename << std::endl;
+    return 1;
+  }
+  wisdom.clear();
+  if(!wisdom.load(filename)) {
+    std::cerr << "TEST FAILED: could not read " << filename << std::endl;
+    return 1;
+  }
+  if(NegaNussbaumer<UncountedRingModElt<PARAM_Q>>(PARAM_N, 8, NussbaumerBaseCase::Schoolbook).getLgM() != lgM) {
+    std::cerr << "TEST FAILED: the loaded wisdom differs" << std::endl;
+    return 1;
+  }
+  std::cout << "Wisdom written to " << filename << std::endl;
+
+  // A split NegaNussbaumer cannot use must be rejected when loading, and ignored when set directly
+  typedef UncountedRingModElt<PARAM_Q> FastType;
+  const char* ring = typeid(FastType).name();
+  for(const char* line : {" 64 2 0 0", " 64 2 0 4", " 48 2 0 2", " 1 2 0 1"}) {
+    std::string badFilename = filename + ".bad";
+    std::ofstream(badFilename) << ring << line << "\n";
+    bool loaded = NussbaumerWisdom().load(badFilename);
+    std::remove(badFilename.c_str());
+    if(loaded) {
+      std::cerr << "TEST FAILED: the invalid split \"" << line + 1 << "\" was loaded" << std::endl;
+      return 1;
+    }
+  }
+  wisdom.set(ring, 64, 2, static_cast<int>(NussbaumerBaseCase::Karatsuba), 0);
+  wisdom.set(ring, 256, 2, static_cast<int>(NussbaumerBaseCase::Karatsuba), 5);
+  for(std::size_t N : {64, 256}) {
+    NegaNussbaumer<FastType> nussbaumer(N);
+    Polynomial<FastType> q1(N), q2(N);
+    for(std::size_t i = 0; i < N; ++i) {
+      q1[i] = in1[i];
+      q2[i] = in2[i];
+    }
+    auto resTrans = nussbaumer.componentwise(nussbaumer.transform(q1), nussbaumer.transform(q2));
+    if(nussbaumer.getLgM() != (nussbaumerLog2(N) >> 1) ||
+       nussbaumer.correct(nussbaumer.inverseTransform(resTrans)) != naivemult_negacyclic(N, q1, q2)) {
+      std::cerr << "TEST FAILED: an out-of-range split for N = " << N << " was not ignored" << std::endl;
+      return 1;
+    }
+  }
+
+  // Modulo 2^11, the ring has only the extra bits of the default split, so a measured split that
+  // needs more must not be used
+  typedef RingPow2Elt<11, NoOpCount> Pow2Type;
+  typedef RingPow2Elt<11 + nussbaumerFactorBits(PARAM_N), NoOpCount> WidePow2Type;
+  wisdom.set(typeid(WidePow2Type).name(), PARAM_N, 2, static_cast<int>(NussbaumerBaseCase::Karatsuba), 1);
+  NegaNussbaumer<WidePow2Type> pow2Nussbaumer(PARAM_N);
+  Polynomial<Pow2Type> pow2P1 = in1, pow2P2 = in2;
+  Polynomial<WidePow2Type> wideP1 = pow2P1, wideP2 = pow2P2;
+  auto pow2ResTrans = pow2Nussbaumer.componentwise(pow2Nussbaumer.transform(wideP1), pow2Nussbaumer.transform(wideP2));
+  auto pow2Result = pow2Nussbaumer.correctByShift<Pow2Type>(pow2Nussbaumer.inverseTransform(pow2ResTrans));
+  if(pow2Nussbaumer.getFactorBits() > nussbaumerFactorBits(PARAM_N) ||
+     pow2Result != naivemult_negacyclic(PARAM_N, pow2P1, pow2P2)) {
+    std::cerr << "TEST FAILED: a split with too many factor bits was used modulo 2^11" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
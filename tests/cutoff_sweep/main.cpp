@@ -0,0 +1,96 @@
+#include <iostream>
+#include <string>
+#include <cstdint>
+
+#include "Polynomial.h"
+#include "RingModElt.h"
+#include "LazyRingModElt.h"
+#include "MontgomeryRingElt.h"
+#include "BarrettRingElt.h"
+#include "../knuth_optimized4/NegaNussbaumer.h"
+#include "NegaConvo.h"
+#include "WallClock.h"
+#include "compat/Poly.h"
+
+/// Number of runs per setting; the fastest one is reported
+static const std::size_t NumRuns = 5;
+static bool failed = false;
+
+/**
+ * Multiply with knuth_optimized4's NegaNussbaumer for every recursion cutoff and base case, and
+ * print the operation counts and the time of each, followed by the fastest setting.
+ * @param[in] name     The name of the ring type, for printing.
+ * @param[in] in1      The first polynomial.
+ * @param[in] in2      The second polynomial.
+ */
+template<typename RingElt>
+void sweep(const std::string& name, const Polynomial<std::uint16_t>& in1, const Polynomial<std::uint16_t>& in2) {
+  Polynomial<RingElt> p1 = in1, p2 = in2;
+  auto expected = naivemult_negacyclic(PARAM_N, p1, p2);
+
+  std::cout << name << ":" << std::endl;
+  double bestTime = 0;
+  std::size_t bestCutoff = 0;
+  NussbaumerBaseCase bestBaseCase = NussbaumerBaseCase::Karatsuba;
+
+  // The top level always transforms, so the componentwise products are at most this large
+  std::size_t maxCutoff = std::size_t(1) << (nussbaumerLog2(PARAM_N) - (nussbaumerLog2(PARAM_N) >> 1));
+  for(std::size_t cutoff = 2; cutoff <= maxCutoff; cutoff *= 2) {
+    for(NussbaumerBaseCase baseCase : {NussbaumerBaseCase::Karatsuba, NussbaumerBaseCase::Schoolbook}) {
+      // At the cutoff of 2 the base case is not used
+      if(cutoff == 2 && baseCase == NussbaumerBaseCase::Schoolbook)
+        continue;
+
+      double time = 0;
+      for(std::size_t run = 0; run < NumRuns; ++run) {
+        NegaNussbaumer<RingElt> nussbaumer(PARAM_N, cutoff, baseCase);
+        RingElt::getOpCount().reset();
+        WallClock clock;
+        auto resTrans = nussbaumer.componentwise(nussbaumer.transform(p1), nussbaumer.transform(p2));
+        auto result = nussbaumer.correct(nussbaumer.inverseTransform(resTrans));
+        double runTime = clock.reset().getMicroseconds();
+        auto opCount = RingElt::getOpCount().reset();
+
+        if(result != expected) {
+          std::cerr << "TEST FAILED: " << name << ", cutoff " << cutoff << " gives a wrong result" << std::endl;
+          failed = true;
+        }
+        if(run == 0) {
+          std::cout << "  Cutoff " << cutoff << (baseCase == NussbaumerBaseCase::Karatsuba ? ", Karatsuba: " :
+                                                                                            ", schoolbook: ")
+                    << opCount;
+        }
+        if(run == 0 || runTime < time)
+          time = runTime;
+      }
+      std::cout << ", " << time << " us" << std::endl;
+
+      if(bestCutoff == 0 || time < bestTime) {
+        bestTime = time;
+        bestCutoff = cutoff;
+        bestBaseCase = baseCase;
+      }
+    }
+  }
+
+  std::cout << "  Fastest: cutoff " << bestCutoff
+            << (bestBaseCase == NussbaumerBaseCase::Karatsuba ? " with Karatsuba, " : " with schoolbook, ")
+            << bestTime << " us" << std::endl << std::endl;
+}
+
+int main() {
+  poly a, b;
+  poly_create_random(&a);
+  poly_create_random(&b);
+  Polynomial<std::uint16_t> in1 = a.toPolynomial();
+  Polynomial<std::uint16_t> in2 = b.toPolynomial();
+
+  sweep<RingModElt<PARAM_Q>>("RingModElt", in1, in2);
+  sweep<UncountedRingModElt<PARAM_Q>>("Uncounted RingModElt", in1, in2);
+  sweep<LazyRingModElt<PARAM_Q>>("LazyRingModElt", in1, in2);
+  sweep<LazyRingModElt<PARAM_Q, NoOpCount>>("Uncounted LazyRingModElt", in1, in2);
+  sweep<MontgomeryRingElt<PARAM_Q, std::uint32_t, NoOpCount>>("Uncounted MontgomeryRingElt", in1, in2);
+  sweep<BarrettRingElt<PARAM_Q, std::uint32_t, NoOpCount>>("Uncounted BarrettRingElt", in1, in2);
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <string>
+#include <random>
+
+#include "Polynomial.h"
+#include "RingModElt.h"
+#include "MontgomeryRingElt.h"
+#include "../knuth_optimized4/NegaNussbaumer.h"
+#include "../knuth_optimized4/CyclicNussbaumer.h"
+#include "NegaConvo.h"
+#include "WallClock.h"
+#include "compat/Poly.h"
+
+/// Number of runs per size; the fastest one is reported
+static const std::size_t NumRuns = 3;
+static const std::size_t Cutoff = 16;
+static const NussbaumerBaseCase BaseCase = NussbaumerBaseCase::Schoolbook;
+static bool failed = false;
+
+/**
+ * Time a multiplication over NumRuns runs, and print its operation count.
+ * @param[in]  label      The label to print.
+ * @param[in]  expected   The expected result.
+ * @param[in]  mult       The multiplication to run.
+ * @return     The fastest time in microseconds.
+ */
+template<typename RingElt, typename Mult>
+double timeMultiply(const std::string& label, const Polynomial<RingElt>& expected, const Mult& mult) {
+  double time = 0;
+  for(std::size_t run = 0; run < NumRuns; ++run) {
+    RingElt::getOpCount().reset();
+    WallClock clock;
+    Polynomial<RingElt> result = mult();
+    double runTime = clock.reset().getMicroseconds();
+    auto opCount = RingElt::getOpCount().reset();
+
+    if(result != expected) {
+      std::cerr << "TEST FAILED: " << label << " gives a wrong result" << std::endl;
+      failed = true;
+    }
+    if(run == 0)
+      std::cout << "  " << label << ": " << opCount;
+    if(run == 0 || runTime < time)
+      time = runTime;
+  }
+  std::cout << ", " << time << " us" << std::endl;
+  return time;
+}
+
+/**
+ * Multiply random polynomials of N coefficients modulo u^N - 1 and in full, with CyclicNussbaumer
+ * and with the schoolbook product, and for the full product also modulo u^2N + 1 with
+ * NegaNussbaumer, where it does not wrap around.
+ * @param[in]     name        The name of the ring type, for printing.
+ * @param[in,out] generator   The random generator for the inputs.
+ */
+template<typename RingElt>
+void run(const std::string& name, std::mt19937& generator) {
+  std::cout << name << ":" << std::endl;
+  std::uniform_int_distribution<int> distribution(0, PARAM_Q - 1);
+
+  for(std::size_t N = 256; N <= 2048; N *= 2) {
+    Polynomial<RingElt> p1(N), p2(N);
+    for(std::size_t i = 0; i < N; ++i) {
+      p1[i] = distribution(generator);
+      p2[i] = distribution(generator);
+    }
+    std::string size = std::to_string(N);
+
+    // The schoolbook products, which the others are checked against
+    Polynomial<RingElt> full, cyclic;
+    full = p1;
+    full *= p2;
+    cyclic = naivemult_cyclic(N, p1, p2);
+
+    CyclicNussbaumer<RingElt> cyclicNussbaumer(N, Cutoff, BaseCase);
+    timeMultiply("Cyclic " + size + ", schoolbook", cyclic, [&]() { return naivemult_cyclic(N, p1, p2); });
+    timeMultiply("Cyclic " + size + ", Nussbaumer", cyclic, [&]() { return cyclicNussbaumer.multiply(p1, p2); });
+
+    NegaNussbaumer<RingElt> nussbaumer(2*N, Cutoff, BaseCase);
+    timeMultiply("Full " + size + ", schoolbook", full, [&]() { return p1*p2; });
+    timeMultiply("Full " + size + ", cyclic Nussbaumer", full, [&]() {
+      return CyclicNussbaumer<RingElt>::multiplyFull(p1, p2, Cutoff, BaseCase);
+    });
+    timeMultiply("Full " + size + ", negacyclic Nussbaumer of " + std::to_string(2*N), full, [&]() {
+      Polynomial<RingElt> padded1(2*N), padded2(2*N);
+      for(std::size_t i = 0; i < N; ++i) {
+        padded1[i] = p1[i];
+        padded2[i] = p2[i];
+      }
+      auto ret = nussbaumer.correct(nussbaumer.inverseTransform(
+                     nussbaumer.componentwise(nussbaumer.transform(padded1), nussbaumer.transform(padded2))));
+      ret.setSize(2*N - 1);
+      return ret;
+    });
+  }
+  std::cout << std::endl;
+}
+
+int main() {
+  std::mt19937 generator(42);
+  run<RingModElt<PARAM_Q>>("RingModElt", generator);
+  run<MontgomeryRingElt<PARAM_Q>>("MontgomeryRingElt", generator);
+
+  // Small and odd sizes of the full product, against the schoolbook product
+  typedef RingModElt<PARAM_Q> RingType;
+  std::uniform_int_distribution<int> distribution(0, PARAM_Q - 1);
+  for(std::size_t size1 : {1, 3, 17, 100})
+    for(std::size_t size2 : {1, 2, 64, 129}) {
+      Polynomial<RingType> p1(size1), p2(size2);
+      for(std::size_t i = 0; i < size1; ++i)
+        p1[i] = distribution(generator);
+      for(std::size_t i = 0; i < size2; ++i)
+        p2[i] = distribution(generator);
+      if(CyclicNussbaumer<RingType>::multiplyFull(p1, p2) != p1*p2) {
+        std::cerr << "TEST FAILED: full product of " << size1 << " and " << size2
+                  << " coefficients gives a wrong result" << std::endl;
+        failed = true;
+      }
+    }
+
+  return failed ? 1 : 0;
+}
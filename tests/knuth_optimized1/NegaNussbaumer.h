@@ -13,6 +13,8 @@
 #include <cmath>
 
 #include "Polynomial.h"
+#include "PolynomialMatrix.h"
+#include "Butterfly.h"
 #include "BitManip.h"
 
 /**
@@ -23,22 +25,18 @@
 template<typename RingElt>
 class NegaNussbaumer {
 public:
-  /// Transformed polynomial
-  typedef std::vector<Polynomial<RingElt>> Transformed;
+  /// Transformed polynomial: 2m polynomials of r coefficients, in one contiguous block
+  typedef PolynomialMatrix<RingElt> Transformed;
 
   NegaNussbaumer(std::size_t N);
 
-  Transformed transform(const Polynomial<RingElt>& orig) const;
+  Transformed transform(const ConstPolynomialView<RingElt>& orig) const;
   Polynomial<RingElt> inverseTransform(const Transformed& trans) const;
 
   Transformed componentwise(const Transformed& t1, const Transformed& t2) const;
 
-  static Polynomial<RingElt> multiply(std::size_t N, const Polynomial<RingElt>& p1, const Polynomial<RingElt>& p2);
-
-protected:
-  Polynomial<RingElt> rotatePolynomial(const Polynomial<RingElt>& pol, int steps) const;
-
-  Polynomial<RingElt> addRotatedPolynomial(const Polynomial<RingElt>& p1, const Polynomial<RingElt>& p2, int steps) const;
+  static Polynomial<RingElt> multiply(std::size_t N, const ConstPolynomialView<RingElt>& p1,
+                                      const ConstPolynomialView<RingElt>& p2);
 
 private:
   std::size_t n_;
@@ -86,8 +84,8 @@ NegaNussbaumer<RingElt>::NegaNussbaumer(
 template<typename RingElt>
 Polynomial<RingElt> NegaNussbaumer<RingElt>::multiply(
                                         std::size_t N,
-                                        const Polynomial<RingElt>& p1,
-                                        const Polynomial<RingElt>& p2
+                                        const ConstPolynomialView<RingElt>& p1,
+                                        const ConstPolynomialView<RingElt>& p2
                                                      ) {
   // Trivial case modulo X^2 + 1.
   if(N == 2) {
@@ -118,11 +116,9 @@ typename NegaNussbaumer<RingElt>::Transformed NegaNussbaumer<RingElt>::component
                                                                    const Transformed& t1,
                                                                    const Transformed& t2
                                                                                ) const {
-  Transformed resTrans;
-  for(std::size_t i = 0; i < t1.size(); ++i) {
-    auto term = NegaNussbaumer<RingElt>::multiply(r_, t1[i], t2[i]);
-    resTrans.push_back(term);
-  }
+  Transformed resTrans(t1.getNumRows(), r_);
+  for(std::size_t i = 0; i < t1.getNumRows(); ++i)
+    resTrans[i] = NegaNussbaumer<RingElt>::multiply(r_, t1[i], t2[i]);
 
   return resTrans;
 }
@@ -137,10 +133,10 @@ typename NegaNussbaumer<RingElt>::Transformed NegaNussbaumer<RingElt>::component
 template<typename RingElt>
 typename NegaNussbaumer<RingElt>::Transformed
                                     NegaNussbaumer<RingElt>::transform(
-                                            const Polynomial<RingElt>& orig
+                                            const ConstPolynomialView<RingElt>& orig
                                                                       ) const {
   assert(orig.getSize() == (1u << n_));
-  Transformed trans(2*m_, Polynomial<RingElt>(r_));
+  Transformed trans(2*m_, r_);
 
   // First get the polynomials to perform the fourier transform on. These are
   // 2m polynomials of which r coefficients will be considered, where two sets
@@ -171,9 +167,7 @@ typename NegaNussbaumer<RingElt>::Transformed
         // Now, we set (simultaneously):
         // trans[e] = trans[e] + u^k*trans[f]
         // trans[f] = trans[e] - u^k*trans[f]
-        auto tmp = addRotatedPolynomial(trans[e], trans[f], k);
-        trans[f] = addRotatedPolynomial(trans[e], trans[f], k + r_);
-        trans[e] = tmp;
+        butterflyDit(trans[e], trans[f], k);
       }
     }
   }
@@ -208,11 +202,7 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::inverseTransform(
         e = s + t;
         f = e + (1u << j);
 
-        Polynomial<RingElt> eNew(r_), fNew(r_);
-        eNew = z[e] + z[f];
-        fNew = rotatePolynomial(z[e] - z[f], k);
-        z[e] = eNew;
-        z[f] = fNew;
+        butterflyDif(z[e], z[f], k);
       }
     }
   }
@@ -228,8 +218,8 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::inverseTransform(
   inverse = inverseElt.toInt();
 
   // Multiply with the inverse
-  for(auto& p : z)
-    p *= inverse;
+  for(std::size_t i = 0; i < z.getNumRows(); ++i)
+    z[i] *= inverse;
 
 
   // Unpack the polynomial
@@ -244,75 +234,4 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::inverseTransform(
   return res;
 }
 
-
-/**
- * The function "rotates" the polynomial, as though multiplying it with u^steps,
- * modulo u^r + 1.
- * @param[in] pol    The polynomial to rotate.
- * @param[in] steps  The number of steps to rotate.
- * @return    The resulting polynomial.
- */
-template<typename RingElt>
-Polynomial<RingElt> NegaNussbaumer<RingElt>::rotatePolynomial(
-                                              const Polynomial<RingElt>& pol,
-                                              int steps
-                                                             ) const {
-  Polynomial<RingElt> ret(r_);
-
-  // Get "steps" as negative value, with 2*r_ < steps <= 0
-  steps %= 2*r_;
-  if(steps > 0)
-    steps -= 2*r_;
-
-  for(std::size_t i = 0; i < r_; ++i) {
-    int src = static_cast<int>(i) - steps;
-    std::size_t srcIndex = static_cast<size_t>(src) % r_;
-    bool signInverse = (src / r_) & 1;
-
-    if(signInverse)
-      ret[i] = -pol[srcIndex];
-    else
-      ret[i] = pol[srcIndex];
-  }
-
-  return ret;
-}
-
-
-/**
- * Calculate p1 + (u^steps)*p2 modulo u^r + 1. This could be done by a separate
- * rotate/add step, but this would require possible negations followed by
- * additions, rather than immediately subtracting.
- * @param[in] p1      The first polynomial
- * @param[in] p2      The second polynomial.
- * @param[in] steps   The number of steps to "rotate" p2.
- * @return    p1 + (u^steps)*p2 modulo u^r + 1.
- */
-template<typename RingElt>
-Polynomial<RingElt> NegaNussbaumer<RingElt>::addRotatedPolynomial(
-                                                 const Polynomial<RingElt>& p1,
-                                                 const Polynomial<RingElt>& p2,
-                                                 int steps
-                                                                 ) const {
-  Polynomial<RingElt> ret(r_);
-
-  // Get "steps" as negative value, with 2*r_ < steps <= 0
-  steps %= 2*r_;
-  if(steps > 0)
-    steps -= 2*r_;
-
-  for(std::size_t i = 0; i < r_; ++i) {
-    int src = static_cast<int>(i) - steps;
-    std::size_t srcIndex = static_cast<size_t>(src) % r_;
-    bool signInverse = (src / r_) & 1;
-
-    if(signInverse)
-      ret[i] = p1[i] - p2[srcIndex];
-    else
-      ret[i] = p1[i] + p2[srcIndex];
-  }
-
-  return ret;
-}
-
 #endif
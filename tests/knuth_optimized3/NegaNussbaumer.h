@@ -13,6 +13,8 @@
 #include <cmath>
 
 #include "Polynomial.h"
+#include "PolynomialMatrix.h"
+#include "Butterfly.h"
 #include "BitManip.h"
 
 /**
@@ -23,21 +25,20 @@
 template<typename RingElt>
 class NegaNussbaumer {
 public:
-  /// Transformed polynomial
-  typedef std::vector<Polynomial<RingElt>> Transformed;
+  /// Transformed polynomial: 2m polynomials of r coefficients, in one contiguous block
+  typedef PolynomialMatrix<RingElt> Transformed;
 
   NegaNussbaumer(std::size_t N);
 
-  Transformed transform(const Polynomial<RingElt>& orig) const;
+  Transformed transform(const ConstPolynomialView<RingElt>& orig) const;
   Polynomial<RingElt> inverseTransform(const Transformed& trans) const;
 
   Transformed componentwise(const Transformed& t1, const Transformed& t2) const;
 
-  static Polynomial<RingElt> multiply(std::size_t N, const Polynomial<RingElt>& p1, const Polynomial<RingElt>& p2);
+  static Polynomial<RingElt> multiply(std::size_t N, const ConstPolynomialView<RingElt>& p1,
+                                      const ConstPolynomialView<RingElt>& p2);
 
 protected:
-  Polynomial<RingElt> addRotatedPolynomial(const Polynomial<RingElt>& p1, const Polynomial<RingElt>& p2, int steps) const;
-
 private:
   std::size_t n_;
   std::size_t m_, r_;
@@ -84,8 +85,8 @@ NegaNussbaumer<RingElt>::NegaNussbaumer(
 template<typename RingElt>
 Polynomial<RingElt> NegaNussbaumer<RingElt>::multiply(
                                         std::size_t N,
-                                        const Polynomial<RingElt>& p1,
-                                        const Polynomial<RingElt>& p2
+                                        const ConstPolynomialView<RingElt>& p1,
+                                        const ConstPolynomialView<RingElt>& p2
                                                      ) {
   // Trivial case modulo X^2 + 1.
   if(N == 2) {
@@ -116,12 +117,9 @@ typename NegaNussbaumer<RingElt>::Transformed NegaNussbaumer<RingElt>::component
                                                                    const Transformed& t1,
                                                                    const Transformed& t2
                                                                                ) const {
-  Transformed resTrans;
-  resTrans.push_back(Polynomial<RingElt>(r_));
-  for(std::size_t i = 1; i < t1.size(); ++i) {
-    auto term = NegaNussbaumer<RingElt>::multiply(r_, t1[i], t2[i]);
-    resTrans.push_back(term);
-  }
+  Transformed resTrans(t1.getNumRows(), r_);
+  for(std::size_t i = 1; i < t1.getNumRows(); ++i)
+    resTrans[i] = NegaNussbaumer<RingElt>::multiply(r_, t1[i], t2[i]);
 
   return resTrans;
 }
@@ -136,10 +134,10 @@ typename NegaNussbaumer<RingElt>::Transformed NegaNussbaumer<RingElt>::component
 template<typename RingElt>
 typename NegaNussbaumer<RingElt>::Transformed
                                     NegaNussbaumer<RingElt>::transform(
-                                            const Polynomial<RingElt>& orig
+                                            const ConstPolynomialView<RingElt>& orig
                                                                       ) const {
   assert(orig.getSize() == (1u << n_));
-  Transformed trans(2*m_, Polynomial<RingElt>(r_));
+  Transformed trans(2*m_, r_);
 
   // First get the polynomials to perform the fourier transform on. These are
   // 2m polynomials of which r coefficients will be considered, where two sets
@@ -170,16 +168,8 @@ typename NegaNussbaumer<RingElt>::Transformed
         // Now, we set (simultaneously):
         // trans[e] = trans[e] + u^k*trans[f]
         // trans[f] = trans[e] - u^k*trans[f]
-        Polynomial<RingElt> tmp;
-        if(e == 0 && j == 0) {
-          // Don't calculate trans[0]; we don't need it.
-          tmp = Polynomial<RingElt>(r_);
-        }
-        else {
-          tmp = addRotatedPolynomial(trans[e], trans[f], k);
-        }
-        trans[f] = addRotatedPolynomial(trans[e], trans[f], k + r_);
-        trans[e] = tmp;
+        // Don't calculate trans[0]; we don't need it.
+        butterflyDit(trans[e], trans[f], k, e != 0 || j != 0);
       }
     }
   }
@@ -210,18 +200,17 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::inverseTransform(
         e = s + t;
         f = e + (1u << j);
 
-        Polynomial<RingElt> tmp;
         if(j == 0 && e == 0) {
+          // z[0] is 0, so this is a copy and a negation.
           z[e] = z[f];
-          z[f] = -z[f];
+          for(std::size_t i = 0; i < r_; ++i)
+            z[f][i] = -z[f][i];
         }
         else {
           // Now, we set (simultaneously):
           // z[e] = z[e] + u^k*z[f]
           // z[f] = z[e] - u^k*z[f]
-          tmp = addRotatedPolynomial(z[e], z[f], k);
-          z[f] = addRotatedPolynomial(z[e], z[f], k + r_);
-          z[e] = tmp;
+          butterflyDit(z[e], z[f], k);
         }
       }
     }
@@ -238,8 +227,8 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::inverseTransform(
   inverse = inverseElt.toInt();
 
   // Multiply with the inverse
-  for(auto& p : z)
-    p *= inverse;
+  for(std::size_t i = 0; i < z.getNumRows(); ++i)
+    z[i] *= inverse;
 
   // Subtract the last polynomial from each other
   for(std::size_t i = 0; i < 2*m_ - 1; ++i) {
@@ -261,41 +250,4 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::inverseTransform(
   return res;
 }
 
-
-/**
- * Calculate p1 + (u^steps)*p2 modulo u^r + 1. This could be done by a separate
- * rotate/add step, but this would require possible negations followed by
- * additions, rather than immediately subtracting.
- * @param[in] p1      The first polynomial
- * @param[in] p2      The second polynomial.
- * @param[in] steps   The number of steps to "rotate" p2.
- * @return    p1 + (u^steps)*p2 modulo u^r + 1.
- */
-template<typename RingElt>
-Polynomial<RingElt> NegaNussbaumer<RingElt>::addRotatedPolynomial(
-                                                 const Polynomial<RingElt>& p1,
-                                                 const Polynomial<RingElt>& p2,
-                                                 int steps
-                                                                 ) const {
-  Polynomial<RingElt> ret(r_);
-
-  // Get "steps" as negative value, with 2*r_ < steps <= 0
-  steps %= 2*r_;
-  if(steps > 0)
-    steps -= 2*r_;
-
-  for(std::size_t i = 0; i < r_; ++i) {
-    int src = static_cast<int>(i) - steps;
-    std::size_t srcIndex = static_cast<size_t>(src) % r_;
-    bool signInverse = (src / r_) & 1;
-
-    if(signInverse)
-      ret[i] = p1[i] - p2[srcIndex];
-    else
-      ret[i] = p1[i] + p2[srcIndex];
-  }
-
-  return ret;
-}
-
 #endif
@@ -5,6 +5,7 @@
 #include "RingModElt.h"
 #include "NegaNussbaumer.h"
 #include "NegaConvo.h"
+#include "WallClock.h"
 #include "compat/Poly.h"
 
 
@@ -19,15 +20,16 @@ int main() {
 
   // Perform Nussbaumer's algorithm, noting number of operations
   NegaNussbaumer<RingType> nussbaumer(PARAM_N);
+  WallClock clock;
   RingType::getOpCount().reset();
   auto trans1 = nussbaumer.transform(p1);
-  std::cout << "Transform 1: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Transform 1: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
   auto trans2 = nussbaumer.transform(p2);
-  std::cout << "Transform 2: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Transform 2: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
   auto resTrans = nussbaumer.componentwise(trans1, trans2);
-  std::cout << "Recurse: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Recurse: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
   auto result = nussbaumer.inverseTransform(resTrans);
-  std::cout << "Inverse transform: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Inverse transform: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
 
   // Validate the test succeeded
   if(result != naivemult_negacyclic(PARAM_N, p1, p2)) {
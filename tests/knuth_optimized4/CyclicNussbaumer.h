@@ -0,0 +1,212 @@
+/**
+ * @file CyclicNussbaumer.h
+ * @author Gerben van der Lubbe
+ *
+ * File containing the cyclic convolution and the full product of polynomials, built on Nussbaumer's
+ * negacyclic convolution.
+ */
+
+#ifndef CYCLICNUSSBAUMER_H
+#define CYCLICNUSSBAUMER_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "Polynomial.h"
+#include "PolynomialMatrix.h"
+#include "NegaConvo.h"
+#include "NegaNussbaumer.h"
+
+/**
+ * Class for multiplying modulo u^N - 1, with N a power of 2. As u^N - 1 = (u^(N/2) - 1)(u^(N/2) + 1),
+ * the product modulo u^N - 1 follows by the Chinese remainder theorem from the product modulo
+ * u^(N/2) - 1, calculated recursively, and the product modulo u^(N/2) + 1, calculated with
+ * NegaNussbaumer. Below 2*cutoff the cyclic product is calculated naively.
+ *
+ * Recombining the halves divides by 2 on every level; these factors are gathered with the factors
+ * of the NegaNussbaumer products, so that every coefficient is multiplied by one constant. Unlike
+ * NegaNussbaumer, the result needs no correction afterwards.
+ */
+template<typename RingElt>
+class CyclicNussbaumer {
+public:
+  CyclicNussbaumer(std::size_t N, std::size_t cutoff = 2,
+                   NussbaumerBaseCase baseCase = NussbaumerBaseCase::Karatsuba);
+
+  Polynomial<RingElt> multiply(const ConstPolynomialView<RingElt>& p1,
+                               const ConstPolynomialView<RingElt>& p2) const;
+
+  static Polynomial<RingElt> multiplyFull(const Polynomial<RingElt>& p1, const Polynomial<RingElt>& p2,
+                                          std::size_t cutoff = 2,
+                                          NussbaumerBaseCase baseCase = NussbaumerBaseCase::Karatsuba);
+
+private:
+  Polynomial<RingElt> multiply(std::size_t level, const Polynomial<RingElt>& p1,
+                               const Polynomial<RingElt>& p2) const;
+  static int getInverse(unsigned int bits);
+
+  std::size_t N_;
+  std::size_t cutoff_;
+  NussbaumerBaseCase baseCase_;
+  /// The number of levels with a negacyclic product, modulo u^(N/2) + 1, u^(N/4) + 1, ...
+  std::size_t levels_ = 0;
+  /// For each level l, the inverse of the factor 2^(l + 1) times that of its NegaNussbaumer, and
+  /// for the naive product at the last level L, the inverse of 2^L.
+  std::vector<int> inverses_;
+};
+
+
+/**
+ * Constructor for an object that multiplies modulo u^N - 1.
+ * @param[in] N         The "N" of the algorithm, a power of 2.
+ * @param[in] cutoff    The recursion cutoff of the negacyclic products (see NegaNussbaumer); the
+ *                      cyclic products of up to 2*cutoff coefficients are calculated naively.
+ * @param[in] baseCase  The multiplication to use at or below the cutoff.
+ */
+template<typename RingElt>
+CyclicNussbaumer<RingElt>::CyclicNussbaumer(
+                                    std::size_t N,
+                                    std::size_t cutoff,
+                                    NussbaumerBaseCase baseCase
+                                           )
+: N_(N), cutoff_(cutoff), baseCase_(baseCase)
+{
+  assert(N > 0 && (N & (N - 1)) == 0);
+
+  // The negacyclic products must be larger than 2 to use NegaNussbaumer
+  std::size_t n = N;
+  while(n > std::max<std::size_t>(2*cutoff, 4)) {
+    n >>= 1;
+    ++levels_;
+    inverses_.push_back(getInverse(NegaNussbaumer<RingElt>(n, cutoff, baseCase).getFactorBits() + levels_));
+  }
+  inverses_.push_back(getInverse(levels_));
+}
+
+
+/**
+ * Multiply two polynomials modulo u^N - 1.
+ * @param[in] p1   The first polynomial to multiply.
+ * @param[in] p2   The second polynomial to multiply.
+ * @return    The product.
+ */
+template<typename RingElt>
+Polynomial<RingElt> CyclicNussbaumer<RingElt>::multiply(
+                                        const ConstPolynomialView<RingElt>& p1,
+                                        const ConstPolynomialView<RingElt>& p2
+                                                       ) const {
+  assert(p1.getSize() == N_ && p2.getSize() == N_);
+  return multiply(0, p1, p2);
+}
+
+
+/**
+ * Calculate the full product of two polynomials, of p1.getSize() + p2.getSize() - 1 coefficients.
+ * It is the product modulo u^P - 1 for a power of 2 P that is at least that size, as it does not
+ * wrap around there.
+ * @param[in] p1        The first polynomial to multiply.
+ * @param[in] p2        The second polynomial to multiply.
+ * @param[in] cutoff    The recursion cutoff (see the constructor).
+ * @param[in] baseCase  The multiplication to use at or below the cutoff.
+ * @return    The product.
+ */
+template<typename RingElt>
+Polynomial<RingElt> CyclicNussbaumer<RingElt>::multiplyFull(
+                                        const Polynomial<RingElt>& p1,
+                                        const Polynomial<RingElt>& p2,
+                                        std::size_t cutoff,
+                                        NussbaumerBaseCase baseCase
+                                                           ) {
+  assert(p1.getSize() > 0 && p2.getSize() > 0);
+  std::size_t size = p1.getSize() + p2.getSize() - 1;
+  std::size_t P = 1;
+  while(P < size)
+    P <<= 1;
+
+  Polynomial<RingElt> padded1(P), padded2(P);
+  for(std::size_t i = 0; i < p1.getSize(); ++i)
+    padded1[i] = p1[i];
+  for(std::size_t i = 0; i < p2.getSize(); ++i)
+    padded2[i] = p2[i];
+
+  Polynomial<RingElt> ret = CyclicNussbaumer<RingElt>(P, cutoff, baseCase).multiply(padded1, padded2);
+  ret.setSize(size);
+  return ret;
+}
+
+
+/**
+ * Multiply two polynomials modulo u^n - 1 with n = N/2^level, divided by 2^level.
+ * @param[in] level  The level of the recursion.
+ * @param[in] p1     The first polynomial to multiply.
+ * @param[in] p2     The second polynomial to multiply.
+ * @return    The product, divided by 2^level.
+ */
+template<typename RingElt>
+Polynomial<RingElt> CyclicNussbaumer<RingElt>::multiply(
+                                        std::size_t level,
+                                        const Polynomial<RingElt>& p1,
+                                        const Polynomial<RingElt>& p2
+                                                       ) const {
+  if(level == levels_) {
+    auto ret = naivemult_cyclic(N_ >> level, p1, p2);
+    if(level != 0)
+      ret *= inverses_[level];
+    return ret;
+  }
+
+  // Reduce modulo u^half - 1 and u^half + 1
+  std::size_t half = N_ >> (level + 1);
+  Polynomial<RingElt> cyc1(half), cyc2(half), nega1(half), nega2(half);
+  for(std::size_t i = 0; i < half; ++i) {
+    cyc1[i] = p1[i] + p1[half + i];
+    nega1[i] = p1[i] - p1[half + i];
+    cyc2[i] = p2[i] + p2[half + i];
+    nega2[i] = p2[i] - p2[half + i];
+  }
+
+  // Both products are divided by 2^(level + 1): the cyclic one by the recursion, the negacyclic
+  // one together with its factor.
+  NegaNussbaumer<RingElt> nussbaumer(half, cutoff_, baseCase_);
+  Polynomial<RingElt> cyc = multiply(level + 1, cyc1, cyc2);
+  Polynomial<RingElt> nega = nussbaumer.inverseTransform(
+                      nussbaumer.componentwise(nussbaumer.transform(nega1), nussbaumer.transform(nega2)));
+  nega *= inverses_[level];
+
+  // The product is (cyc + nega)/2 + u^half*(cyc - nega)/2
+  Polynomial<RingElt> ret(2*half);
+  for(std::size_t i = 0; i < half; ++i) {
+    ret[i] = cyc[i] + nega[i];
+    ret[half + i] = cyc[i] - nega[i];
+  }
+  return ret;
+}
+
+
+/**
+ * Get the inverse of 2^bits in the ring, as a constant to multiply with. This is part of the setup,
+ * so its operations are not counted.
+ * @param[in] bits   The power of 2 to invert.
+ * @return    The inverse.
+ */
+template<typename RingElt>
+int CyclicNussbaumer<RingElt>::getInverse(unsigned int bits) {
+  RingElt half;
+  if(!RingElt::getInverse(half, 2)) {
+    std::cerr << "Factor does not have an inverse in the given ring" << std::endl;
+    exit(1);
+  }
+
+  auto opCount = RingElt::getOpCount();
+  RingElt inverse = 1;
+  for(unsigned int i = 0; i < bits; ++i)
+    inverse *= half;
+  RingElt::setOpCount(opCount);
+  return static_cast<int>(inverse.toInt());
+}
+
+#endif
@@ -9,11 +9,105 @@
 #define NEGANUSSBAUMER_H
 
 #include <vector>
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <typeinfo>
+#include <type_traits>
 
 #include "Polynomial.h"
+#include "PolynomialMatrix.h"
+#include "RingPow2Elt.h"
+#include "LazyRingModElt.h"
+#include "NegaConvo.h"
+#include "Karatsuba.h"
+#include "Butterfly.h"
 #include "BitManip.h"
+#include "NussbaumerWisdom.h"
+#include "NussbaumerArena.h"
+#include "ThreadPool.h"
+#include "OpCount.h"
+
+/**
+ * Get the base 2 logarithm of a power of 2, as a constant expression.
+ * @param[in] N    The power of 2.
+ * @return    log_2 N.
+ */
+constexpr std::size_t nussbaumerLog2(std::size_t N) {
+  std::size_t n = 0;
+  while((std::size_t(1) << n) < N)
+    ++n;
+  return n;
+}
+
+
+/**
+ * Get the number of bits of the factor that the result of the Nussbaumer algorithm is multiplied
+ * with (see NegaNussbaumer::getFactor()). As this is a constant expression, it can be used to
+ * pick a ring with enough extra bits to divide the factor out of (see correctByShift()). This is
+ * the factor of the default split at every level. A split from the wisdom may change it, except
+ * for a NussbaumerShiftRing, where only splits that do not add bits are taken from it.
+ * @param[in] N        The N of the algorithm, a power of 2.
+ * @param[in] cutoff   The recursion cutoff (see NegaNussbaumer::NegaNussbaumer).
+ * @return    The base 2 logarithm of the factor.
+ */
+constexpr unsigned int nussbaumerFactorBits(std::size_t N, std::size_t cutoff = 2) {
+  std::size_t n = nussbaumerLog2(N);
+
+  // Each level of recursion multiplies by 2m, and recurses into r; the base cases do not
+  unsigned int bits = 0;
+  while(n > 1) {
+    std::size_t lg_m = n >> 1;
+    bits += 1 + static_cast<unsigned int>(lg_m);
+    n -= lg_m;
+    if((std::size_t(1) << n) <= cutoff)
+      break;
+  }
+  return bits;
+}
+
+
+/**
+ * Whether the factor of the algorithm (see NegaNussbaumer::getFactor()) has no inverse in
+ * RingElt, so that the result is corrected with NegaNussbaumer::correctByShift(). For such a
+ * ring, Bits is the number of bits it calculates modulo.
+ */
+template<typename RingElt>
+struct NussbaumerShiftRing : std::false_type {};
+
+template<unsigned int RingBits, typename Counter>
+struct NussbaumerShiftRing<RingPow2Elt<RingBits, Counter>> : std::true_type {
+  static constexpr unsigned int Bits = RingBits;
+};
+
+
+/**
+ * Whether RingElt reduces only when asked to, such as LazyRingModElt. NegaNussbaumer then reduces
+ * the rows at the end of the transform, after each componentwise product and at the end of the
+ * inverse transform, so that the butterflies are plain additions; the values grow by at most one
+ * bit per stage in between. For such a ring, Bits is the number of bits of a reduced value.
+ */
+template<typename RingElt>
+struct NussbaumerLazyRing : std::false_type {
+  static constexpr unsigned int Bits = 0;
+  static void reduce(RingElt&) {}
+};
+
+template<int Modulus, typename Counter>
+struct NussbaumerLazyRing<LazyRingModElt<Modulus, Counter>> : std::true_type {
+  static constexpr unsigned int Bits = LazyRingModElt<Modulus, Counter>::ModulusBits;
+  static void reduce(LazyRingModElt<Modulus, Counter>& e) { e.reduce(); }
+};
+
+
+/**
+ * The multiplication used for the componentwise products at or below the recursion cutoff.
+ */
+enum class NussbaumerBaseCase {
+  Karatsuba,      //!< karatsuba_negacyclic
+  Schoolbook      //!< naivemult_negacyclic
+};
+
 
 /**
  * Class for performing the Negacyclic Nussbaumer algorithm.
@@ -23,27 +117,60 @@
 template<typename RingElt>
 class NegaNussbaumer {
 public:
-  /// Transformed polynomial
-  typedef std::vector<Polynomial<RingElt>> Transformed;
+  /// Transformed polynomial: 2m polynomials of r coefficients, in one contiguous block
+  typedef PolynomialMatrix<RingElt> Transformed;
 
-  NegaNussbaumer(std::size_t N);
+  NegaNussbaumer(std::size_t N, std::size_t cutoff = 2,
+                 NussbaumerBaseCase baseCase = NussbaumerBaseCase::Karatsuba, std::size_t lgM = 0);
 
-  Transformed transform(const Polynomial<RingElt>& orig) const;
+  Transformed transform(const ConstPolynomialView<RingElt>& orig) const;
+  void transform(Transformed& trans, const ConstPolynomialView<RingElt>& orig) const;
   Polynomial<RingElt> inverseTransform(const Transformed& trans) const;
+  void inverseTransform(const PolynomialView<RingElt>& res, Transformed& z) const;
   Polynomial<RingElt> correct(const Polynomial<RingElt>& p) const;
+  template<typename ResultElt>
+  Polynomial<ResultElt> correctByShift(const Polynomial<RingElt>& p) const;
 
   Transformed componentwise(const Transformed& t1, const Transformed& t2) const;
+  void componentwise(Transformed& resTrans, const Transformed& t1, const Transformed& t2,
+                     NussbaumerArena<RingElt>& arena) const;
 
-  static Polynomial<RingElt> multiply(std::size_t N, const Polynomial<RingElt>& p1, const Polynomial<RingElt>& p2);
+  void multiply(const PolynomialView<RingElt>& res, const ConstPolynomialView<RingElt>& p1,
+                const ConstPolynomialView<RingElt>& p2, NussbaumerArena<RingElt>& arena) const;
+  std::size_t getScratchSize() const;
 
-protected:
-  Polynomial<RingElt> addRotatedPolynomial(const Polynomial<RingElt>& p1, const Polynomial<RingElt>& p2, int steps) const;
+  std::size_t getLgM() const;
+  unsigned int getFactorBits() const;
+
+  void setThreadPool(ThreadPool* pool, std::size_t grain = DefaultParallelGrain);
+
+  /// The smallest r for which componentwise runs in parallel by default
+  static const std::size_t DefaultParallelGrain = 64;
 
+  static Polynomial<RingElt> multiply(std::size_t N, const ConstPolynomialView<RingElt>& p1,
+                                      const ConstPolynomialView<RingElt>& p2, std::size_t cutoff = 2,
+                                      NussbaumerBaseCase baseCase = NussbaumerBaseCase::Karatsuba);
+  static void multiply(std::size_t N, const PolynomialView<RingElt>& res,
+                       const ConstPolynomialView<RingElt>& p1, const ConstPolynomialView<RingElt>& p2,
+                       std::size_t cutoff, NussbaumerBaseCase baseCase, NussbaumerArena<RingElt>& arena);
+
+protected:
   unsigned int getFactor() const;
 
 private:
   std::size_t n_;
+  std::size_t lg_m_;
   std::size_t m_, r_;
+  void setSplit(std::size_t lgM);
+  unsigned int getLazyBits() const;
+  template<typename Body>
+  void forEach(std::size_t count, const Body& body) const;
+  static void reduceLazy(const PolynomialView<RingElt>& p);
+
+  std::size_t cutoff_;
+  NussbaumerBaseCase baseCase_;
+  ThreadPool* pool_ = nullptr;
+  std::size_t grain_ = DefaultParallelGrain;
 };
 
 
@@ -51,44 +178,122 @@ private:
  * Constructor for an object that will perform multiplications on the given
  * polynomial modulo u^N + 1, according to the Nussbaumer algorithm. The value
  * "N" must be a power of 2 for this algorithm.
- * @param[in] N  The "N" of the algorithm; the multiplication is calculated
- *               modulo "u^N + 1". This must be greater than 2, as a trivial
- *               alternative should be used there.
+ * @param[in] N         The "N" of the algorithm; the multiplication is calculated
+ *                      modulo "u^N + 1". This must be greater than 2, as a trivial
+ *                      alternative should be used there.
+ * @param[in] cutoff    The size up to which the componentwise products are calculated with the
+ *                      base case, rather than by recursion. The default of 2 recurses all the way.
+ * @param[in] baseCase  The multiplication to use for products of more than 2 coefficients at or
+ *                      below the cutoff; modulo u^2 + 1 a 3-multiplication formula is used.
+ * @param[in] lgM       The log_2 m of the split N = m*r, with 1 <= lgM <= log_2(N)/2. With the
+ *                      default of 0, the split is taken from NussbaumerWisdom::global(), or if it
+ *                      has no valid one, the one with the smallest r.
  */
 template<typename RingElt>
 NegaNussbaumer<RingElt>::NegaNussbaumer(
-                                    std::size_t N
-                                        ) {
+                                    std::size_t N,
+                                    std::size_t cutoff,
+                                    NussbaumerBaseCase baseCase,
+                                    std::size_t lgM
+                                        )
+: cutoff_(cutoff), baseCase_(baseCase)
+{
   assert(N > 1);
 
   // Get the n = log_2 N (which must be an integer)
   n_ = 0;
-  while((1u << n_) < N)
+  while((std::size_t(1) << n_) < N)
     ++n_;
-  assert((1u << n_) == N);
+  assert((std::size_t(1) << n_) == N);
 
   // Find m = 2^lg_m and r = 2^lg_m (with lg_m and lg_r integers), such that
-  // m*r = n with r minimum; that is, m = floor(lg_n/2) and lg_m + lg_r = n.
-  std::size_t lg_m, lg_r;
-  lg_m = n_ >> 1;
-  lg_r = n_ - lg_m;
-  m_ = 1 << lg_m;
-  r_ = 1 << lg_r;
+  // m*r = n and m <= r. Unless given or measured to be faster, take r minimum;
+  // that is, m = floor(lg_n/2) and lg_m + lg_r = n. A measured split that is out
+  // of range (from a wisdom set by hand) is ignored.
+  lg_m_ = lgM;
+  bool measured = lg_m_ == 0 && NussbaumerWisdom::global().lookup(typeid(RingElt).name(), N, cutoff,
+                                                                  static_cast<int>(baseCase), lg_m_);
+  if(lg_m_ < 1 || lg_m_ > (n_ >> 1))
+    lg_m_ = n_ >> 1;
+  assert(lgM == 0 || lg_m_ == lgM);
+  setSplit(lg_m_);
+
+  // A ring that divides the factor out by a shift was picked with nussbaumerFactorBits extra
+  // bits, so a measured split must not need more
+  if(NussbaumerShiftRing<RingElt>::value && measured && getFactorBits() > nussbaumerFactorBits(N, cutoff))
+    setSplit(n_ >> 1);
+
+  // A lazy ring must not overflow between the reductions
+  assert(!NussbaumerLazyRing<RingElt>::value || getLazyBits() < 63);
+}
+
+
+/**
+ * Set the split N = m*r of this level.
+ * @param[in] lgM    The log_2 m, with 1 <= lgM <= log_2(N)/2.
+ */
+template<typename RingElt>
+void NegaNussbaumer<RingElt>::setSplit(std::size_t lgM) {
+  assert(lgM >= 1 && lgM <= (n_ >> 1));
+  lg_m_ = lgM;
+  m_ = std::size_t(1) << lg_m_;
+  r_ = std::size_t(1) << (n_ - lg_m_);
+}
+
+
+/**
+ * Get the number of bits that the values of a NussbaumerLazyRing reach on this level, from
+ * reduced values of Bits bits: the transform adds one per stage, the inverse transform one per
+ * stage and two more in its last steps. A base case product of r coefficients adds r terms of
+ * 2*Bits; Karatsuba's method adds a bit to the factors and two to the sums per level as well.
+ * @return    The number of bits, without the sign.
+ */
+template<typename RingElt>
+unsigned int NegaNussbaumer<RingElt>::getLazyBits() const {
+  unsigned int bits = NussbaumerLazyRing<RingElt>::Bits;
+  unsigned int lgM = static_cast<unsigned int>(lg_m_);
+  unsigned int lgR = static_cast<unsigned int>(n_ - lg_m_);
+  unsigned int maxBits = bits + lgM + 3;
+
+  if(r_ == 2 || r_ <= cutoff_) {
+    unsigned int productBits = 2*bits + lgR + 1;
+    if(r_ > 2 && baseCase_ == NussbaumerBaseCase::Karatsuba)
+      productBits = 2*bits + 4*lgR + 1;
+    maxBits = std::max(maxBits, productBits);
+  }
+  return maxBits;
+}
+
+
+/**
+ * Reduce the values of a NussbaumerLazyRing; for other rings, this does nothing.
+ * @param[in] p    The values to reduce.
+ */
+template<typename RingElt>
+void NegaNussbaumer<RingElt>::reduceLazy(const PolynomialView<RingElt>& p) {
+  if(!NussbaumerLazyRing<RingElt>::value)
+    return;
+  for(std::size_t i = 0; i < p.getSize(); ++i)
+    NussbaumerLazyRing<RingElt>::reduce(p[i]);
 }
 
 
 /**
  * Perform the full multiplication of the two given polynomials, modulo u^N + 1.
- * @param[in] N    The N in the modulo u^N + 1
- * @param[in] p1   The first polynomial to multiply.
- * @param[in] p2   The second polynomial to multiply.
+ * @param[in] N          The N in the modulo u^N + 1
+ * @param[in] p1         The first polynomial to multiply.
+ * @param[in] p2         The second polynomial to multiply.
+ * @param[in] cutoff     The recursion cutoff (see the constructor).
+ * @param[in] baseCase   The multiplication to use at or below the cutoff.
  * @return    The Negacyclic convolution
  */
 template<typename RingElt>
 Polynomial<RingElt> NegaNussbaumer<RingElt>::multiply(
                                         std::size_t N,
-                                        const Polynomial<RingElt>& p1,
-                                        const Polynomial<RingElt>& p2
+                                        const ConstPolynomialView<RingElt>& p1,
+                                        const ConstPolynomialView<RingElt>& p2,
+                                        std::size_t cutoff,
+                                        NussbaumerBaseCase baseCase
                                                      ) {
   // Trivial case modulo X^2 + 1.
   if(N == 2) {
@@ -99,8 +304,15 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::multiply(
     return ret;
   }
 
+  // Below the cutoff, multiply directly
+  if(N <= cutoff) {
+    if(baseCase == NussbaumerBaseCase::Karatsuba)
+      return karatsuba_negacyclic<RingElt>(N, p1, p2);
+    return naivemult_negacyclic<RingElt>(N, p1, p2);
+  }
+
   // Otherwise, recurse into the algorithm again
-  NegaNussbaumer<RingElt> nussbaumer(N);
+  NegaNussbaumer<RingElt> nussbaumer(N, cutoff, baseCase);
   auto t1 = nussbaumer.transform(p1);
   auto t2 = nussbaumer.transform(p2);
   auto resTrans = nussbaumer.componentwise(t1, t2);
@@ -108,6 +320,107 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::multiply(
 }
 
 
+/**
+ * Perform the multiplication of the two given polynomials modulo u^N + 1, like the other
+ * multiply, but take all scratch memory from the arena and write the result in place.
+ * @param[in]     N          The N in the modulo u^N + 1
+ * @param[out]    res        The Negacyclic convolution; it must not overlap p1 or p2.
+ * @param[in]     p1         The first polynomial to multiply.
+ * @param[in]     p2         The second polynomial to multiply.
+ * @param[in]     cutoff     The recursion cutoff (see the constructor).
+ * @param[in]     baseCase   The multiplication to use at or below the cutoff.
+ * @param[in,out] arena      The arena for the transformed polynomials of each level.
+ */
+template<typename RingElt>
+void NegaNussbaumer<RingElt>::multiply(
+                                std::size_t N,
+                                const PolynomialView<RingElt>& res,
+                                const ConstPolynomialView<RingElt>& p1,
+                                const ConstPolynomialView<RingElt>& p2,
+                                std::size_t cutoff,
+                                NussbaumerBaseCase baseCase,
+                                NussbaumerArena<RingElt>& arena
+                                      ) {
+  // Trivial case modulo X^2 + 1.
+  if(N == 2) {
+    RingElt t = p1[0]*(p2[0] + p2[1]);
+    res[0] = t - (p1[0] + p1[1])*p2[1];
+    res[1] = t + (p1[1] - p1[0])*p2[0];
+    return;
+  }
+
+  // Below the cutoff, multiply directly. Karatsuba's method takes its temporaries from the arena;
+  // the schoolbook product is reduced while accumulating, with the operations of
+  // naivemult_negacyclic.
+  if(N <= cutoff) {
+    if(baseCase == NussbaumerBaseCase::Karatsuba) {
+      karatsuba_negacyclic<RingElt>(N, res, p1, p2, arena);
+      return;
+    }
+
+    for(std::size_t k = 0; k < N; ++k) {
+      res[k] = p1[0]*p2[k];
+      for(std::size_t i = 1; i <= k; ++i)
+        res[k] += p1[i]*p2[k - i];
+      for(std::size_t i = k + 1; i < N; ++i)
+        res[k] -= p1[i]*p2[N + k - i];
+    }
+    return;
+  }
+
+  // Otherwise, recurse into the algorithm again
+  NegaNussbaumer<RingElt> nussbaumer(N, cutoff, baseCase);
+  nussbaumer.multiply(res, p1, p2, arena);
+}
+
+
+/**
+ * Multiply two polynomials modulo u^N + 1, without the correction, taking the transformed
+ * polynomials of this and every deeper level from the arena, and releasing them afterwards.
+ * The componentwise products overwrite the first transformed polynomial, so each level keeps
+ * two of them (4N coefficients) and one product of r, and the deeper levels add only
+ * O(sqrt(N)) to that.
+ * @param[out]    res      The product, times getFactor(); it must not overlap p1 or p2.
+ * @param[in]     p1       The first polynomial to multiply.
+ * @param[in]     p2       The second polynomial to multiply.
+ * @param[in,out] arena    The arena, with at least getScratchSize() elements free.
+ */
+template<typename RingElt>
+void NegaNussbaumer<RingElt>::multiply(
+                                const PolynomialView<RingElt>& res,
+                                const ConstPolynomialView<RingElt>& p1,
+                                const ConstPolynomialView<RingElt>& p2,
+                                NussbaumerArena<RingElt>& arena
+                                      ) const {
+  std::size_t mark = arena.getUsed();
+  Transformed t1(arena.allocate(2*m_*r_), 2*m_, r_);
+  Transformed t2(arena.allocate(2*m_*r_), 2*m_, r_);
+
+  transform(t1, p1);
+  transform(t2, p2);
+  componentwise(t1, t1, t2, arena);
+  inverseTransform(res, t1);
+  arena.release(mark);
+}
+
+
+/**
+ * Get the number of arena elements that multiply with an arena needs: two transformed
+ * polynomials and one product for each level of recursion, as the componentwise products are
+ * done one after the other, and the temporaries of Karatsuba's method if it is the base case.
+ * @return    The number of elements.
+ */
+template<typename RingElt>
+std::size_t NegaNussbaumer<RingElt>::getScratchSize() const {
+  std::size_t size = 2*NussbaumerArena<RingElt>::roundUp(2*m_*r_) + NussbaumerArena<RingElt>::roundUp(r_);
+  if(r_ > 2 && r_ > cutoff_)
+    size += NegaNussbaumer<RingElt>(r_, cutoff_, baseCase_).getScratchSize();
+  else if(r_ > 2 && baseCase_ == NussbaumerBaseCase::Karatsuba)
+    size += karatsuba_negacyclic_scratch_size<RingElt>(r_);
+  return size;
+}
+
+
 /**
  * Perform the componentwise multiplication of the transformed polynomials.
  * @param[in] t1    The first transformed polynomial.
@@ -119,17 +432,55 @@ typename NegaNussbaumer<RingElt>::Transformed NegaNussbaumer<RingElt>::component
                                                                    const Transformed& t1,
                                                                    const Transformed& t2
                                                                                ) const {
-  Transformed resTrans;
-  resTrans.push_back(Polynomial<RingElt>(r_));
-  for(std::size_t i = 1; i < t1.size(); ++i) {
-    auto term = NegaNussbaumer<RingElt>::multiply(r_, t1[i], t2[i]);
-    resTrans.push_back(term);
+  Transformed resTrans(t1.getNumRows(), r_);
+
+  // The products are independent, and each writes its own row
+  if(pool_ != nullptr && r_ >= grain_) {
+    pool_->parallelFor(1, t1.getNumRows(), [&](std::size_t i) {
+      resTrans[i] = NegaNussbaumer<RingElt>::multiply(r_, t1[i], t2[i], cutoff_, baseCase_);
+      reduceLazy(resTrans[i]);
+    });
+    return resTrans;
+  }
+
+  for(std::size_t i = 1; i < t1.getNumRows(); ++i) {
+    resTrans[i] = NegaNussbaumer<RingElt>::multiply(r_, t1[i], t2[i], cutoff_, baseCase_);
+    reduceLazy(resTrans[i]);
   }
 
   return resTrans;
 }
 
 
+/**
+ * Perform the componentwise multiplication of the transformed polynomials into a given matrix,
+ * taking the scratch memory of the recursion from the arena. Each product is calculated in the
+ * arena and then copied, so resTrans may be t1 or t2.
+ * @param[out]    resTrans   The transformed result of the multiplication, of 2m rows of r.
+ * @param[in]     t1         The first transformed polynomial.
+ * @param[in]     t2         The second transformed polynomial.
+ * @param[in,out] arena      The arena for the deeper levels.
+ */
+template<typename RingElt>
+void NegaNussbaumer<RingElt>::componentwise(
+                                  Transformed& resTrans,
+                                  const Transformed& t1,
+                                  const Transformed& t2,
+                                  NussbaumerArena<RingElt>& arena
+                                           ) const {
+  std::size_t mark = arena.getUsed();
+  PolynomialView<RingElt> product(arena.allocate(r_), r_);
+  for(std::size_t i = 1; i < t1.getNumRows(); ++i) {
+    NegaNussbaumer<RingElt>::multiply(r_, product, t1[i], t2[i], cutoff_, baseCase_, arena);
+    reduceLazy(product);
+    resTrans[i] = product;
+  }
+  for(std::size_t j = 0; j < r_; ++j)
+    resTrans[0][j] = RingElt();
+  arena.release(mark);
+}
+
+
 /**
  * Transform the polynomial to the list of polynomials that can be multiplied
  * componentwise (see algorithm description for a more thorough explanation).
@@ -139,55 +490,69 @@ typename NegaNussbaumer<RingElt>::Transformed NegaNussbaumer<RingElt>::component
 template<typename RingElt>
 typename NegaNussbaumer<RingElt>::Transformed
                                     NegaNussbaumer<RingElt>::transform(
-                                            const Polynomial<RingElt>& orig
+                                            const ConstPolynomialView<RingElt>& orig
                                                                        ) const {
-  assert(orig.getSize() == (1u << n_));
-  Transformed trans(2*m_, Polynomial<RingElt>(r_));
+  Transformed trans(2*m_, r_);
+  transform(trans, orig);
+  return trans;
+}
+
+
+/**
+ * Transform the polynomial into a given matrix (see the other transform).
+ * @param[out] trans    The transformed polynomial, of 2m rows of r.
+ * @param[in]  orig     The original polynomial, must be of degree N.
+ */
+template<typename RingElt>
+void NegaNussbaumer<RingElt>::transform(
+                                  Transformed& trans,
+                                  const ConstPolynomialView<RingElt>& orig
+                                       ) const {
+  assert(orig.getSize() == (std::size_t(1) << n_));
+  assert(trans.getNumRows() == 2*m_ && trans.getNumCols() == r_);
 
   // First get the polynomials to perform the fourier transform on. These are
   // 2m polynomials of which r coefficients will be considered, where two sets
   // of m polynomials are created by shuffling "orig".
-  for(std::size_t i = 0; i < 2*m_; ++i) {
+  forEach(2*m_, [&](std::size_t i) {
     for(std::size_t j = 0; j < r_; ++j) {
       trans[i][j] = orig[m_*j + (i % m_)];
     }
-  }
+  });
 
-  // Do the fast fourier transform.
-  std::size_t j = (n_ >> 1);
+  // Do the fast fourier transform. The m butterflies of a stage update disjoint
+  // pairs of rows; the stages depend on each other.
+  std::size_t j = lg_m_;
   while(j > 0) {
     --j;
 
-    for(std::size_t sPart = 0; sPart < (m_ >> j); ++sPart) {
-      std::size_t s, sRev;
+    forEach(m_, [&](std::size_t butterfly) {
+      std::size_t sPart, s, sRev, t;
+      sPart = butterfly >> j;
+      t = butterfly & ((std::size_t(1) << j) - 1);
       s = sPart << (j+1);
-      sRev = bitrev((n_ >> 1) - j, sPart) << j;
+      sRev = bitrev(lg_m_ - j, sPart) << j;
 
-      int k = static_cast<int>((r_/m_)*sRev);
+      std::ptrdiff_t k = static_cast<std::ptrdiff_t>((r_/m_)*sRev);
 
-      for(std::size_t t = 0; t < (1u << j); ++t) {
-        std::size_t e, f;
-        e = s + t;
-        f = e + (1u << j);
+      std::size_t e, f;
+      e = s + t;
+      f = e + (std::size_t(1) << j);
 
-        // Now, we set (simultaneously):
-        // trans[e] = trans[e] + u^k*trans[f]
-        // trans[f] = trans[e] - u^k*trans[f]
-        Polynomial<RingElt> tmp;
-        if(e == 0 && j == 0) {
-          // Don't calculate trans[0]; we don't need it.
-          tmp = Polynomial<RingElt>(r_);
-        }
-        else {
-          tmp = addRotatedPolynomial(trans[e], trans[f], k);
-        }
-        trans[f] = addRotatedPolynomial(trans[e], trans[f], k + r_);
-        trans[e] = tmp;
-      }
-    }
+      // Now, we set (simultaneously):
+      // trans[e] = trans[e] + u^k*trans[f]
+      // trans[f] = trans[e] - u^k*trans[f]
+      // Don't calculate trans[0]; we don't need it.
+      butterflyDit(trans[e], trans[f], k, e != 0 || j != 0);
+    });
   }
 
-  return trans;
+  // A lazy ring is reduced once, after all stages (the first row is not used)
+  if(NussbaumerLazyRing<RingElt>::value) {
+    forEach(2*m_ - 1, [&](std::size_t i) {
+      reduceLazy(trans[i + 1]);
+    });
+  }
 }
 
 
@@ -201,92 +566,74 @@ template<typename RingElt>
 Polynomial<RingElt> NegaNussbaumer<RingElt>::inverseTransform(
                                                     const Transformed& trans
                                                               ) const {
-  // Do the inverse FFT (through a DIT with unordered input)
   Transformed z(trans);
-  std::size_t jMax = n_ >> 1;
+  Polynomial<RingElt> res(std::size_t(1) << n_);
+  inverseTransform(PolynomialView<RingElt>(&res[0], res.getSize()), z);
+  return res;
+}
+
+
+/**
+ * Perform the inverse transform in place, writing the polynomial form into a given view.
+ * @param[out]    res      The polynomial form, of N coefficients.
+ * @param[in,out] z        The transformed form of the polynomial; it is overwritten.
+ */
+template<typename RingElt>
+void NegaNussbaumer<RingElt>::inverseTransform(
+                                  const PolynomialView<RingElt>& res,
+                                  Transformed& z
+                                              ) const {
+  assert(res.getSize() == (std::size_t(1) << n_));
+
+  // Do the inverse FFT (through a DIT with unordered input), with the m
+  // butterflies of each stage on disjoint pairs of rows
+  std::size_t jMax = lg_m_;
   for(std::size_t j = 0; j <= jMax; ++j) {
-    for(std::size_t t = 0; t < (1u << j); ++t) {
-      int k = -(int)((r_/m_)*( t << (jMax - j) ));
-
-      for(std::size_t s = 0; s < 2*m_; s += (1 << (j+1))) {
-        std::size_t e, f;
-        e = s + t;
-        f = e + (1u << j);
-
-        Polynomial<RingElt> tmp;
-        if(j == 0 && e == 0) {
-          z[e] = z[f];
-          z[f] = -z[f];
-        }
-        else {
-          // Now, we set (simultaneously):
-          // z[e] = z[e] + u^k*z[f]
-          // z[f] = z[e] - u^k*z[f]
-          tmp = addRotatedPolynomial(z[e], z[f], k);
-          z[f] = addRotatedPolynomial(z[e], z[f], k + r_);
-          z[e] = tmp;
-        }
+    forEach(m_, [&](std::size_t butterfly) {
+      std::size_t t, s;
+      t = butterfly & ((std::size_t(1) << j) - 1);
+      s = (butterfly >> j) << (j+1);
+      std::ptrdiff_t k = -static_cast<std::ptrdiff_t>((r_/m_)*( t << (jMax - j) ));
+
+      std::size_t e, f;
+      e = s + t;
+      f = e + (std::size_t(1) << j);
+
+      if(j == 0 && e == 0) {
+        // z[0] is 0, so this is a copy and a negation.
+        z[e] = z[f];
+        for(std::size_t i = 0; i < r_; ++i)
+          z[f][i] = -z[f][i];
       }
-    }
+      else {
+        // Now, we set (simultaneously):
+        // z[e] = z[e] + u^k*z[f]
+        // z[f] = z[e] - u^k*z[f]
+        butterflyDit(z[e], z[f], k);
+      }
+    });
   }
 
   // Subtract the last polynomial from each other
-  for(std::size_t i = 0; i < 2*m_ - 1; ++i) {
+  forEach(2*m_ - 1, [&](std::size_t i) {
     z[i] -= z[2*m_ - 1];
-  }
+  });
 
   // Unpack the polynomial
-  Polynomial<RingElt> res(1u << n_);
-  for(std::size_t i = 0; i < m_ - 1; ++i) {
+  forEach(m_ - 1, [&](std::size_t i) {
     res[i] = z[i][0] - z[m_ + i][r_ - 1];
     for(std::size_t j = 1; j < r_; ++j) {
       res[m_*j + i] = z[i][j] + z[m_ + i][j - 1];
     }
-  }
+  });
 
   for(std::size_t j = 0; j < r_; ++j)
     res[m_*j + m_ - 1] = z[m_ - 1][j];
 
-  return res;
+  reduceLazy(res);
 }
 
 
-/**
- * Calculate p1 + (u^steps)*p2 modulo u^r + 1. This could be done by a separate
- * rotate/add step, but this would require possible negations followed by
- * additions, rather than immediately subtracting.
- * @param[in] p1      The first polynomial
- * @param[in] p2      The second polynomial.
- * @param[in] steps   The number of steps to "rotate" p2.
- * @return    p1 + (u^steps)*p2 modulo u^r + 1.
- */
-template<typename RingElt>
-Polynomial<RingElt> NegaNussbaumer<RingElt>::addRotatedPolynomial(
-                                                 const Polynomial<RingElt>& p1,
-                                                 const Polynomial<RingElt>& p2,
-                                                 int steps
-                                                                 ) const {
-  Polynomial<RingElt> ret(r_);
-
-  // Get "steps" as negative value, with 2*r_ < steps <= 0
-  steps %= 2*r_;
-  if(steps > 0)
-    steps -= 2*r_;
-
-  for(std::size_t i = 0; i < r_; ++i) {
-    int src = static_cast<int>(i) - steps;
-    std::size_t srcIndex = static_cast<size_t>(src) % r_;
-    bool signInverse = (src / r_) & 1;
-
-    if(signInverse)
-      ret[i] = p1[i] - p2[srcIndex];
-    else
-      ret[i] = p1[i] + p2[srcIndex];
-  }
-
-  return ret;
-}
-
 
 /*
  * Corrects the result of the Nussbaumer algorithm by dividing the factor
@@ -313,6 +660,29 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::correct(const Polynomial<RingElt>&
 }
 
 
+/**
+ * Corrects the result of the Nussbaumer algorithm in a ring where the factor of getFactor is
+ * not invertible, such as RingPow2Elt: the result is a multiple of the factor, so it is divided
+ * out exactly with a shift. For a result modulo 2^k, the calculation must be done modulo
+ * 2^(k + getFactorBits()); the corrected polynomial is then correct modulo 2^k.
+ * @tparam    ResultElt  The ring of the result, of at least getFactorBits() fewer bits than RingElt.
+ * @param[in] p          The polynomial to correct.
+ * @return    The polynomial.
+ */
+template<typename RingElt> template<typename ResultElt>
+Polynomial<ResultElt> NegaNussbaumer<RingElt>::correctByShift(const Polynomial<RingElt>& p) const {
+  static_assert(NussbaumerShiftRing<RingElt>::value && NussbaumerShiftRing<ResultElt>::value,
+                "correctByShift needs rings modulo powers of two");
+  unsigned int bits = getFactorBits();
+  assert(NussbaumerShiftRing<ResultElt>::Bits + bits <= NussbaumerShiftRing<RingElt>::Bits);
+
+  Polynomial<ResultElt> ret(p.getSize());
+  for(std::size_t i = 0; i < p.getSize(); ++i)
+    ret[i] = p[i].shiftRight(bits);
+  return ret;
+}
+
+
 /**
  * Calculate the factor that the result is multiplied with after the Nussbaumer
  * algorithm. The final step should be to multiply the result with the inverse
@@ -321,16 +691,78 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::correct(const Polynomial<RingElt>&
  */
 template<typename RingElt>
 unsigned int NegaNussbaumer<RingElt>::getFactor() const {
-  unsigned int factor = 1;
-  unsigned int nTest = n_;
-  while(nTest != 1) {
-    unsigned int lgmTest = nTest >> 1;
-    unsigned int lgrTest = nTest - lgmTest;
-    factor *= 2*(1 << lgmTest);
-    nTest = lgrTest;
+  // The factor is passed to the ring as an int; this holds up to N = 2^28 or so
+  unsigned int bits = getFactorBits();
+  assert(bits < 31);
+  return 1u << bits;
+}
+
+
+/**
+ * Run the 2m - 1 products of componentwise (the one without an arena) on a thread pool, if they
+ * are of at least grain coefficients; smaller ones are not worth the overhead. Only this level
+ * fans out: the products recurse serially, as there are already sqrt(2N) or more of them. The
+ * stages of transform and inverseTransform are split over the pool as well.
+ *
+ * The operation counters of the rings are not synchronized, so this only compiles for a ring
+ * with NoOpCount.
+ * @param[in] pool     The pool to run on, or nullptr to run serially.
+ * @param[in] grain    The smallest size r of the products to run in parallel.
+ */
+template<typename RingElt>
+void NegaNussbaumer<RingElt>::setThreadPool(ThreadPool* pool, std::size_t grain) {
+  static_assert(std::is_same<typename std::decay<decltype(RingElt::getOpCount())>::type, NoOpCount>::value,
+                "the operation counter would be raced on: use a ring with NoOpCount on a thread pool");
+  pool_ = pool;
+  grain_ = grain;
+}
+
+
+/**
+ * Call body(i) for 0 <= i < count, where the calls touch disjoint rows. With a thread pool and
+ * rows of at least the grain size, the range is split into one contiguous chunk per thread, and
+ * the call returns when all are done; this is the barrier between the stages of the transforms.
+ * @param[in] count    The number of calls.
+ * @param[in] body     The function to call for each index.
+ */
+template<typename RingElt> template<typename Body>
+void NegaNussbaumer<RingElt>::forEach(std::size_t count, const Body& body) const {
+  if(pool_ == nullptr || r_ < grain_ || count < 2) {
+    for(std::size_t i = 0; i < count; ++i)
+      body(i);
+    return;
   }
-  return factor;
+
+  std::size_t chunks = std::min(count, pool_->getNumThreads());
+  pool_->parallelFor(0, chunks, [&](std::size_t chunk) {
+    for(std::size_t i = count*chunk/chunks; i < count*(chunk + 1)/chunks; ++i)
+      body(i);
+  });
+}
+
+
+/**
+ * Get the log_2 m of the split N = m*r in use.
+ * @return    log_2 m.
+ */
+template<typename RingElt>
+std::size_t NegaNussbaumer<RingElt>::getLgM() const {
+  return lg_m_;
 }
 
 
+/**
+ * Get the number of bits of the factor of getFactor(), for the splits in use at each level of
+ * recursion. With the default splits, this is nussbaumerFactorBits(N, cutoff).
+ * @return    The base 2 logarithm of the factor.
+ */
+template<typename RingElt>
+unsigned int NegaNussbaumer<RingElt>::getFactorBits() const {
+  // This level multiplies by 2m; the componentwise products recurse unless they are base cases
+  unsigned int bits = 1 + static_cast<unsigned int>(lg_m_);
+  if(r_ > 2 && r_ > cutoff_)
+    bits += NegaNussbaumer<RingElt>(r_, cutoff_, baseCase_).getFactorBits();
+  return bits;
+}
+
 #endif
@@ -0,0 +1,142 @@
+/**
+ * @file NegaNussbaumer3.h
+ * @author Gerben van der Lubbe
+ *
+ * File containing a negacyclic convolution of size N = 3*2^k, built from a Karatsuba layer over
+ * Nussbaumer's algorithm of size 2^k.
+ */
+
+#ifndef NEGANUSSBAUMER3_H
+#define NEGANUSSBAUMER3_H
+
+#include <cassert>
+#include <cstddef>
+
+#include "Polynomial.h"
+#include "PolynomialMatrix.h"
+#include "NegaNussbaumer.h"
+
+/**
+ * Class for multiplying modulo u^N + 1 with N = 3K and K = 2^k, without padding to a power of 2.
+ * With y = u^3, a polynomial modulo u^N + 1 is a0(y) + u*a1(y) + u^2*a2(y), where ai holds the
+ * coefficients i, i + 3, i + 6, ... and is taken modulo y^K + 1. The product of two of them is
+ * then a product of polynomials of degree 2 in u, where u^3 = y; it is calculated with the 6
+ * multiplications of Karatsuba's method for 3 terms, each a negacyclic product of size K with
+ * NegaNussbaumer.
+ *
+ * As for NegaNussbaumer, the result of multiply() must be corrected with correct().
+ */
+template<typename RingElt>
+class NegaNussbaumer3 {
+public:
+  NegaNussbaumer3(std::size_t N, std::size_t cutoff = 2,
+                  NussbaumerBaseCase baseCase = NussbaumerBaseCase::Karatsuba);
+
+  Polynomial<RingElt> multiply(const ConstPolynomialView<RingElt>& p1,
+                               const ConstPolynomialView<RingElt>& p2) const;
+  Polynomial<RingElt> correct(const Polynomial<RingElt>& p) const;
+
+private:
+  Polynomial<RingElt> multiplyPart(const Polynomial<RingElt>& a, const Polynomial<RingElt>& b) const;
+
+  std::size_t k_;
+  NegaNussbaumer<RingElt> nussbaumer_;
+};
+
+
+/**
+ * Constructor for an object that multiplies modulo u^N + 1.
+ * @param[in] N         The "N" of the algorithm, 3*2^k with k >= 2.
+ * @param[in] cutoff    The recursion cutoff of the products of size 2^k (see NegaNussbaumer).
+ * @param[in] baseCase  The multiplication to use at or below the cutoff.
+ */
+template<typename RingElt>
+NegaNussbaumer3<RingElt>::NegaNussbaumer3(
+                                    std::size_t N,
+                                    std::size_t cutoff,
+                                    NussbaumerBaseCase baseCase
+                                         )
+: k_(N/3), nussbaumer_(N/3, cutoff, baseCase)
+{
+  assert(N % 3 == 0 && k_ >= 4 && (k_ & (k_ - 1)) == 0);
+}
+
+
+/**
+ * Multiply two polynomials modulo u^N + 1.
+ * @param[in] p1   The first polynomial to multiply.
+ * @param[in] p2   The second polynomial to multiply.
+ * @return    The product, times the factor that correct() removes.
+ */
+template<typename RingElt>
+Polynomial<RingElt> NegaNussbaumer3<RingElt>::multiply(
+                                        const ConstPolynomialView<RingElt>& p1,
+                                        const ConstPolynomialView<RingElt>& p2
+                                                      ) const {
+  assert(p1.getSize() == 3*k_ && p2.getSize() == 3*k_);
+
+  // Split the polynomials into the parts of coefficients i mod 3
+  Polynomial<RingElt> a[3], b[3];
+  for(std::size_t i = 0; i < 3; ++i) {
+    a[i] = ConstPolynomialView<RingElt>(&p1[i], k_, 3);
+    b[i] = ConstPolynomialView<RingElt>(&p2[i], k_, 3);
+  }
+
+  // Karatsuba for 3 terms: the products of equal parts and of the sums of two parts
+  Polynomial<RingElt> p00 = multiplyPart(a[0], b[0]);
+  Polynomial<RingElt> p11 = multiplyPart(a[1], b[1]);
+  Polynomial<RingElt> p22 = multiplyPart(a[2], b[2]);
+  Polynomial<RingElt> m01 = multiplyPart(a[0] + a[1], b[0] + b[1]);
+  Polynomial<RingElt> m02 = multiplyPart(a[0] + a[2], b[0] + b[2]);
+  Polynomial<RingElt> m12 = multiplyPart(a[1] + a[2], b[1] + b[2]);
+
+  // m01 = a0*b1 + a1*b0, m02 = a0*b2 + a1*b1 + a2*b0, m12 = a1*b2 + a2*b1
+  m01 -= p00;
+  m01 -= p11;
+  m02 -= p00;
+  m02 -= p22;
+  m02 += p11;
+  m12 -= p11;
+  m12 -= p22;
+
+  // Result part 0 is p00 + y*m12, part 1 is m01 + y*p22, and part 2 is m02; the multiplication
+  // by y modulo y^K + 1 moves each coefficient up, negating the one that wraps around.
+  Polynomial<RingElt> res(3*k_);
+  res[0] = p00[0] - m12[k_ - 1];
+  res[1] = m01[0] - p22[k_ - 1];
+  res[2] = m02[0];
+  for(std::size_t j = 1; j < k_; ++j) {
+    res[3*j] = p00[j] + m12[j - 1];
+    res[3*j + 1] = m01[j] + p22[j - 1];
+    res[3*j + 2] = m02[j];
+  }
+  return res;
+}
+
+
+/**
+ * Corrects the result of multiply by dividing the factor of the products of size 2^k out.
+ * @param[in] p    The polynomial to correct.
+ * @return    The polynomial.
+ */
+template<typename RingElt>
+Polynomial<RingElt> NegaNussbaumer3<RingElt>::correct(const Polynomial<RingElt>& p) const {
+  return nussbaumer_.correct(p);
+}
+
+
+/**
+ * Multiply two parts modulo y^K + 1, with a full level of Nussbaumer's algorithm, so that every
+ * product has the same factor.
+ * @param[in] a    The first part.
+ * @param[in] b    The second part.
+ * @return    The product, times the factor.
+ */
+template<typename RingElt>
+Polynomial<RingElt> NegaNussbaumer3<RingElt>::multiplyPart(const Polynomial<RingElt>& a,
+                                                           const Polynomial<RingElt>& b) const {
+  return nussbaumer_.inverseTransform(nussbaumer_.componentwise(nussbaumer_.transform(a),
+                                                                nussbaumer_.transform(b)));
+}
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ * @file NussbaumerAutotune.h
+ * @author Gerben van der Lubbe
+ *
+ * File to measure the fastest split N = m*r of NegaNussbaumer on this host.
+ */
+
+#ifndef NUSSBAUMERAUTOTUNE_H
+#define NUSSBAUMERAUTOTUNE_H
+
+#include <iostream>
+#include <typeinfo>
+#include <cstddef>
+
+#include "NegaNussbaumer.h"
+#include "NussbaumerWisdom.h"
+#include "WallClock.h"
+
+/**
+ * Time one multiplication modulo u^N + 1 (without the correction) with the given split.
+ * @param[in] N         The size of the multiplication.
+ * @param[in] cutoff    The recursion cutoff.
+ * @param[in] baseCase  The base case multiplication.
+ * @param[in] lgM       The log_2 m of the split.
+ * @param[in] runs      The number of times to multiply; the fastest one is returned.
+ * @return    The time in microseconds.
+ */
+template<typename RingElt>
+double nussbaumerTime(std::size_t N, std::size_t cutoff, NussbaumerBaseCase baseCase, std::size_t lgM,
+                      std::size_t runs) {
+  Polynomial<RingElt> p1(N), p2(N);
+  for(std::size_t i = 0; i < N; ++i) {
+    p1[i] = RingElt(static_cast<int>(31*i + 7));
+    p2[i] = RingElt(static_cast<int>(17*i*i + 3));
+  }
+
+  double best = 0;
+  for(std::size_t run = 0; run < runs; ++run) {
+    WallClock clock;
+    NegaNussbaumer<RingElt> nussbaumer(N, cutoff, baseCase, lgM);
+    auto resTrans = nussbaumer.componentwise(nussbaumer.transform(p1), nussbaumer.transform(p2));
+    auto result = nussbaumer.inverseTransform(resTrans);
+    double time = clock.reset().getMicroseconds();
+    if(run == 0 || time < best)
+      best = time;
+  }
+  return best;
+}
+
+
+/**
+ * Measure the fastest split N = m*r for every power of 2 from 4 up to N that NegaNussbaumer
+ * recurses into, smallest first, so that each size is timed with the best splits of the smaller
+ * ones. The splits are stored in NussbaumerWisdom::global(), where the NegaNussbaumer constructor
+ * finds them; save it to keep them.
+ * @param[in] N         The largest size to tune.
+ * @param[in] cutoff    The recursion cutoff the multiplications will use.
+ * @param[in] baseCase  The base case multiplication they will use.
+ * @param[in] runs      The number of times to time each split; the fastest run is used.
+ * @param[in] log       If not null, the times of each split are written to it.
+ * @return    The best log_2 m for N.
+ */
+template<typename RingElt>
+std::size_t nussbaumerAutotune(std::size_t N, std::size_t cutoff = 2,
+                               NussbaumerBaseCase baseCase = NussbaumerBaseCase::Karatsuba,
+                               std::size_t runs = 5, std::ostream* log = nullptr) {
+  std::size_t bestLgM = 0;
+  for(std::size_t n = 2; (std::size_t(1) << n) <= N; ++n) {
+    std::size_t size = std::size_t(1) << n;
+    if(size <= cutoff)
+      continue;
+
+    // m <= r is needed for the 2m-th root of unity u^(r/m)
+    double bestTime = 0;
+    bestLgM = 0;
+    for(std::size_t lgM = 1; lgM <= (n >> 1); ++lgM) {
+      double time = nussbaumerTime<RingElt>(size, cutoff, baseCase, lgM, runs);
+      if(log != nullptr)
+        *log << "  N = " << size << ", m = " << (std::size_t(1) << lgM) << ": " << time << " us" << std::endl;
+      if(bestLgM == 0 || time < bestTime) {
+        bestTime = time;
+        bestLgM = lgM;
+      }
+    }
+
+    NussbaumerWisdom::global().set(typeid(RingElt).name(), size, cutoff, static_cast<int>(baseCase), bestLgM);
+  }
+  return bestLgM;
+}
+
+#endif
@@ -0,0 +1,275 @@
+/**
+ * @file StaticNegaNussbaumer.h
+ * @author Gerben van der Lubbe
+ *
+ * File containing Nussbaumer's negacyclic convolution algorithm for a size N known at compile time.
+ */
+
+#ifndef STATICNEGANUSSBAUMER_H
+#define STATICNEGANUSSBAUMER_H
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <cstdlib>
+
+#include "NegaNussbaumer.h"
+
+/**
+ * The same algorithm as NegaNussbaumer, with N a template parameter. The sizes m and r are
+ * compile-time constants, the polynomials are std::arrays rather than allocated, and the recursion
+ * into the componentwise multiplications is a recursion of templates down to the unrolled case
+ * N = 2. All loop bounds are constants, so the compiler can unroll and vectorize them.
+ *
+ * The operations performed are exactly those of NegaNussbaumer, so the results and operation
+ * counts are the same. As there, the result must be corrected with correct().
+ */
+template<typename RingElt, std::size_t N>
+class StaticNegaNussbaumer {
+public:
+  /// log_2 N
+  static constexpr std::size_t LgN = nussbaumerLog2(N);
+  /// log_2 m and log_2 r, with m = 2^floor(LgN/2), so that m*r = N and m <= r
+  static constexpr std::size_t LgM = LgN >> 1, LgR = LgN - LgM;
+  static constexpr std::size_t M = std::size_t(1) << LgM, R = std::size_t(1) << LgR;
+
+  static_assert(N > 2 && (std::size_t(1) << LgN) == N, "N must be a power of 2 greater than 2");
+
+  typedef std::array<RingElt, N> Poly;
+  /// One of the 2m polynomials of the transformed polynomial
+  typedef std::array<RingElt, R> Row;
+  typedef std::array<Row, 2*M> Transformed;
+
+  static void transform(Transformed& trans, const Poly& orig);
+  static void componentwise(Transformed& resTrans, const Transformed& t1, const Transformed& t2);
+  static void inverseTransform(Poly& res, Transformed& z);
+  static void correct(Poly& p);
+
+  static void multiply(Poly& res, const Poly& p1, const Poly& p2);
+
+private:
+  static void butterfly(Row& e, Row& f, int steps, bool needE);
+  static void addSubtract(RingElt& e, RingElt& f, const RingElt& value, bool subtract, bool needE);
+  static constexpr std::size_t bitrevConst(std::size_t n, std::size_t value);
+};
+
+
+/**
+ * The base case modulo X^2 + 1, fully unrolled.
+ */
+template<typename RingElt>
+class StaticNegaNussbaumer<RingElt, 2> {
+public:
+  typedef std::array<RingElt, 2> Poly;
+
+  /**
+   * Perform the multiplication modulo X^2 + 1, as in NegaNussbaumer::multiply.
+   * @param[out] res  The product.
+   * @param[in]  p1   The first polynomial to multiply.
+   * @param[in]  p2   The second polynomial to multiply.
+   */
+  static void multiply(Poly& res, const Poly& p1, const Poly& p2) {
+    RingElt t = p1[0]*(p2[0] + p2[1]);
+    res[0] = t - (p1[0] + p1[1])*p2[1];
+    res[1] = t + (p1[1] - p1[0])*p2[0];
+  }
+};
+
+
+/**
+ * Perform the multiplication of the two given polynomials, modulo u^N + 1, multiplied by the
+ * factor that correct() removes.
+ * @param[out] res  The product, times the factor.
+ * @param[in]  p1   The first polynomial to multiply.
+ * @param[in]  p2   The second polynomial to multiply.
+ */
+template<typename RingElt, std::size_t N>
+void StaticNegaNussbaumer<RingElt, N>::multiply(Poly& res, const Poly& p1, const Poly& p2) {
+  Transformed t1, t2, resTrans;
+  transform(t1, p1);
+  transform(t2, p2);
+  componentwise(resTrans, t1, t2);
+  inverseTransform(res, resTrans);
+}
+
+
+/**
+ * Perform the componentwise multiplication of the transformed polynomials. The first one is not
+ * needed, so it is set to 0.
+ * @param[out] resTrans  The transformed result of the multiplication.
+ * @param[in]  t1        The first transformed polynomial.
+ * @param[in]  t2        The second transformed polynomial.
+ */
+template<typename RingElt, std::size_t N>
+void StaticNegaNussbaumer<RingElt, N>::componentwise(Transformed& resTrans, const Transformed& t1,
+                                                     const Transformed& t2) {
+  resTrans[0].fill(RingElt());
+  for(std::size_t i = 1; i < 2*M; ++i)
+    StaticNegaNussbaumer<RingElt, R>::multiply(resTrans[i], t1[i], t2[i]);
+}
+
+
+/**
+ * Transform the polynomial to the list of polynomials that can be multiplied
+ * componentwise (see NegaNussbaumer::transform).
+ * @param[out] trans    The transformed polynomial.
+ * @param[in]  orig     The original polynomial.
+ */
+template<typename RingElt, std::size_t N>
+void StaticNegaNussbaumer<RingElt, N>::transform(Transformed& trans, const Poly& orig) {
+  for(std::size_t i = 0; i < 2*M; ++i)
+    for(std::size_t j = 0; j < R; ++j)
+      trans[i][j] = orig[M*j + (i % M)];
+
+  // Do the fast fourier transform.
+  std::size_t j = LgM;
+  while(j > 0) {
+    --j;
+
+    for(std::size_t sPart = 0; sPart < (M >> j); ++sPart) {
+      std::size_t s = sPart << (j+1);
+      std::size_t sRev = bitrevConst(LgM - j, sPart) << j;
+      int k = static_cast<int>((R/M)*sRev);
+
+      for(std::size_t t = 0; t < (std::size_t(1) << j); ++t) {
+        std::size_t e = s + t;
+        std::size_t f = e + (std::size_t(1) << j);
+
+        // Don't calculate trans[0]; we don't need it.
+        butterfly(trans[e], trans[f], k, e != 0 || j != 0);
+      }
+    }
+  }
+}
+
+
+/**
+ * Perform the inverse transform (see NegaNussbaumer::inverseTransform).
+ * @param[out]    res      The polynomial form, times the factor that correct() removes.
+ * @param[in,out] z        The transformed form of the polynomial; it is overwritten.
+ */
+template<typename RingElt, std::size_t N>
+void StaticNegaNussbaumer<RingElt, N>::inverseTransform(Poly& res, Transformed& z) {
+  // Do the inverse FFT (through a DIT with unordered input)
+  for(std::size_t j = 0; j <= LgM; ++j) {
+    for(std::size_t t = 0; t < (std::size_t(1) << j); ++t) {
+      int k = -static_cast<int>((R/M)*(t << (LgM - j)));
+
+      for(std::size_t s = 0; s < 2*M; s += (std::size_t(1) << (j+1))) {
+        std::size_t e = s + t;
+        std::size_t f = e + (std::size_t(1) << j);
+
+        if(j == 0 && e == 0) {
+          // z[0] is 0, so this is a copy and a negation.
+          z[e] = z[f];
+          for(std::size_t i = 0; i < R; ++i)
+            z[f][i] = -z[f][i];
+        }
+        else {
+          butterfly(z[e], z[f], k, true);
+        }
+      }
+    }
+  }
+
+  // Subtract the last polynomial from each other
+  for(std::size_t i = 0; i < 2*M - 1; ++i)
+    for(std::size_t j = 0; j < R; ++j)
+      z[i][j] -= z[2*M - 1][j];
+
+  // Unpack the polynomial
+  for(std::size_t i = 0; i < M - 1; ++i) {
+    res[i] = z[i][0] - z[M + i][R - 1];
+    for(std::size_t j = 1; j < R; ++j)
+      res[M*j + i] = z[i][j] + z[M + i][j - 1];
+  }
+
+  for(std::size_t j = 0; j < R; ++j)
+    res[M*j + M - 1] = z[M - 1][j];
+}
+
+
+/**
+ * Correct the result of the algorithm by multiplying it with the inverse of the factor
+ * 2^nussbaumerFactorBits(N).
+ * @param[in,out] p    The polynomial to correct.
+ */
+template<typename RingElt, std::size_t N>
+void StaticNegaNussbaumer<RingElt, N>::correct(Poly& p) {
+  RingElt inverseElt;
+  if(!RingElt::getInverse(inverseElt, 1u << nussbaumerFactorBits(N))) {
+    std::cerr << "Factor does not have an inverse in the given ring" << std::endl;
+    exit(1);
+  }
+
+  int inverse = inverseElt.toInt();
+  for(std::size_t i = 0; i < N; ++i)
+    p[i] *= inverse;
+}
+
+
+/**
+ * Calculate (simultaneously) e = e + u^steps*f and f = e - u^steps*f modulo u^R + 1. The rotated
+ * f is split in the part that wraps around and the part that does not, so that each loop adds
+ * with a fixed sign.
+ * @param[in,out] e        The first polynomial.
+ * @param[in,out] f        The second polynomial.
+ * @param[in]     steps    The power of u to multiply f with.
+ * @param[in]     needE    Whether e is needed; if not, e is set to 0 without calculating it.
+ */
+template<typename RingElt, std::size_t N>
+void StaticNegaNussbaumer<RingElt, N>::butterfly(Row& e, Row& f, int steps, bool needE) {
+  // u^steps = -u^(steps - R) for R <= steps < 2R
+  std::size_t k = normalizeSteps(steps, R);
+  bool negate = k >= R;
+  if(negate)
+    k -= R;
+
+  Row g = f;
+  // Coefficient j of u^k*g is -g[j - k + R] for j < k, where it wrapped around, and g[j - k] after
+  for(std::size_t j = 0; j < k; ++j)
+    addSubtract(e[j], f[j], g[j + R - k], !negate, needE);
+  for(std::size_t j = k; j < R; ++j)
+    addSubtract(e[j], f[j], g[j - k], negate, needE);
+}
+
+
+/**
+ * Calculate (simultaneously) e = e + value and f = e - value, or the reverse if subtract is set.
+ * @param[in,out] e          The first coefficient.
+ * @param[out]    f          The second coefficient.
+ * @param[in]     value      The value to add or subtract.
+ * @param[in]     subtract   Whether to subtract the value from e, and add it for f.
+ * @param[in]     needE      Whether e is needed; if not, e is set to 0 without calculating it.
+ */
+template<typename RingElt, std::size_t N>
+void StaticNegaNussbaumer<RingElt, N>::addSubtract(RingElt& e, RingElt& f, const RingElt& value,
+                                                   bool subtract, bool needE) {
+  f = subtract ? e + value : e - value;
+  if(!needE)
+    e = RingElt();
+  else if(subtract)
+    e -= value;
+  else
+    e += value;
+}
+
+
+/**
+ * Calculates the integer with the n least significant bits of the value in reversed order, like
+ * bitrev, as a constant expression.
+ * @param[in] n        The number of bits to reverse.
+ * @param[in] value    The value whose bits to reverse (bits past n are ignored)
+ * @return    The n least significant bits in reversed order.
+ */
+template<typename RingElt, std::size_t N>
+constexpr std::size_t StaticNegaNussbaumer<RingElt, N>::bitrevConst(std::size_t n, std::size_t value) {
+  std::size_t ret = 0;
+  for(std::size_t i = 0; i < n; ++i) {
+    ret = (ret << 1) | (value & 1);
+    value >>= 1;
+  }
+  return ret;
+}
+
+#endif
@@ -3,8 +3,11 @@
 
 #include "Polynomial.h"
 #include "RingModElt.h"
+#include "RingPow2Elt.h"
 #include "NegaNussbaumer.h"
+#include "StaticNegaNussbaumer.h"
 #include "NegaConvo.h"
+#include "WallClock.h"
 #include "compat/Poly.h"
 
 int main() {
@@ -18,23 +21,76 @@ int main() {
 
   // Perform Nussbaumer's algorithm, noting number of operations
   NegaNussbaumer<RingType> nussbaumer(PARAM_N);
+  WallClock clock;
   RingType::getOpCount().reset();
   auto trans1 = nussbaumer.transform(p1);
-  std::cout << "Transform 1: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Transform 1: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
   auto trans2 = nussbaumer.transform(p2);
-  std::cout << "Transform 2: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Transform 2: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
   auto resTrans = nussbaumer.componentwise(trans1, trans2);
-  std::cout << "Recurse: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Recurse: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
   auto resultFactor = nussbaumer.inverseTransform(resTrans);
-  std::cout << "Inverse transform: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Inverse transform: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
   auto result = nussbaumer.correct(resultFactor);
-  std::cout << "Correction: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Correction: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
+  std::cout << std::endl;
+
+  // Do the same with N known at compile time
+  typedef StaticNegaNussbaumer<RingType, PARAM_N> StaticNussbaumer;
+  StaticNussbaumer::Poly staticP1, staticP2, staticResult;
+  for(std::size_t i = 0; i < PARAM_N; ++i) {
+    staticP1[i] = p1[i];
+    staticP2[i] = p2[i];
+  }
+  StaticNussbaumer::Transformed staticTrans1, staticTrans2, staticResTrans;
+  RingType::getOpCount().reset();
+  clock.reset();
+  StaticNussbaumer::transform(staticTrans1, staticP1);
+  std::cout << "Static transform 1: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
+  StaticNussbaumer::transform(staticTrans2, staticP2);
+  std::cout << "Static transform 2: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
+  StaticNussbaumer::componentwise(staticResTrans, staticTrans1, staticTrans2);
+  std::cout << "Static recurse: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
+  StaticNussbaumer::inverseTransform(staticResult, staticResTrans);
+  std::cout << "Static inverse transform: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
+  StaticNussbaumer::correct(staticResult);
+  std::cout << "Static correction: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
+  std::cout << std::endl;
+
+  // Multiply modulo 2^11, where the factor has no inverse: calculate with as many extra bits as
+  // the factor has, and divide it out.
+  typedef RingPow2Elt<11> Pow2RingType;
+  typedef RingPow2Elt<11 + nussbaumerFactorBits(PARAM_N)> WidePow2RingType;
+  Polynomial<Pow2RingType> pow2P1 = a.toPolynomial();
+  Polynomial<Pow2RingType> pow2P2 = b.toPolynomial();
+  Polynomial<WidePow2RingType> wideP1 = pow2P1;
+  Polynomial<WidePow2RingType> wideP2 = pow2P2;
+  NegaNussbaumer<WidePow2RingType> pow2Nussbaumer(PARAM_N);
+  WidePow2RingType::getOpCount().reset();
+  clock.reset();
+  auto pow2ResTrans = pow2Nussbaumer.componentwise(pow2Nussbaumer.transform(wideP1),
+                                                   pow2Nussbaumer.transform(wideP2));
+  auto pow2ResultFactor = pow2Nussbaumer.inverseTransform(pow2ResTrans);
+  std::cout << "Modulo 2^11: " << WidePow2RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
+  Polynomial<Pow2RingType> pow2Result = pow2Nussbaumer.correctByShift<Pow2RingType>(pow2ResultFactor);
+  std::cout << "Correction modulo 2^11: " << WidePow2RingType::getOpCount().reset() << ", " << clock.reset()
+            << std::endl;
 
   // Validate the test succeeded
   if(result != naivemult_negacyclic(PARAM_N, p1, p2)) {
     std::cerr << "TEST FAILED: results not equal!" << std::endl;
     return 1;
   }
+  for(std::size_t i = 0; i < PARAM_N; ++i) {
+    if(staticResult[i] != result[i]) {
+      std::cerr << "TEST FAILED: static and runtime N results not equal!" << std::endl;
+      return 1;
+    }
+  }
+  if(pow2Result != naivemult_negacyclic(PARAM_N, pow2P1, pow2P2)) {
+    std::cerr << "TEST FAILED: results modulo 2^11 not equal!" << std::endl;
+    return 1;
+  }
 
   return 0;
 }
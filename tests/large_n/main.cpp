@@ -0,0 +1,107 @@
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include <random>
+
+#include "Polynomial.h"
+#include "RingModElt.h"
+#include "MontgomeryRingElt.h"
+#include "../knuth_optimized4/NegaNussbaumer.h"
+#include "NussbaumerArena.h"
+#include "NegaConvo.h"
+#include "WallClock.h"
+
+/// A prime with q - 1 = 119*2^23, so that u^N + 1 has roots modulo q for N up to 2^22
+static const std::uint64_t Prime = 998244353;
+/// A generator of the multiplicative group modulo the prime
+static const std::uint64_t Generator = 3;
+
+static const std::size_t MaxLgN = 20;
+static const std::size_t Cutoff = 16;
+static const NussbaumerBaseCase BaseCase = NussbaumerBaseCase::Schoolbook;
+/// Number of roots of u^N + 1 to check the product at
+static const std::size_t NumChecks = 4;
+
+/**
+ * Calculate base^exponent modulo the prime.
+ * @param[in] base       The base, less than the prime.
+ * @param[in] exponent   The exponent.
+ * @return    The power.
+ */
+static std::uint64_t powerModPrime(std::uint64_t base, std::uint64_t exponent) {
+  std::uint64_t ret = 1;
+  for(; exponent != 0; exponent >>= 1) {
+    if(exponent & 1)
+      ret = ret*base % Prime;
+    base = base*base % Prime;
+  }
+  return ret;
+}
+
+/**
+ * Evaluate a polynomial modulo the prime.
+ * @param[in] p        The polynomial.
+ * @param[in] x        The point to evaluate it in.
+ * @return    p(x) mod q.
+ */
+template<typename RingElt>
+static std::uint64_t evaluate(const Polynomial<RingElt>& p, std::uint64_t x) {
+  std::uint64_t ret = 0;
+  for(std::size_t i = p.getSize(); i-- > 0;)
+    ret = (ret*x + reduceSigned(p[i].toInt(), Prime)) % Prime;
+  return ret;
+}
+
+/**
+ * Multiply two random polynomials modulo u^N + 1 for N up to 2^MaxLgN, with the arena, and
+ * check the product at roots of u^N + 1, where it is the product of the evaluations.
+ * @param[in]     name        The name of the ring type, for printing.
+ * @param[in,out] generator   The random generator for the inputs.
+ * @return    Whether all products are correct.
+ */
+template<typename RingElt>
+static bool run(const std::string& name, std::mt19937& generator) {
+  std::cout << name << ":" << std::endl;
+  std::uniform_int_distribution<int> distribution(0, static_cast<int>(Prime - 1));
+
+  for(std::size_t lgN = 10; lgN <= MaxLgN; lgN += 2) {
+    std::size_t N = std::size_t(1) << lgN;
+    Polynomial<RingElt> p1(N), p2(N);
+    for(std::size_t i = 0; i < N; ++i) {
+      p1[i] = distribution(generator);
+      p2[i] = distribution(generator);
+    }
+
+    NegaNussbaumer<RingElt> nussbaumer(N, Cutoff, BaseCase);
+    WallClock clock;
+    NussbaumerArena<RingElt> arena(nussbaumer.getScratchSize());
+    Polynomial<RingElt> result(N);
+    nussbaumer.multiply(PolynomialView<RingElt>(&result[0], N), p1, p2, arena);
+    result = nussbaumer.correct(result);
+    std::cout << "  N = 2^" << lgN << ": " << clock.reset() << ", scratch " << arena.getPeak()
+              << " coefficients (" << static_cast<double>(arena.getPeak())/N << " N)" << std::endl;
+
+    // x^N = -1 for the odd powers of a primitive 2N-th root of unity
+    std::uint64_t root = powerModPrime(Generator, (Prime - 1)/(2*N));
+    for(std::size_t check = 0; check < NumChecks; ++check) {
+      std::uint64_t x = powerModPrime(root, 2*generator() % (2*N) + 1);
+      if(evaluate(result, x) != evaluate(p1, x)*evaluate(p2, x) % Prime) {
+        std::cerr << "TEST FAILED: " << name << " results not equal for N = 2^" << lgN << std::endl;
+        return false;
+      }
+    }
+    if(N <= 4096 && result != naivemult_negacyclic(N, p1, p2)) {
+      std::cerr << "TEST FAILED: " << name << " results differ from the naive ones for N = 2^" << lgN << std::endl;
+      return false;
+    }
+  }
+  std::cout << std::endl;
+  return true;
+}
+
+int main() {
+  std::mt19937 generator(std::random_device{}());
+  bool ok = run<MontgomeryRingElt<Prime, std::uint32_t, NoOpCount>>("Uncounted MontgomeryRingElt", generator) &&
+            run<UncountedRingModElt<static_cast<int>(Prime)>>("Uncounted RingModElt", generator);
+  return ok ? 0 : 1;
+}
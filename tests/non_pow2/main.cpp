@@ -0,0 +1,109 @@
+#include <iostream>
+#include <string>
+#include <random>
+
+#include "Polynomial.h"
+#include "RingModElt.h"
+#include "MontgomeryRingElt.h"
+#include "../knuth_optimized4/NegaNussbaumer.h"
+#include "../knuth_optimized4/NegaNussbaumer3.h"
+#include "NegaConvo.h"
+#include "WallClock.h"
+#include "compat/Poly.h"
+
+/// Number of runs per size; the fastest one is reported
+static const std::size_t NumRuns = 5;
+static const std::size_t Cutoff = 16;
+static const NussbaumerBaseCase BaseCase = NussbaumerBaseCase::Schoolbook;
+static bool failed = false;
+
+/**
+ * Multiply modulo u^N + 1 by padding to a power of 2: the full product, of size 2N - 1, is
+ * calculated modulo u^P + 1 for a power of 2 P >= 2N - 1, where it does not wrap around, and
+ * reduced modulo u^N + 1 afterwards.
+ * @param[in] nussbaumer   The NegaNussbaumer of size P.
+ * @param[in] P            The padded size.
+ * @param[in] p1           The first polynomial to multiply.
+ * @param[in] p2           The second polynomial to multiply.
+ * @return    The product.
+ */
+template<typename RingElt>
+Polynomial<RingElt> multiplyPadded(const NegaNussbaumer<RingElt>& nussbaumer, std::size_t P,
+                                   const Polynomial<RingElt>& p1, const Polynomial<RingElt>& p2) {
+  std::size_t N = p1.getSize();
+  Polynomial<RingElt> padded1(P), padded2(P);
+  for(std::size_t i = 0; i < N; ++i) {
+    padded1[i] = p1[i];
+    padded2[i] = p2[i];
+  }
+
+  auto full = nussbaumer.correct(nussbaumer.inverseTransform(
+                  nussbaumer.componentwise(nussbaumer.transform(padded1), nussbaumer.transform(padded2))));
+  Polynomial<RingElt> ret(N);
+  for(std::size_t i = 0; i < N - 1; ++i)
+    ret[i] = full[i] - full[N + i];
+  ret[N - 1] = full[N - 1];
+  return ret;
+}
+
+/**
+ * Multiply random polynomials modulo u^N + 1 for N = 3*2^k, with NegaNussbaumer3 and by padding
+ * to a power of 2, and print the operation counts and the time of both.
+ * @param[in]     name        The name of the ring type, for printing.
+ * @param[in,out] generator   The random generator for the inputs.
+ */
+template<typename RingElt>
+void run(const std::string& name, std::mt19937& generator) {
+  std::cout << name << ":" << std::endl;
+  std::uniform_int_distribution<int> distribution(0, PARAM_Q - 1);
+
+  for(std::size_t N = 96; N <= 3072; N *= 2) {
+    Polynomial<RingElt> p1(N), p2(N);
+    for(std::size_t i = 0; i < N; ++i) {
+      p1[i] = distribution(generator);
+      p2[i] = distribution(generator);
+    }
+    auto expected = naivemult_negacyclic(N, p1, p2);
+
+    std::size_t P = 1;
+    while(P < 2*N - 1)
+      P *= 2;
+    NegaNussbaumer3<RingElt> nussbaumer3(N, Cutoff, BaseCase);
+    NegaNussbaumer<RingElt> padNussbaumer(P, Cutoff, BaseCase);
+
+    double mixedTime = 0, paddedTime = 0;
+    for(std::size_t run = 0; run < NumRuns; ++run) {
+      RingElt::getOpCount().reset();
+      WallClock clock;
+      auto mixed = nussbaumer3.correct(nussbaumer3.multiply(p1, p2));
+      double runTime = clock.reset().getMicroseconds();
+      auto mixedOps = RingElt::getOpCount().reset();
+      auto padded = multiplyPadded(padNussbaumer, P, p1, p2);
+      double padRunTime = clock.reset().getMicroseconds();
+      auto paddedOps = RingElt::getOpCount().reset();
+
+      if(mixed != expected || padded != expected) {
+        std::cerr << "TEST FAILED: " << name << ", N = " << N << " gives a wrong result" << std::endl;
+        failed = true;
+      }
+      if(run == 0) {
+        std::cout << "  N = " << N << ", 3*" << N/3 << ": " << mixedOps << std::endl;
+        std::cout << "  N = " << N << ", padded to " << P << ": " << paddedOps << std::endl;
+      }
+      if(run == 0 || runTime < mixedTime)
+        mixedTime = runTime;
+      if(run == 0 || padRunTime < paddedTime)
+        paddedTime = padRunTime;
+    }
+    std::cout << "  N = " << N << ": " << mixedTime << " us split, " << paddedTime << " us padded" << std::endl;
+  }
+  std::cout << std::endl;
+}
+
+int main() {
+  std::mt19937 generator(42);
+  run<RingModElt<PARAM_Q>>("RingModElt", generator);
+  run<MontgomeryRingElt<PARAM_Q>>("MontgomeryRingElt", generator);
+
+  return failed ? 1 : 0;
+}
@@ -13,6 +13,8 @@
 #include <cmath>
 
 #include "Polynomial.h"
+#include "PolynomialMatrix.h"
+#include "Butterfly.h"
 #include "BitManip.h"
 
 /**
@@ -24,28 +26,26 @@
 template<typename RingElt>
 class NegaNussbaumer {
 public:
-  /// Transformed polynomial
-  typedef std::vector<Polynomial<RingElt>> Transformed;
+  /// Transformed polynomial: 2m polynomials of r coefficients, in one contiguous block
+  typedef PolynomialMatrix<RingElt> Transformed;
   typedef std::vector<Transformed> MassTransformed;
 
   NegaNussbaumer(std::size_t N);
 
-  Transformed transformSlow(const Polynomial<RingElt>& orig, bool fixFactor = true) const;
-  Transformed transformFast(const Polynomial<RingElt>& orig) const;
+  Transformed transformSlow(const ConstPolynomialView<RingElt>& orig, bool fixFactor = true) const;
+  Transformed transformFast(const ConstPolynomialView<RingElt>& orig) const;
   Polynomial<RingElt> inverseTransform(const Transformed& trans) const;
 
   Transformed componentwise(const Transformed& t1, const Transformed& t2) const;
 
-  MassTransformed massTransform(const Polynomial<RingElt>& orig, bool slow) const;
+  MassTransformed massTransform(const ConstPolynomialView<RingElt>& orig, bool slow) const;
   static MassTransformed massComponentWise(const MassTransformed& fast, const MassTransformed& slow);
   Polynomial<RingElt> massInverseTransform(const MassTransformed& trans);
 
-  static Polynomial<RingElt> multiply(std::size_t N, const Polynomial<RingElt>& p1, const Polynomial<RingElt>& p2);
+  static Polynomial<RingElt> multiply(std::size_t N, const ConstPolynomialView<RingElt>& p1,
+                                      const ConstPolynomialView<RingElt>& p2);
 
 protected:
-  Polynomial<RingElt> addRotatedPolynomial(const Polynomial<RingElt>& p1, const Polynomial<RingElt>& p2, int steps) const;
-  Polynomial<RingElt> rotatePolynomial(const Polynomial<RingElt>& pol, int steps) const;
-
   Polynomial<RingElt> correct(const Polynomial<RingElt>& p) const;
   unsigned int getFactor() const;
 
@@ -95,8 +95,8 @@ NegaNussbaumer<RingElt>::NegaNussbaumer(
 template<typename RingElt>
 Polynomial<RingElt> NegaNussbaumer<RingElt>::multiply(
                                         std::size_t N,
-                                        const Polynomial<RingElt>& p1,
-                                        const Polynomial<RingElt>& p2
+                                        const ConstPolynomialView<RingElt>& p1,
+                                        const ConstPolynomialView<RingElt>& p2
                                                      ) {
   // Otherwise, recurse into the algorithm again
   NegaNussbaumer<RingElt> nussbaumer(N);
@@ -122,21 +122,16 @@ typename NegaNussbaumer<RingElt>::Transformed NegaNussbaumer<RingElt>::component
                                                                                ) const {
   // Special case where N = 2, where Nussbaumer's algorithm is not applicable.
   if(n_ == 1) {
-    Transformed resTrans;
-    Polynomial<RingElt> res(2);
+    Transformed resTrans(1, 2);
     RingElt t = slow[0][0]*fast[0][2];
-    res[0] = t - slow[0][1]*fast[0][1];
-    res[1] = t + slow[0][2]*fast[0][0];
-    resTrans.push_back(res);
+    resTrans[0][0] = t - slow[0][1]*fast[0][1];
+    resTrans[0][1] = t + slow[0][2]*fast[0][0];
     return resTrans;
   }
 
-  Transformed resTrans;
-  resTrans.push_back(Polynomial<RingElt>(r_));
-  for(std::size_t i = 1; i < slow.size(); ++i) {
-    auto term = NegaNussbaumer<RingElt>::multiply(r_, slow[i], fast[i]);
-    resTrans.push_back(term);
-  }
+  Transformed resTrans(slow.getNumRows(), r_);
+  for(std::size_t i = 1; i < slow.getNumRows(); ++i)
+    resTrans[i] = NegaNussbaumer<RingElt>::multiply(r_, slow[i], fast[i]);
 
   return resTrans;
 }
@@ -154,7 +149,7 @@ typename NegaNussbaumer<RingElt>::Transformed NegaNussbaumer<RingElt>::component
 template<typename RingElt>
 typename NegaNussbaumer<RingElt>::Transformed
                                 NegaNussbaumer<RingElt>::transformSlow(
-                                            const Polynomial<RingElt>& orig,
+                                            const ConstPolynomialView<RingElt>& orig,
                                             bool fixFactor
                                                                       ) const {
   assert(orig.getSize() == (1u << n_));
@@ -162,19 +157,19 @@ typename NegaNussbaumer<RingElt>::Transformed
   // Handle the special case N = 2, where another algorithm is used (with some pre-processing)
   // We make 2 as the first componentwise multiplication is skipped.
   if(n_ == 1) {
-    Transformed trans(1, Polynomial<RingElt>(3));
+    Transformed trans(1, 3);
     trans[0][0] = orig[0];
     trans[0][1] = orig[0] + orig[1];
     trans[0][2] = orig[1] - orig[0];
     return trans;
   }
 
-  Transformed trans(2*m_, Polynomial<RingElt>(r_));
+  Transformed trans(2*m_, r_);
 
   // Correct the scale of the polynomial. Do so now, as this needs less steps then
   // at a later point. Also, as this result may be re-used, it's better to do here
   // than at the end.
-  Polynomial<RingElt> scaledOrig = fixFactor ? correct(orig) : orig;
+  Polynomial<RingElt> scaledOrig = fixFactor ? correct(orig) : Polynomial<RingElt>(orig);
 
   // Get the input polynomials, transformed, applying the C_4' matrix immediately.
   for(std::size_t j = 0; j < r_; ++j)
@@ -197,12 +192,11 @@ typename NegaNussbaumer<RingElt>::Transformed
   }
 
   // Apply the C_2^T matrix.
-  Polynomial<RingElt> lastEntry(-trans[0]);
+  auto lastEntry = trans[2*m_ - 1];
+  lastEntry = -trans[0];
   for(std::size_t i = 1; i < 2*m_ - 1; ++i)
     lastEntry -= trans[i];
 
-  trans[2*m_ - 1] = lastEntry;
-
   // Perform the FFT
   std::size_t j = (n_ >> 1) + 1;
   while(j > 0) {
@@ -223,16 +217,8 @@ typename NegaNussbaumer<RingElt>::Transformed
         // Now, we set (simultaneously):
         // trans[e] = trans[e] + u^k*trans[f]
         // trans[f] = trans[e] - u^k*trans[f]
-        Polynomial<RingElt> tmp;
-        if(e == 0 && j == 0) {
-          // Don't calculate trans[0]; we don't need it.
-          tmp = Polynomial<RingElt>(r_);
-        }
-        else {
-          tmp = addRotatedPolynomial(trans[e], trans[f], k);
-        }
-        trans[f] = addRotatedPolynomial(trans[e], trans[f], k + r_);
-        trans[e] = tmp;
+        // Don't calculate trans[0]; we don't need it.
+        butterflyDit(trans[e], trans[f], k, e != 0 || j != 0);
       }
     }
   }
@@ -252,13 +238,13 @@ typename NegaNussbaumer<RingElt>::Transformed
 template<typename RingElt>
 typename NegaNussbaumer<RingElt>::Transformed
                                 NegaNussbaumer<RingElt>::transformFast(
-                                            const Polynomial<RingElt>& orig
+                                            const ConstPolynomialView<RingElt>& orig
                                                                       ) const {
   assert(orig.getSize() == (1u << n_));
 
   // Prepare for another algorithm if N = 2.
   if(n_ == 1) {
-    Transformed trans(1, Polynomial<RingElt>(3));
+    Transformed trans(1, 3);
     trans[0][0] = orig[0];
     trans[0][1] = orig[1];
     trans[0][2] = orig[0] + orig[1];
@@ -266,7 +252,7 @@ typename NegaNussbaumer<RingElt>::Transformed
   }
 
 
-  Transformed trans(2*m_, Polynomial<RingElt>(r_));
+  Transformed trans(2*m_, r_);
 
   // First get the polynomials to perform the fourier transform on. These are
   // 2m polynomials of which r coefficients will be considered, where two sets
@@ -297,16 +283,8 @@ typename NegaNussbaumer<RingElt>::Transformed
         // Now, we set (simultaneously):
         // trans[e] = trans[e] + u^k*trans[f]
         // trans[f] = trans[e] - u^k*trans[f]
-        Polynomial<RingElt> tmp;
-        if(e == 0 && j == 0) {
-          // Don't calculate trans[0]; we don't need it.
-          tmp = Polynomial<RingElt>(r_);
-        }
-        else {
-          tmp = addRotatedPolynomial(trans[e], trans[f], k);
-        }
-        trans[f] = addRotatedPolynomial(trans[e], trans[f], k + r_);
-        trans[e] = tmp;
+        // Don't calculate trans[0]; we don't need it.
+        butterflyDit(trans[e], trans[f], k, e != 0 || j != 0);
       }
     }
   }
@@ -341,19 +319,18 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::inverseTransform(
         e = s + t;
         f = e + (1u << j);
 
-        Polynomial<RingElt> tmp;
         if(j == 0 && e == 0) {
+          // z[0] is 0, so this is a copy and a negation.
           z[e] = z[f];
-          z[f] = -z[f];
+          for(std::size_t i = 0; i < r_; ++i)
+            z[f][i] = -z[f][i];
         }
         else {
           // Now, we set (simultaneously):
           // z[e] = z[e] + u^k*z[f]
           // z[f] = z[e] - u^k*z[f]
-          tmp = addRotatedPolynomial(z[e], z[f], k);
-          if(j != jMax)  // We don't need the last half of the result.
-            z[f] = addRotatedPolynomial(z[e], z[f], k + r_);
-          z[e] = tmp;
+          // We don't need the last half of the result.
+          butterflyDit(z[e], z[f], k, true, j != jMax);
         }
       }
     }
@@ -362,12 +339,12 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::inverseTransform(
   // Inverse the order of all but the first element.
   std::size_t from, to;
   for(from = 1, to = m_ - 1; from < to; from++, to--) {
-    std::swap(z[from], z[to]);
+    z.swapRows(from, to);
   }
 
   // Multiply all but the first element with -u^{r-1} = u^{2r - 1}
   for(std::size_t i = 1; i < m_; ++i)
-    z[i] = rotatePolynomial(z[i], 2*r_ - 1);
+    rotateInPlace(z[i], 2*r_ - 1);
 
   // Unpack the polynomial
   Polynomial<RingElt> res(1u << n_);
@@ -390,7 +367,7 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::inverseTransform(
  */
 template<typename RingElt>
 typename NegaNussbaumer<RingElt>::MassTransformed
-NegaNussbaumer<RingElt>::massTransform(const Polynomial<RingElt>& orig,
+NegaNussbaumer<RingElt>::massTransform(const ConstPolynomialView<RingElt>& orig,
                                        bool slow) const {
   size_t N = 1 << n_;
 
@@ -407,9 +384,9 @@ NegaNussbaumer<RingElt>::massTransform(const Polynomial<RingElt>& orig,
     MassTransformed newTrans;
 
     // Transform for the next level. Skip the first polynomial, which is always 0.
-    for(auto trans : last)
-      for(auto polIt = trans.begin() + 1; polIt != trans.end(); ++polIt)
-        newTrans.push_back(slow ? nb.transformSlow(*polIt, false) : nb.transformFast(*polIt));
+    for(const auto& trans : last)
+      for(std::size_t i = 1; i < trans.getNumRows(); ++i)
+        newTrans.push_back(slow ? nb.transformSlow(trans[i], false) : nb.transformFast(trans[i]));
 
     last = std::move(newTrans);
     if(N == 2)
@@ -469,13 +446,13 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::massInverseTransform(const MassTran
 
     // Each transformed entry creates a polynomial that is input for the next inverse transform,
     // of which we want "nextTransSize" entries.
-    Transformed curOutTrans;
-    curOutTrans.push_back(Polynomial<RingElt>());  // The first entry is always 0
-    for(auto curTrans : curMass) {
-      curOutTrans.push_back(iter->inverseTransform(curTrans));
-      if(curOutTrans.size() == nextTransSize) {
+    Transformed curOutTrans(nextTransSize, (iter + 1)->r_);
+    std::size_t curOutRow = 1;  // The first entry is always 0
+    for(const auto& curTrans : curMass) {
+      curOutTrans[curOutRow++] = iter->inverseTransform(curTrans);
+      if(curOutRow == nextTransSize) {
         nextMass.push_back(curOutTrans);
-        curOutTrans.resize(1);
+        curOutRow = 1;
       }
     }
 
@@ -486,75 +463,6 @@ Polynomial<RingElt> NegaNussbaumer<RingElt>::massInverseTransform(const MassTran
 }
 
 
-/**
- * Calculate p1 + (u^steps)*p2 modulo u^r + 1. This could be done by a separate
- * rotate/add step, but this would require possible negations followed by
- * additions, rather than immediately subtracting.
- * @param[in] p1      The first polynomial
- * @param[in] p2      The second polynomial.
- * @param[in] steps   The number of steps to "rotate" p2.
- * @return    p1 + (u^steps)*p2 modulo u^r + 1.
- */
-template<typename RingElt>
-Polynomial<RingElt> NegaNussbaumer<RingElt>::addRotatedPolynomial(
-                                                 const Polynomial<RingElt>& p1,
-                                                 const Polynomial<RingElt>& p2,
-                                                 int steps
-                                                                 ) const {
-  Polynomial<RingElt> ret(r_);
-
-  // Get "steps" as negative value, with 2*r_ < steps <= 0
-  steps %= 2*r_;
-  if(steps > 0)
-    steps -= 2*r_;
-
-  for(std::size_t i = 0; i < r_; ++i) {
-    int src = static_cast<int>(i) - steps;
-    std::size_t srcIndex = static_cast<size_t>(src) % r_;
-    bool signInverse = (src / r_) & 1;
-
-    if(signInverse)
-      ret[i] = p1[i] - p2[srcIndex];
-    else
-      ret[i] = p1[i] + p2[srcIndex];
-  }
-
-  return ret;
-}
-
-
-/**
- * The function "rotates" the polynomial, as though multiplying it with u^steps,
- * modulo u^r + 1.
- * @param[in] pol    The polynomial to rotate.
- * @param[in] steps  The number of steps to rotate.
- * @return    The resulting polynomial.
- */
-template<typename RingElt>
-Polynomial<RingElt> NegaNussbaumer<RingElt>::rotatePolynomial(
-                                              const Polynomial<RingElt>& pol,
-                                              int steps
-                                                             ) const {
-  Polynomial<RingElt> ret(r_);
-
-  // Get "steps" as negative value, with 2*r_ < steps <= 0
-  steps %= 2*r_;
-  if(steps > 0)
-    steps -= 2*r_;
-
-  for(std::size_t i = 0; i < r_; ++i) {
-    int src = static_cast<int>(i) - steps;
-    std::size_t srcIndex = static_cast<size_t>(src) % r_;
-    bool signInverse = (src / r_) & 1;
-
-    if(signInverse)
-      ret[i] = -pol[srcIndex];
-    else
-      ret[i] = pol[srcIndex];
-  }
-
-  return ret;
-}
 
 
 /*
@@ -601,5 +509,4 @@ unsigned int NegaNussbaumer<RingElt>::getFactor() const {
   return factor;
 }
 
-
 #endif
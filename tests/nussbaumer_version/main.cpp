@@ -1,12 +1,64 @@
 #include <iostream>
 #include <cassert>
+#include <cstdint>
+#include <string>
 
 #include "Polynomial.h"
 #include "RingModElt.h"
+#include "MontgomeryRingElt.h"
+#include "BarrettRingElt.h"
 #include "NegaNussbaumer.h"
 #include "NegaConvo.h"
+#include "WallClock.h"
 #include "compat/Poly.h"
 
+/// The largest prime below 2^30
+constexpr std::uint64_t LargePrime = 1073741789;
+/// Factor to spread the coefficients over the 30 bits, when multiplying modulo LargePrime
+constexpr int LargeScale = 1000003;
+
+/**
+ * Multiply two polynomials with Nussbaumer's algorithm over the given ring, printing the time.
+ * @param[in] name     The name of the ring, for printing.
+ * @param[in] in1      The first polynomial.
+ * @param[in] in2      The second polynomial.
+ * @param[in] scale    Whether to multiply the coefficients by LargeScale first.
+ * @return    The product.
+ */
+template<typename RingElt>
+Polynomial<RingElt> timedMultiply(const std::string& name, const Polynomial<std::uint16_t>& in1,
+                                  const Polynomial<std::uint16_t>& in2, bool scale = false) {
+  Polynomial<RingElt> p1 = in1, p2 = in2;
+  if(scale) {
+    p1 *= LargeScale;
+    p2 *= LargeScale;
+  }
+
+  NegaNussbaumer<RingElt> nussbaumer(PARAM_N);
+  WallClock clock;
+  auto resTrans = nussbaumer.componentwise(nussbaumer.transformSlow(p1), nussbaumer.transformFast(p2));
+  auto result = nussbaumer.inverseTransform(resTrans);
+  std::cout << name << " multiplication: " << clock.reset() << std::endl;
+  return result;
+}
+
+/**
+ * Compare two polynomials over different representations of the same ring Z/qZ.
+ * @param[in] p1       The first polynomial.
+ * @param[in] p2       The second polynomial.
+ * @param[in] modulus  The modulus q.
+ * @return    true iff all coefficients are equal modulo q.
+ */
+template<typename RingElt1, typename RingElt2>
+bool equalModQ(const Polynomial<RingElt1>& p1, const Polynomial<RingElt2>& p2, std::int64_t modulus) {
+  if(p1.getSize() != p2.getSize())
+    return false;
+  for(std::size_t i = 0; i < p1.getSize(); ++i)
+    if((static_cast<std::int64_t>(p1[i].toInt()) - p2[i].toInt()) % modulus != 0)
+      return false;
+  return true;
+}
+
 int main() {
   // Get two random polynomials
   typedef RingModElt<PARAM_Q> RingType;
@@ -18,33 +70,68 @@ int main() {
 
   // Perform Nussbaumer's algorithm, noting number of operations
   NegaNussbaumer<RingType> nussbaumer(PARAM_N);
+  WallClock clock;
   RingType::getOpCount().reset();
   auto trans1 = nussbaumer.transformSlow(p1);
-  std::cout << "Transform 1: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Transform 1: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
   auto trans2 = nussbaumer.transformFast(p2);
-  std::cout << "Transform 2: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Transform 2: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
   auto resTrans = nussbaumer.componentwise(trans1, trans2);
-  std::cout << "Recurse: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Recurse: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
   auto result = nussbaumer.inverseTransform(resTrans);
-  std::cout << "Inverse transform: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Inverse transform: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
   std::cout << std::endl;
 
   RingType::getOpCount().reset();
+  clock.reset();
   auto massTransSlow = nussbaumer.massTransform(p1, true);
-  std::cout << "Mass transform 1: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Mass transform 1: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
   auto massTransFast = nussbaumer.massTransform(p2, false);
-  std::cout << "Mass transform 2: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Mass transform 2: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
   auto resTrans2 = NegaNussbaumer<RingType>::massComponentWise(massTransSlow, massTransFast);
-  std::cout << "Base case: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Base case: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
   auto result2 = nussbaumer.massInverseTransform(resTrans2);
-  std::cout << "Mass inverse transform: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Mass inverse transform: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
+  std::cout << std::endl;
+
+  // Perform the same multiplication with other representations of the ring, for comparison of the speed
+  Polynomial<std::uint16_t> in1 = a.toPolynomial();
+  Polynomial<std::uint16_t> in2 = b.toPolynomial();
+  auto fastResult = timedMultiply<UncountedRingModElt<PARAM_Q>>("Uncounted", in1, in2);
+  auto montResult = timedMultiply<MontgomeryRingElt<PARAM_Q, std::uint32_t, NoOpCount>>("Montgomery", in1, in2);
+  auto barrettResult = timedMultiply<BarrettRingElt<PARAM_Q, std::uint32_t, NoOpCount>>("Barrett", in1, in2);
+  std::cout << std::endl;
+
+  // And modulo a 30-bit prime, which RingModElt cannot do, with 32- and 64-bit words
+  auto mont32Large = timedMultiply<MontgomeryRingElt<LargePrime, std::uint32_t, NoOpCount>>(
+                                                          "Montgomery, 30-bit prime, 32-bit words", in1, in2, true);
+  auto mont64Large = timedMultiply<MontgomeryRingElt<LargePrime, std::uint64_t, NoOpCount>>(
+                                                          "Montgomery, 30-bit prime, 64-bit words", in1, in2, true);
+  auto barrett32Large = timedMultiply<BarrettRingElt<LargePrime, std::uint32_t, NoOpCount>>(
+                                                          "Barrett, 30-bit prime, 32-bit words", in1, in2, true);
+  auto barrett64Large = timedMultiply<BarrettRingElt<LargePrime, std::uint64_t, NoOpCount>>(
+                                                          "Barrett, 30-bit prime, 64-bit words", in1, in2, true);
 
+  Polynomial<BarrettRingElt<LargePrime>> large1 = in1, large2 = in2;
+  large1 *= LargeScale;
+  large2 *= LargeScale;
+  auto naiveLarge = naivemult_negacyclic(PARAM_N, large1, large2);
 
   // Validate the test succeeded
   if(result != result2) {
     std::cerr << "TEST FAILED: inconsistency between recursive/iterative approach!" << std::endl;
     return 1;
   }
+  if(!equalModQ(result, fastResult, PARAM_Q) || !equalModQ(result, montResult, PARAM_Q) ||
+     !equalModQ(result, barrettResult, PARAM_Q)) {
+    std::cerr << "TEST FAILED: other representation of the ring gives a different result!" << std::endl;
+    return 1;
+  }
+  if(!equalModQ(naiveLarge, mont32Large, LargePrime) || !equalModQ(naiveLarge, mont64Large, LargePrime) ||
+     !equalModQ(naiveLarge, barrett32Large, LargePrime) || !equalModQ(naiveLarge, barrett64Large, LargePrime)) {
+    std::cerr << "TEST FAILED: results modulo the 30-bit prime not equal!" << std::endl;
+    return 1;
+  }
   if(result != naivemult_negacyclic(PARAM_N, p1, p2)) {
     std::cerr << "TEST FAILED: results not equal!" << std::endl;
     return 1;
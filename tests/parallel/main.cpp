@@ -0,0 +1,125 @@
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Polynomial.h"
+#include "RingModElt.h"
+#include "../knuth_optimized4/NegaNussbaumer.h"
+#include "ThreadPool.h"
+#include "NegaConvo.h"
+#include "WallClock.h"
+#include "compat/Poly.h"
+
+typedef UncountedRingModElt<PARAM_Q> RingType;
+
+/// Number of runs per setting; the fastest one is reported
+static const std::size_t NumRuns = 3;
+/// The cutoff and base case used, the fastest ones of the cutoff sweep
+static const std::size_t Cutoff = 8;
+static const NussbaumerBaseCase BaseCase = NussbaumerBaseCase::Schoolbook;
+
+/**
+ * Create a polynomial with random coefficients.
+ * @param[in]     N          The number of coefficients.
+ * @param[in,out] generator  The random generator.
+ * @return    The polynomial.
+ */
+static Polynomial<RingType> randomPolynomial(std::size_t N, std::mt19937& generator) {
+  std::uniform_int_distribution<int> distribution(0, PARAM_Q - 1);
+  Polynomial<RingType> ret(N);
+  for(std::size_t i = 0; i < N; ++i)
+    ret[i] = distribution(generator);
+  return ret;
+}
+
+/**
+ * The fastest time of each step of one multiplication.
+ */
+struct StepTimes {
+  double transform, componentwise, inverseTransform;
+};
+
+
+/**
+ * Time the steps of one size on 1 up to maxThreads threads, and check that each gives the serial
+ * product.
+ * @param[in]     N           The size of the multiplication.
+ * @param[in]     maxThreads  The largest number of threads.
+ * @param[in,out] generator   The random generator for the inputs.
+ * @return    Whether all products are correct.
+ */
+static bool scale(std::size_t N, std::size_t maxThreads, std::mt19937& generator) {
+  Polynomial<RingType> p1 = randomPolynomial(N, generator);
+  Polynomial<RingType> p2 = randomPolynomial(N, generator);
+  NegaNussbaumer<RingType> nussbaumer(N, Cutoff, BaseCase);
+  auto expected = nussbaumer.inverseTransform(nussbaumer.componentwise(nussbaumer.transform(p1),
+                                                                       nussbaumer.transform(p2)));
+  if(N <= 4096 && nussbaumer.correct(expected) != naivemult_negacyclic(N, p1, p2)) {
+    std::cerr << "TEST FAILED: serial results not equal for N = " << N << std::endl;
+    return false;
+  }
+
+  std::cout << "N = " << N << ", m = " << (std::size_t(1) << nussbaumer.getLgM()) << ":" << std::endl;
+  StepTimes serial = StepTimes();
+  for(std::size_t threads = 1; threads <= maxThreads; threads = threads < maxThreads && 2*threads > maxThreads ?
+                                                                    maxThreads : 2*threads) {
+    ThreadPool pool(threads);
+    nussbaumer.setThreadPool(&pool);
+
+    StepTimes best = StepTimes();
+    for(std::size_t run = 0; run < NumRuns; ++run) {
+      WallClock clock;
+      auto t1 = nussbaumer.transform(p1);
+      auto t2 = nussbaumer.transform(p2);
+      double transformTime = clock.reset().getMicroseconds();
+      auto resTrans = nussbaumer.componentwise(t1, t2);
+      double componentwiseTime = clock.reset().getMicroseconds();
+      auto result = nussbaumer.inverseTransform(resTrans);
+      double inverseTime = clock.reset().getMicroseconds();
+
+      if(result != expected) {
+        std::cerr << "TEST FAILED: results not equal for N = " << N << " on " << threads << " threads" << std::endl;
+        return false;
+      }
+      if(run == 0 || transformTime < best.transform)
+        best.transform = transformTime;
+      if(run == 0 || componentwiseTime < best.componentwise)
+        best.componentwise = componentwiseTime;
+      if(run == 0 || inverseTime < best.inverseTransform)
+        best.inverseTransform = inverseTime;
+    }
+
+    if(threads == 1)
+      serial = best;
+    double total = best.transform + best.componentwise + best.inverseTransform;
+    double serialTotal = serial.transform + serial.componentwise + serial.inverseTransform;
+    std::cout << "  " << threads << " threads: transforms " << best.transform << " us (x"
+              << serial.transform/best.transform << "), componentwise " << best.componentwise << " us (x"
+              << serial.componentwise/best.componentwise << "), inverse " << best.inverseTransform << " us (x"
+              << serial.inverseTransform/best.inverseTransform << "), total x" << serialTotal/total << std::endl;
+    if(threads == maxThreads)
+      break;
+  }
+  std::cout << std::endl;
+  return true;
+}
+
+int main(int argc, char** argv) {
+  // The largest number of threads may be given; by default, all cores are used
+  std::size_t maxThreads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+  if(maxThreads == 0)
+    maxThreads = 1;
+  std::cout << "Cutoff " << Cutoff << ", up to " << maxThreads << " threads" << std::endl
+            << std::endl;
+
+  std::mt19937 generator(std::random_device{}());
+  for(std::size_t N : {1024, 4096, 16384, 65536}) {
+    if(!scale(N, maxThreads, generator))
+      return 1;
+  }
+  return 0;
+}
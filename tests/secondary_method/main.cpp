@@ -3,11 +3,29 @@
 
 #include "Polynomial.h"
 #include "RingModElt.h"
+#include "LazyRingModElt.h"
 #include "NegaNussbaumer.h"
 #include "NegaConvo.h"
+#include "WallClock.h"
 #include "Karatsuba.h"
 #include "compat/Poly.h"
 
+/**
+ * Compare two polynomials over different representations of the same ring Z/qZ.
+ * @param[in] p1     The first polynomial.
+ * @param[in] p2     The second polynomial.
+ * @return    true iff all coefficients are equal modulo q.
+ */
+template<typename RingElt1, typename RingElt2>
+bool equalModQ(const Polynomial<RingElt1>& p1, const Polynomial<RingElt2>& p2) {
+  if(p1.getSize() != p2.getSize())
+    return false;
+  for(std::size_t i = 0; i < p1.getSize(); ++i)
+    if((p1[i].toInt() - p2[i].toInt()) % PARAM_Q != 0)
+      return false;
+  return true;
+}
+
 int main() {
   // Get two random polynomials
   typedef RingModElt<PARAM_Q> RingType;
@@ -22,29 +40,45 @@ int main() {
 
   // Test the number of operations for Nussbaumer's algorithm
   NegaNussbaumer<RingType> nussbaumer(32);
+  WallClock clock;
   RingType::getOpCount().reset();
   auto trans1 = nussbaumer.transformSlow(p1);
   auto trans2 = nussbaumer.transformFast(p2);
   auto resTrans = nussbaumer.componentwise(trans1, trans2);
   auto result1 = nussbaumer.inverseTransform(resTrans);
-  std::cout << "Nussbaumer's algorithm: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Nussbaumer's algorithm: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
 
   // Test the number of operations for the classical method.
   auto result2 = naivemult_negacyclic(32, p1, p2);
-  std::cout << "Classical method: " << RingType::getOpCount().reset() << std::endl;
+  std::cout << "Classical method: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
+
+  // Test karatsuba's method
+  auto result3 = karatsuba_negacyclic(32, p1, p2);
+  std::cout << "Karatsuba's method: " << RingType::getOpCount().reset() << ", " << clock.reset() << std::endl;
+
+  // Repeat the direct methods with lazy reduction, which reduce only when the result is read. This
+  // version of NegaNussbaumer does not reduce between its stages, so it is not run lazily.
+  typedef LazyRingModElt<PARAM_Q> LazyRingType;
+  Polynomial<LazyRingType> lazyP1 = a.toPolynomial();
+  Polynomial<LazyRingType> lazyP2 = b.toPolynomial();
+  lazyP1.setSize(32);
+  lazyP2.setSize(32);
+  LazyRingType::getOpCount().reset();
+  clock.reset();
+  auto lazyResult2 = naivemult_negacyclic(32, lazyP1, lazyP2);
+  std::cout << "Classical method, lazy reduction: " << LazyRingType::getOpCount().reset() << ", "
+            << clock.reset() << std::endl;
 
-  // Test karatsuba's method (reduce manually)
-  auto product = karatsuba(p1, p2);
-  Polynomial<RingType> result3(32);
-  for(std::size_t i = 0; i < 32 - 1; ++i)
-    result3[i] = product[i] - product[i + 32];
-  result3[31] = product[31];
-  std::cout << "Karatsuba's method: " << RingType::getOpCount().reset() << std::endl;
+  auto lazyResult3 = karatsuba_negacyclic(32, lazyP1, lazyP2);
+  std::cout << "Karatsuba's method, lazy reduction: " << LazyRingType::getOpCount().reset() << ", "
+            << clock.reset() << std::endl;
 
   if(result1 != result2)
     std::cerr << "TEST FAILED: Method 1 and 2 mismatch" << std::endl;
   if(result1 != result3)
     std::cerr << "TEST FAILED: Method 1 and 3 mismatch" << std::endl;
+  if(!equalModQ(result1, lazyResult2) || !equalModQ(result1, lazyResult3))
+    std::cerr << "TEST FAILED: lazy reduction mismatch" << std::endl;
 
   return 0;
 }